@@ -0,0 +1,292 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "audio-kernels.h"
+
+#include <immintrin.h>
+#include <cstdint>
+
+// NOTE: The audio buffers provided by the host can have any alignment, so we
+//       need to use unaligned loads and stores everywhere. On any modern CPU
+//       these are just as fast as their aligned counterparts when the data
+//       happens to be aligned.
+
+/**
+ * The scalar fallback used for the samples that don't fit in a full vector.
+ */
+template <typename T>
+static bool is_silent_scalar(const T* samples, size_t num_samples) noexcept {
+    for (size_t i = 0; i < num_samples; i++) {
+        if (samples[i] != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Check whether all values in `samples` are zero, disregarding the sign bit.
+ * This works on the raw bits so we can use the same implementation for single
+ * and double precision audio. `sign_mask` should clear the sign bit of every
+ * sample.
+ */
+template <typename T>
+static bool is_silent_sse2(const T* samples,
+                           size_t num_samples,
+                           __m128i sign_mask) noexcept {
+    constexpr size_t block_size = 64 / sizeof(T);
+
+    size_t i = 0;
+    for (; i + block_size <= num_samples; i += block_size) {
+        const __m128i* block = reinterpret_cast<const __m128i*>(samples + i);
+        const __m128i low = _mm_or_si128(_mm_loadu_si128(block),
+                                         _mm_loadu_si128(block + 1));
+        const __m128i high = _mm_or_si128(_mm_loadu_si128(block + 2),
+                                          _mm_loadu_si128(block + 3));
+        const __m128i bits = _mm_and_si128(_mm_or_si128(low, high), sign_mask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(bits, _mm_setzero_si128())) !=
+            0xffff) {
+            return false;
+        }
+    }
+
+    return is_silent_scalar(samples + i, num_samples - i);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) static bool is_silent_avx2(
+    const T* samples,
+    size_t num_samples,
+    __m256i sign_mask) noexcept {
+    constexpr size_t block_size = 64 / sizeof(T);
+
+    size_t i = 0;
+    for (; i + block_size <= num_samples; i += block_size) {
+        const __m256i* block = reinterpret_cast<const __m256i*>(samples + i);
+        const __m256i bits = _mm256_or_si256(_mm256_loadu_si256(block),
+                                             _mm256_loadu_si256(block + 1));
+        if (!_mm256_testz_si256(bits, sign_mask)) {
+            return false;
+        }
+    }
+
+    return is_silent_scalar(samples + i, num_samples - i);
+}
+
+static bool is_silent_f32_sse2(const float* samples,
+                               size_t num_samples) noexcept {
+    return is_silent_sse2(samples, num_samples, _mm_set1_epi32(0x7fffffff));
+}
+
+static bool is_silent_f64_sse2(const double* samples,
+                               size_t num_samples) noexcept {
+    return is_silent_sse2(samples, num_samples,
+                          _mm_set1_epi64x(0x7fffffffffffffffll));
+}
+
+__attribute__((target("avx2"))) static bool is_silent_f32_avx2(
+    const float* samples,
+    size_t num_samples) noexcept {
+    return is_silent_avx2(samples, num_samples, _mm256_set1_epi32(0x7fffffff));
+}
+
+__attribute__((target("avx2"))) static bool is_silent_f64_avx2(
+    const double* samples,
+    size_t num_samples) noexcept {
+    return is_silent_avx2(samples, num_samples,
+                          _mm256_set1_epi64x(0x7fffffffffffffffll));
+}
+
+static void accumulate_f32_sse2(const float* samples,
+                                size_t num_samples,
+                                float* destination) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i),
+                                                  _mm_loadu_ps(samples + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] += samples[i];
+    }
+}
+
+static void accumulate_f64_sse2(const double* samples,
+                                size_t num_samples,
+                                double* destination) noexcept {
+    size_t i = 0;
+    for (; i + 2 <= num_samples; i += 2) {
+        _mm_storeu_pd(destination + i, _mm_add_pd(_mm_loadu_pd(destination + i),
+                                                  _mm_loadu_pd(samples + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] += samples[i];
+    }
+}
+
+__attribute__((target("avx2"))) static void accumulate_f32_avx2(
+    const float* samples,
+    size_t num_samples,
+    float* destination) noexcept {
+    size_t i = 0;
+    for (; i + 8 <= num_samples; i += 8) {
+        _mm256_storeu_ps(destination + i,
+                         _mm256_add_ps(_mm256_loadu_ps(destination + i),
+                                       _mm256_loadu_ps(samples + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] += samples[i];
+    }
+}
+
+__attribute__((target("avx2"))) static void accumulate_f64_avx2(
+    const double* samples,
+    size_t num_samples,
+    double* destination) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm256_storeu_pd(destination + i,
+                         _mm256_add_pd(_mm256_loadu_pd(destination + i),
+                                       _mm256_loadu_pd(samples + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] += samples[i];
+    }
+}
+
+static void convert_f32_f64_sse2(const float* samples,
+                                 size_t num_samples,
+                                 double* destination) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= num_samples; i += 4) {
+        const __m128 values = _mm_loadu_ps(samples + i);
+        _mm_storeu_pd(destination + i, _mm_cvtps_pd(values));
+        _mm_storeu_pd(destination + i + 2,
+                      _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] = samples[i];
+    }
+}
+
+static void convert_f64_f32_sse2(const double* samples,
+                                 size_t num_samples,
+                                 float* destination) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= num_samples; i += 4) {
+        const __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(samples + i));
+        const __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(samples + i + 2));
+        _mm_storeu_ps(destination + i, _mm_movelh_ps(low, high));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] = static_cast<float>(samples[i]);
+    }
+}
+
+__attribute__((target("avx2"))) static void convert_f32_f64_avx2(
+    const float* samples,
+    size_t num_samples,
+    double* destination) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm256_storeu_pd(destination + i,
+                         _mm256_cvtps_pd(_mm_loadu_ps(samples + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] = samples[i];
+    }
+}
+
+__attribute__((target("avx2"))) static void convert_f64_f32_avx2(
+    const double* samples,
+    size_t num_samples,
+    float* destination) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm_storeu_ps(destination + i,
+                      _mm256_cvtpd_ps(_mm256_loadu_pd(samples + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] = static_cast<float>(samples[i]);
+    }
+}
+
+/**
+ * The kernels used for the current CPU. These are selected once when the
+ * library gets loaded.
+ */
+struct AudioKernels {
+    bool (*is_silent_f32)(const float*, size_t) noexcept;
+    bool (*is_silent_f64)(const double*, size_t) noexcept;
+    void (*accumulate_f32)(const float*, size_t, float*) noexcept;
+    void (*accumulate_f64)(const double*, size_t, double*) noexcept;
+    void (*convert_f32_f64)(const float*, size_t, double*) noexcept;
+    void (*convert_f64_f32)(const double*, size_t, float*) noexcept;
+};
+
+static AudioKernels select_audio_kernels() noexcept {
+    // This may run before libgcc has initialized its CPU feature detection
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return AudioKernels{.is_silent_f32 = is_silent_f32_avx2,
+                            .is_silent_f64 = is_silent_f64_avx2,
+                            .accumulate_f32 = accumulate_f32_avx2,
+                            .accumulate_f64 = accumulate_f64_avx2,
+                            .convert_f32_f64 = convert_f32_f64_avx2,
+                            .convert_f64_f32 = convert_f64_f32_avx2};
+    } else {
+        return AudioKernels{.is_silent_f32 = is_silent_f32_sse2,
+                            .is_silent_f64 = is_silent_f64_sse2,
+                            .accumulate_f32 = accumulate_f32_sse2,
+                            .accumulate_f64 = accumulate_f64_sse2,
+                            .convert_f32_f64 = convert_f32_f64_sse2,
+                            .convert_f64_f32 = convert_f64_f32_sse2};
+    }
+}
+
+static const AudioKernels audio_kernels = select_audio_kernels();
+
+bool is_silent(const float* samples, size_t num_samples) noexcept {
+    return audio_kernels.is_silent_f32(samples, num_samples);
+}
+
+bool is_silent(const double* samples, size_t num_samples) noexcept {
+    return audio_kernels.is_silent_f64(samples, num_samples);
+}
+
+void accumulate_samples(const float* samples,
+                        size_t num_samples,
+                        float* destination) noexcept {
+    audio_kernels.accumulate_f32(samples, num_samples, destination);
+}
+
+void accumulate_samples(const double* samples,
+                        size_t num_samples,
+                        double* destination) noexcept {
+    audio_kernels.accumulate_f64(samples, num_samples, destination);
+}
+
+void convert_samples(const float* samples,
+                     size_t num_samples,
+                     double* destination) noexcept {
+    audio_kernels.convert_f32_f64(samples, num_samples, destination);
+}
+
+void convert_samples(const double* samples,
+                     size_t num_samples,
+                     float* destination) noexcept {
+    audio_kernels.convert_f64_f32(samples, num_samples, destination);
+}
@@ -0,0 +1,57 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+
+// Vectorized versions of the operations we perform on audio buffers when audio
+// crosses the shared memory boundary. These use SSE2, which is always available
+// since we compile with `-msse2` (even for the 32-bit bitbridge), and AVX2 when
+// the CPU supports it. Which implementation gets used is determined once when
+// the library gets loaded. Plain copies are left to `std::copy_n()` since that
+// ends up calling `memcpy()`, which already does this same kind of dispatching.
+
+/**
+ * Check whether an audio buffer contains only (positive or negative) zeroes.
+ * This is used to avoid copying silent audio to and from the shared memory
+ * audio buffers. The samples are checked in blocks of 64 bytes so we can bail
+ * early as soon as we encounter any audio.
+ */
+bool is_silent(const float* samples, size_t num_samples) noexcept;
+bool is_silent(const double* samples, size_t num_samples) noexcept;
+
+/**
+ * Add `num_samples` samples from `samples` to the samples in `destination`.
+ * This is needed for VST2's accumulating `process()` function.
+ */
+void accumulate_samples(const float* samples,
+                        size_t num_samples,
+                        float* destination) noexcept;
+void accumulate_samples(const double* samples,
+                        size_t num_samples,
+                        double* destination) noexcept;
+
+/**
+ * Convert `num_samples` samples between single and double precision. The two
+ * buffers should not overlap.
+ */
+void convert_samples(const float* samples,
+                     size_t num_samples,
+                     double* destination) noexcept;
+void convert_samples(const double* samples,
+                     size_t num_samples,
+                     float* destination) noexcept;
@@ -0,0 +1,197 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "audio-shm-arena.h"
+
+#include <sys/mman.h>
+#include <cassert>
+
+/**
+ * Allocations are page aligned so the native plugin can map just its own part
+ * of a chunk.
+ */
+constexpr uint32_t arena_page_size = 4096;
+
+/**
+ * Round a size in bytes up to a whole number of pages.
+ */
+constexpr uint32_t round_up_to_pages(uint32_t size) noexcept {
+    return (size + arena_page_size - 1) & ~(arena_page_size - 1);
+}
+
+/**
+ * Remove a stale shared memory object left behind by a group host process that
+ * crashed before it could clean up after itself, and return the name again.
+ * Only one group host process can be active for a group at a time, so any
+ * existing object with this name is no longer in use.
+ */
+std::string remove_stale_chunk(std::string name) {
+    boost::interprocess::shared_memory_object::remove(name.c_str());
+    return name;
+}
+
+AudioShmArena::Chunk::Chunk(std::string name, uint32_t size)
+    : name(remove_stale_chunk(std::move(name))),
+      size(size),
+      shm(boost::interprocess::create_only,
+          this->name.c_str(),
+          boost::interprocess::read_write) {
+    // The object is sparse, so this does not use any memory until the
+    // allocations get written to
+    shm.truncate(size);
+    region = boost::interprocess::mapped_region(
+        shm, boost::interprocess::read_write, 0, size);
+
+    free_blocks.emplace(0, size);
+}
+
+AudioShmArena::AudioShmArena(std::string name_prefix)
+    : name_prefix(std::move(name_prefix)) {}
+
+AudioShmArena::~AudioShmArena() noexcept {
+    remove_objects();
+}
+
+void AudioShmArena::remove_objects() noexcept {
+    std::lock_guard lock(chunks_mutex);
+    for (const auto& chunk : chunks) {
+        boost::interprocess::shared_memory_object::remove(chunk->name.c_str());
+    }
+}
+
+AudioShmArena::Allocation AudioShmArena::allocate(uint32_t size) {
+    size = round_up_to_pages(size);
+
+    std::lock_guard lock(chunks_mutex);
+    for (size_t chunk = 0; chunk < chunks.size(); chunk++) {
+        if (const auto offset = take_free_block(*chunks[chunk], size)) {
+            return Allocation{.chunk = chunk, .offset = *offset, .size = size};
+        }
+    }
+
+    // If none of the existing chunks have enough space left, then we'll add
+    // another one
+    const size_t chunk = chunks.size();
+    chunks.push_back(std::make_unique<Chunk>(
+        name_prefix + "-" + std::to_string(chunk), std::max(size, chunk_size)));
+    const auto offset = take_free_block(*chunks[chunk], size);
+    assert(offset);
+
+    return Allocation{.chunk = chunk, .offset = *offset, .size = size};
+}
+
+bool AudioShmArena::resize_in_place(Allocation& allocation,
+                                    uint32_t new_size) {
+    new_size = round_up_to_pages(new_size);
+
+    std::lock_guard lock(chunks_mutex);
+    Chunk& chunk = *chunks[allocation.chunk];
+    if (new_size <= allocation.size) {
+        if (new_size < allocation.size) {
+            add_free_block(chunk, allocation.offset + new_size,
+                           allocation.size - new_size);
+        }
+
+        allocation.size = new_size;
+        return true;
+    }
+
+    // We can only grow the allocation if it's directly followed by a large
+    // enough free block
+    const uint32_t end = allocation.offset + allocation.size;
+    const uint32_t additional_size = new_size - allocation.size;
+    const auto next_block = chunk.free_blocks.find(end);
+    if (next_block == chunk.free_blocks.end() ||
+        next_block->second < additional_size) {
+        return false;
+    }
+
+    const uint32_t remaining_size = next_block->second - additional_size;
+    chunk.free_blocks.erase(next_block);
+    if (remaining_size > 0) {
+        chunk.free_blocks.emplace(end + additional_size, remaining_size);
+    }
+
+    allocation.size = new_size;
+    return true;
+}
+
+void AudioShmArena::deallocate(const Allocation& allocation) noexcept {
+    std::lock_guard lock(chunks_mutex);
+    add_free_block(*chunks[allocation.chunk], allocation.offset,
+                   allocation.size);
+}
+
+std::string AudioShmArena::name(const Allocation& allocation) {
+    std::lock_guard lock(chunks_mutex);
+    return chunks[allocation.chunk]->name;
+}
+
+uint8_t* AudioShmArena::data(const Allocation& allocation) {
+    std::lock_guard lock(chunks_mutex);
+    return static_cast<uint8_t*>(
+               chunks[allocation.chunk]->region.get_address()) +
+           allocation.offset;
+}
+
+std::optional<uint32_t> AudioShmArena::take_free_block(Chunk& chunk,
+                                                       uint32_t size) {
+    for (auto it = chunk.free_blocks.begin(); it != chunk.free_blocks.end();
+         it++) {
+        const auto [offset, block_size] = *it;
+        if (block_size >= size) {
+            chunk.free_blocks.erase(it);
+            if (block_size > size) {
+                chunk.free_blocks.emplace(offset + size, block_size - size);
+            }
+
+            return offset;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void AudioShmArena::add_free_block(Chunk& chunk,
+                                   uint32_t offset,
+                                   uint32_t size) {
+    // The freed memory is released back to the system by punching a hole in
+    // the shared memory object. Reusing this space later will then also
+    // result in zeroed memory, just like with a freshly created object. The
+    // memory needs to be unlocked first since it may have been locked by
+    // `AudioShmBuffer`.
+    uint8_t* data = static_cast<uint8_t*>(chunk.region.get_address()) + offset;
+    munlock(data, size);
+    madvise(data, size, MADV_REMOVE);
+
+    auto [it, inserted] = chunk.free_blocks.emplace(offset, size);
+    assert(inserted);
+
+    // Coalesce with the next block, and then with the previous block
+    if (const auto next = std::next(it);
+        next != chunk.free_blocks.end() &&
+        it->first + it->second == next->first) {
+        it->second += next->second;
+        chunk.free_blocks.erase(next);
+    }
+    if (it != chunk.free_blocks.begin()) {
+        if (const auto previous = std::prev(it);
+            previous->first + previous->second == it->first) {
+            previous->second += it->second;
+            chunk.free_blocks.erase(it);
+        }
+    }
+}
@@ -0,0 +1,178 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifdef __WINE__
+#include "../wine-host/boost-fix.h"
+#endif
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+/**
+ * Sub-allocates the shared memory audio buffers for all plugin instances in a
+ * plugin group from a small number of large shared memory objects. Without
+ * this every plugin instance would create its own shared memory object in
+ * `/dev/shm`, which for a large group would result in many files, many
+ * mappings on the Wine side, and a lot of `mmap()`/`munmap()` churn whenever
+ * the host changes its buffer size while loading a project.
+ *
+ * The arena lives in the Wine plugin host, where it's owned by `GroupBridge`.
+ * Every chunk is mapped only once in the Wine plugin host, and the native
+ * plugins map just the part of a chunk that belongs to them. The chunks are
+ * sparse, so only the memory that's actually in use takes up any space, and
+ * freed allocations are released back to the system.
+ *
+ * @see AudioShmBuffer
+ */
+class AudioShmArena {
+   public:
+    /**
+     * The size of a single shared memory object in the arena. Allocations
+     * larger than this get a chunk of their own.
+     */
+    static constexpr uint32_t chunk_size = 64 * 1024 * 1024;
+
+    /**
+     * A part of one of the arena's chunks handed out by `allocate()`.
+     */
+    struct Allocation {
+        /**
+         * The index of the chunk in `chunks`.
+         */
+        size_t chunk = 0;
+        /**
+         * The offset of this allocation within the chunk's shared memory
+         * object in bytes. This is always page aligned so the native plugin
+         * can map only this part of the object.
+         */
+        uint32_t offset = 0;
+        /**
+         * The size of this allocation in bytes, rounded up to whole pages.
+         */
+        uint32_t size = 0;
+    };
+
+    /**
+     * Create an empty arena. Chunks are created on demand.
+     *
+     * @param name_prefix The prefix for the names of the shared memory objects
+     *   backing this arena. This should be unique to the plugin group.
+     */
+    explicit AudioShmArena(std::string name_prefix);
+
+    /**
+     * Removes all shared memory objects created by this arena. All buffers
+     * allocated from this arena need to have been destroyed by this point.
+     */
+    ~AudioShmArena() noexcept;
+
+    /**
+     * Remove all shared memory objects created by this arena from `/dev/shm`
+     * without unmapping them. This is called from the destructor, and it
+     * should also be called before the process terminates without running
+     * destructors.
+     */
+    void remove_objects() noexcept;
+
+    AudioShmArena(const AudioShmArena&) = delete;
+    AudioShmArena& operator=(const AudioShmArena&) = delete;
+
+    /**
+     * Allocate `size` bytes, rounded up to whole pages. This reuses previously
+     * freed space if possible, and creates a new chunk otherwise.
+     *
+     * @throw boost::interprocess::interprocess_exception If a new chunk could
+     *   not be created.
+     */
+    Allocation allocate(uint32_t size);
+
+    /**
+     * Try to grow or shrink an allocation to `new_size` bytes without moving
+     * it. Shrinking always succeeds, and growing succeeds if the space right
+     * after the allocation is free.
+     *
+     * @return Whether the allocation could be resized. `allocation` is only
+     *   modified if this returns true.
+     */
+    bool resize_in_place(Allocation& allocation, uint32_t new_size);
+
+    /**
+     * Return an allocation to the arena, and release its memory back to the
+     * system.
+     */
+    void deallocate(const Allocation& allocation) noexcept;
+
+    /**
+     * The name of the shared memory object an allocation lives in.
+     */
+    std::string name(const Allocation& allocation);
+
+    /**
+     * The start of an allocation within the Wine plugin host's mapping of
+     * its chunk.
+     */
+    uint8_t* data(const Allocation& allocation);
+
+   private:
+    /**
+     * One of the shared memory objects backing this arena.
+     */
+    struct Chunk {
+        Chunk(std::string name, uint32_t size);
+
+        std::string name;
+        uint32_t size;
+        boost::interprocess::shared_memory_object shm;
+        boost::interprocess::mapped_region region;
+
+        /**
+         * The free blocks in this chunk, stored as an `offset -> size` map so
+         * adjacent blocks can be coalesced when they're freed.
+         */
+        std::map<uint32_t, uint32_t> free_blocks;
+    };
+
+    /**
+     * Take `size` bytes from the first free block that fits in `chunk`, if
+     * there is one.
+     */
+    static std::optional<uint32_t> take_free_block(Chunk& chunk,
+                                                   uint32_t size);
+
+    /**
+     * Mark `[offset, offset + size)` in `chunk` as free, coalescing it with
+     * its neighbouring free blocks.
+     */
+    static void add_free_block(Chunk& chunk, uint32_t offset, uint32_t size);
+
+    const std::string name_prefix;
+
+    /**
+     * Buffers are set up from different threads (for instance, VST3 plugins
+     * handle `IAudioProcessor::setupProcessing()` on their own audio thread),
+     * so allocations need to be synchronized.
+     */
+    std::mutex chunks_mutex;
+    std::vector<std::unique_ptr<Chunk>> chunks;
+};
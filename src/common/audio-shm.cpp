@@ -16,51 +16,419 @@
 
 #include "audio-shm.h"
 
-AudioShmBuffer::AudioShmBuffer(const Config& config)
-    : config(config),
-      shm(boost::interprocess::open_or_create,
-          config.name.c_str(),
-          boost::interprocess::read_write) {
-    shm.truncate(config.size);
-    buffer =
-        boost::interprocess::mapped_region(shm, boost::interprocess::read_write,
-                                           0, config.size, nullptr, MAP_LOCKED);
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+
+AudioShmBuffer::AudioShmBuffer(const Config& config) : config(config) {
+    if (config.memfd) {
+        // The Wine plugin host creates the memfd, and the native plugin
+        // receives a file descriptor for it along with the configuration
+        if (config.fd == -1) {
+            memfd = memfd_create(config.name.c_str(), MFD_CLOEXEC);
+            if (memfd == -1) {
+                throw std::runtime_error(
+                    "Could not create a memfd for the audio buffers: " +
+                    std::string(strerror(errno)));
+            }
+            this->config.fd = memfd;
+        } else {
+            memfd = config.fd;
+        }
+    } else {
+        shm = boost::interprocess::shared_memory_object(
+            boost::interprocess::open_or_create, config.name.c_str(),
+            boost::interprocess::read_write);
+    }
+
+    map_buffer();
+}
+
+AudioShmBuffer::AudioShmBuffer(const Config& config, AudioShmArena& arena)
+    : config(config), arena(&arena), allocation(arena.allocate(config.size)) {
+    this->config.name = arena.name(allocation);
+    this->config.arena_offset = allocation.offset;
+
+    map_buffer();
 }
 
 AudioShmBuffer::~AudioShmBuffer() noexcept {
+    release();
+}
+
+void AudioShmBuffer::release() noexcept {
+    if (is_moved) {
+        return;
+    }
+
     // If either side drops this object then the buffer should always be
     // removed, so we'll do it on both sides to reduce the chance that we leak
-    // shared memory
-    if (!is_moved) {
+    // shared memory. Arenas are shared between all plugins in a group, so
+    // those are only cleaned up by the group host process.
+    if (config.memfd) {
+        // There's nothing to remove here, since the memfd will be freed once
+        // both sides have closed it
+        if (address) {
+            munmap(address, memfd_mapping_size);
+        }
+        close(memfd);
+    } else if (arena) {
+        arena->deallocate(allocation);
+    } else if (!config.arena_offset) {
         boost::interprocess::shared_memory_object::remove(config.name.c_str());
     }
 }
 
 void AudioShmBuffer::resize(const Config& new_config) {
-    if (new_config.name != config.name) {
-        throw std::invalid_argument("Expected buffer configuration for \"" +
-                                    config.name + "\", got \"" +
-                                    new_config.name + "\"");
+    bool control_block_moved = false;
+    if (arena) {
+        // We'll try to grow or shrink the allocation in place first, and if
+        // that's not possible the buffer will be moved elsewhere in the arena.
+        // The native plugin will map the new location after receiving the
+        // updated configuration.
+        control_block_moved =
+            !arena->resize_in_place(allocation, new_config.size);
+        if (control_block_moved) {
+            arena->deallocate(allocation);
+            allocation = arena->allocate(new_config.size);
+        }
+
+        config = new_config;
+        config.name = arena->name(allocation);
+        config.arena_offset = allocation.offset;
+    } else if (new_config.arena_offset) {
+        if (new_config.name != config.name) {
+            shm = boost::interprocess::shared_memory_object(
+                boost::interprocess::open_only, new_config.name.c_str(),
+                boost::interprocess::read_write);
+        }
+
+        // We can't tell whether the Wine plugin host's allocation moved, so
+        // we'll always resynchronize with the control block
+        config = new_config;
+        control_block_moved = true;
+    } else {
+        if (new_config.name != config.name) {
+            throw std::invalid_argument("Expected buffer configuration for \"" +
+                                        config.name + "\", got \"" +
+                                        new_config.name + "\"");
+        }
+
+        // The native plugin receives a new file descriptor for the same memfd
+        // every time the configuration gets sent
+        if (new_config.memfd && new_config.fd != -1 &&
+            new_config.fd != memfd) {
+            close(memfd);
+            memfd = new_config.fd;
+        }
+
+        config = new_config;
+        if (config.memfd) {
+            config.fd = memfd;
+        }
+    }
+
+    map_buffer();
+
+    // When the buffer got moved to another slice of the arena, the new control
+    // block may contain anything. The Wine plugin host will continue where
+    // the old control block left off so the futex handshake doesn't see a
+    // request that was never sent, and the native plugin will pick up those
+    // sequence numbers when it maps the new location.
+    if (control_block_moved) {
+        Control& control = this->control();
+        if (arena) {
+            control.request_seq.store(last_request_seq,
+                                      std::memory_order_relaxed);
+            control.response_seq.store(last_request_seq,
+                                       std::memory_order_relaxed);
+            control.interrupt_requested.store(0, std::memory_order_relaxed);
+            control.request_waiter_blocked.store(0, std::memory_order_release);
+            control.request_size = 0;
+            control.response_size = 0;
+        } else {
+            last_request_seq =
+                control.request_seq.load(std::memory_order_acquire);
+        }
+
+        sent_request_seq = last_request_seq;
+    }
+}
+
+void AudioShmBuffer::send_request(uint32_t request_size) noexcept {
+    Control& control = this->control();
+    control.request_size = request_size;
+
+    // These need to be sequentially consistent so we can't miss the Wine plugin
+    // host going to sleep right after we checked `request_waiter_blocked`
+    sent_request_seq =
+        control.request_seq.fetch_add(1, std::memory_order_seq_cst) + 1;
+    if (control.request_waiter_blocked.load(std::memory_order_seq_cst)) {
+        futex_wake(control.request_seq);
+    }
+}
+
+void AudioShmBuffer::set_spin_wait_limit(
+    std::chrono::nanoseconds limit) noexcept {
+    spin_wait_limit = limit;
+}
+
+AudioShmBuffer::SpinWaitStatistics AudioShmBuffer::spin_wait_statistics()
+    const noexcept {
+    return SpinWaitStatistics{
+        .num_requests = num_spin_wait_requests.load(std::memory_order_relaxed),
+        .num_spin_hits = num_spin_wait_hits.load(std::memory_order_relaxed)};
+}
+
+bool AudioShmBuffer::wait_for_request() noexcept {
+    Control& control = this->control();
+
+    // When spinning is enabled, we'll sleep until shortly before we expect the
+    // next request to arrive based on the previous cycles, and we'll then busy
+    // wait for at most `spin_wait_limit` around that point. The time between
+    // requests is usually much longer than the spin wait limit since it's
+    // roughly one buffer period, so we can't just spin right away.
+    const bool spin_wait_enabled = spin_wait_limit.count() > 0;
+    const auto wait_start = spin_wait_enabled
+                                ? std::chrono::steady_clock::now()
+                                : std::chrono::steady_clock::time_point{};
+    bool caught_while_spinning = false;
+
+    uint32_t request_seq =
+        control.request_seq.load(std::memory_order_acquire);
+    if (spin_wait_enabled && request_seq == last_request_seq &&
+        idle_time_estimate.count() > 0) {
+        const auto spin_start =
+            std::max(wait_start + idle_time_estimate - (spin_wait_limit / 2),
+                     wait_start);
+        const auto spin_deadline = spin_start + spin_wait_limit;
+
+        // While sleeping the native plugin needs to wake us up just like when
+        // we're blocking below. If the request arrives during this time we
+        // won't spin at all.
+        if (spin_start > wait_start) {
+            control.request_waiter_blocked.store(1, std::memory_order_seq_cst);
+            for (auto now = wait_start;
+                 (request_seq = control.request_seq.load(
+                      std::memory_order_seq_cst)) == last_request_seq &&
+                 now < spin_start;
+                 now = std::chrono::steady_clock::now()) {
+                futex_wait(control.request_seq, request_seq, spin_start - now);
+            }
+            control.request_waiter_blocked.store(0, std::memory_order_relaxed);
+        }
+
+        // Reading the clock is much more expensive than checking the sequence
+        // number, so we'll only do that every so often
+        for (uint32_t i = 1; request_seq == last_request_seq; i++) {
+            cpu_relax();
+            if ((request_seq = control.request_seq.load(
+                     std::memory_order_acquire)) != last_request_seq) {
+                caught_while_spinning = true;
+                break;
+            }
+
+            if (i % 64 == 0 &&
+                std::chrono::steady_clock::now() >= spin_deadline)
+                [[unlikely]] {
+                break;
+            }
+        }
+    }
+
+    // If the request hasn't arrived yet, then we'll block. The native plugin
+    // only wakes us up when `request_waiter_blocked` is set, and we need to
+    // check the sequence number again after setting it so we can't miss any
+    // requests.
+    if (request_seq == last_request_seq) {
+        control.request_waiter_blocked.store(1, std::memory_order_seq_cst);
+        while ((request_seq = control.request_seq.load(
+                    std::memory_order_seq_cst)) == last_request_seq) {
+            futex_wait(control.request_seq, request_seq);
+        }
+        control.request_waiter_blocked.store(0, std::memory_order_relaxed);
+    }
+    last_request_seq = request_seq;
+
+    // `interrupt_request_wait()` also bumps the sequence number, so we'll need
+    // to check for that first
+    if (control.interrupt_requested.exchange(0, std::memory_order_acq_rel) !=
+        0) {
+        return false;
     }
 
-    config = new_config;
-    shm.truncate(config.size);
-    buffer =
-        boost::interprocess::mapped_region(shm, boost::interprocess::read_write,
-                                           0, config.size, nullptr, MAP_LOCKED);
+    if (spin_wait_enabled) {
+        const auto idle_time = std::chrono::duration_cast<
+            std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                      wait_start);
+        idle_time_estimate += (idle_time - idle_time_estimate) / 8;
+
+        num_spin_wait_requests.store(
+            num_spin_wait_requests.load(std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+        if (caught_while_spinning) {
+            num_spin_wait_hits.store(
+                num_spin_wait_hits.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+        }
+    }
+
+    return true;
+}
+
+void AudioShmBuffer::send_response(uint32_t response_size) noexcept {
+    Control& control = this->control();
+    control.response_size = response_size;
+
+    control.response_seq.store(last_request_seq, std::memory_order_release);
+    futex_wake(control.response_seq);
+}
+
+void AudioShmBuffer::interrupt_request_wait() noexcept {
+    Control& control = this->control();
+
+    control.interrupt_requested.store(1, std::memory_order_release);
+    control.request_seq.fetch_add(1, std::memory_order_acq_rel);
+    futex_wake(control.request_seq);
+}
+
+bool AudioShmBuffer::futex_wait(std::atomic<uint32_t>& word,
+                                uint32_t expected,
+                                std::chrono::nanoseconds timeout_ns) noexcept {
+    // `std::atomic<uint32_t>` is guaranteed to have the same representation
+    // as a `uint32_t` since it's lock free, so the kernel can use it directly.
+    // We can't use `FUTEX_PRIVATE_FLAG` here since the other side lives in
+    // another process.
+    const timespec timeout{
+        .tv_sec = static_cast<time_t>(timeout_ns.count() / 1'000'000'000),
+        .tv_nsec = static_cast<long>(timeout_ns.count() % 1'000'000'000)};
+    const long result =
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT,
+                expected, &timeout, nullptr, 0);
+
+    return !(result == -1 && errno == ETIMEDOUT);
+}
+
+void AudioShmBuffer::cpu_relax() noexcept {
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+}
+
+void AudioShmBuffer::map_buffer() {
+    if (arena) {
+        // The arena maps its chunks without `MAP_LOCKED` since most of a chunk
+        // will be unused at any given time, so we'll lock our part of the
+        // chunk ourselves. This is undone when the memory is returned to the
+        // arena.
+        address = arena->data(allocation);
+        mlock(address, config.size);
+    } else if (config.memfd) {
+        // This is a no-op on the native plugin's side since the Wine plugin
+        // host will already have resized the memfd
+        if (ftruncate(memfd, config.size) == -1) {
+            throw std::runtime_error("Could not resize the audio buffers: " +
+                                     std::string(strerror(errno)));
+        }
+
+        // Unlike with named shared memory objects, we can grow or shrink the
+        // existing mapping. The kernel will only move it if it can't be
+        // resized in place.
+        void* mapping;
+        if (!address) {
+            mapping = mmap(nullptr, config.size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_LOCKED, memfd, 0);
+        } else if (memfd_mapping_size != config.size) {
+            mapping = mremap(address, memfd_mapping_size, config.size,
+                             MREMAP_MAYMOVE);
+        } else {
+            mapping = address;
+        }
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Could not map the audio buffers: " +
+                                     std::string(strerror(errno)));
+        }
+
+        address = static_cast<uint8_t*>(mapping);
+        memfd_mapping_size = config.size;
+    } else {
+        // The native plugin only maps its own part of an arena's object, and
+        // the object's size is managed by the Wine plugin host
+        if (!config.arena_offset) {
+            shm.truncate(config.size);
+        }
+        buffer = boost::interprocess::mapped_region(
+            shm, boost::interprocess::read_write,
+            config.arena_offset.value_or(0), config.size, nullptr, MAP_LOCKED);
+        address = static_cast<uint8_t*>(buffer.get_address());
+    }
+
+    // This only has an effect if shared memory huge pages are set to `advise`
+    // or higher in `/sys/kernel/mm/transparent_hugepage/shmem_enabled`, and
+    // it's merely a hint so we don't need to check whether this succeeded
+    if (config.huge_pages) {
+        madvise(address, config.size, MADV_HUGEPAGE);
+    }
+
+    if (config.lock_memory) {
+        buffer_lock_result = lock_memory(address, config.size);
+    } else {
+        buffer_lock_result = MemoryLockResult{};
+    }
+}
+
+void AudioShmBuffer::futex_wake(std::atomic<uint32_t>& word) noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
 }
 
 AudioShmBuffer::AudioShmBuffer(AudioShmBuffer&& o) noexcept
     : config(std::move(o.config)),
+      last_request_seq(o.last_request_seq),
+      sent_request_seq(o.sent_request_seq),
+      spin_wait_limit(o.spin_wait_limit),
+      idle_time_estimate(o.idle_time_estimate),
+      num_spin_wait_requests(o.num_spin_wait_requests.load()),
+      num_spin_wait_hits(o.num_spin_wait_hits.load()),
+      buffer_lock_result(o.buffer_lock_result),
+      arena(o.arena),
+      allocation(o.allocation),
       shm(std::move(o.shm)),
-      buffer(std::move(o.buffer)) {
+      buffer(std::move(o.buffer)),
+      memfd(o.memfd),
+      memfd_mapping_size(o.memfd_mapping_size),
+      address(o.address) {
     o.is_moved = true;
 }
 
 AudioShmBuffer& AudioShmBuffer::operator=(AudioShmBuffer&& o) noexcept {
+    if (&o == this) {
+        return *this;
+    }
+
+    // The buffer we're replacing would otherwise be leaked
+    release();
+
     config = std::move(o.config);
+    last_request_seq = o.last_request_seq;
+    sent_request_seq = o.sent_request_seq;
+    spin_wait_limit = o.spin_wait_limit;
+    idle_time_estimate = o.idle_time_estimate;
+    num_spin_wait_requests = o.num_spin_wait_requests.load();
+    num_spin_wait_hits = o.num_spin_wait_hits.load();
+    buffer_lock_result = o.buffer_lock_result;
+    arena = o.arena;
+    allocation = o.allocation;
     shm = std::move(o.shm);
     buffer = std::move(o.buffer);
+    memfd = o.memfd;
+    memfd_mapping_size = o.memfd_mapping_size;
+    address = o.address;
+    is_moved = false;
     o.is_moved = true;
 
     return *this;
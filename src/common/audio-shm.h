@@ -16,6 +16,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #ifdef __WINE__
@@ -24,6 +35,12 @@
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/interprocess/shared_memory_object.hpp>
 
+#include "audio-kernels.h"
+#include "audio-shm-arena.h"
+#include "bitsery/ext/file-descriptor.h"
+#include "bitsery/ext/in-place-optional.h"
+#include "utils.h"
+
 /**
  * A shared memory object that allows audio buffers to be shared between the
  * native plugin and the Wine plugin host. This is intended as an optimization,
@@ -47,9 +64,123 @@
  * for audio processing. The configuration (e.g. name, and dimensions) for this
  * shared memory object are then sent back to the plugin so the plugin can map
  * the same shared memory region.
+ *
+ * When the `audio_futex_handshake` option is enabled, the buffer will also
+ * start with a small control block. The native plugin writes its processing
+ * request to that block and the Wine plugin host writes its response back to
+ * it, and both sides signal each other by bumping a sequence number and waking
+ * the other side up using a futex on that same shared memory page. That way a
+ * processing cycle only needs one futex wake and one futex wait on either side
+ * instead of sending and receiving messages over a socket.
  */
 class AudioShmBuffer {
    public:
+    /**
+     * The control block stored at the very start of the shared memory object
+     * when the futex handshake is enabled. This is immediately followed by the
+     * request and response areas, which are both `Config::message_capacity`
+     * bytes large (rounded up to a multiple of 64 bytes). This struct has the
+     * same layout on 32-bit and 64-bit platforms so it can also be used with
+     * the bitbridge, and it's cache line aligned so the request and response
+     * areas following it are suitably aligned for any fixed-layout struct.
+     */
+    struct alignas(64) Control {
+        /**
+         * Incremented by the native plugin whenever it has written a new
+         * request to the request area. The Wine plugin host waits on this
+         * value. This is also incremented by the Wine plugin host to interrupt
+         * the thread waiting on it.
+         */
+        std::atomic<uint32_t> request_seq;
+        /**
+         * Set by the Wine plugin host to the request's sequence number after
+         * it has finished writing the response. The native plugin waits on
+         * this value.
+         */
+        std::atomic<uint32_t> response_seq;
+        /**
+         * Set by the Wine plugin host before bumping `request_seq` to make the
+         * thread waiting for requests stop waiting.
+         */
+        std::atomic<uint32_t> interrupt_requested;
+        /**
+         * Set by the Wine plugin host while it's blocked on a futex waiting
+         * for `request_seq` to change. If the Wine plugin host is still
+         * spinning in `wait_for_request()` then the native plugin doesn't
+         * need to make a system call to wake it up.
+         */
+        std::atomic<uint32_t> request_waiter_blocked;
+        /**
+         * The size of the request stored in the request area, in bytes.
+         */
+        uint32_t request_size;
+        /**
+         * The size of the response stored in the response area, in bytes. Set
+         * to `response_in_socket` if the response did not fit in there.
+         */
+        uint32_t response_size;
+    };
+
+    /**
+     * The value the Wine plugin host writes to `Control::response_size` when
+     * the response did not fit in the response area. The native plugin should
+     * then fetch that response over the socket instead.
+     */
+    static constexpr uint32_t response_in_socket =
+        std::numeric_limits<uint32_t>::max();
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    /**
+     * The size of the control block and the request and response areas
+     * following it. This is always a multiple of 64 bytes so the audio data
+     * that follows it stays nicely aligned for both single and double
+     * precision samples. Returns 0 if `message_capacity` is 0 (i.e. when the
+     * futex handshake is not used).
+     */
+    static constexpr uint32_t control_block_size(
+        uint32_t message_capacity) noexcept {
+        if (message_capacity == 0) {
+            return 0;
+        }
+
+        return sizeof(Control) +
+               (2 * aligned_message_capacity(message_capacity));
+    }
+
+    /**
+     * Audio channels are always aligned to at least a cache line. This way
+     * channels never share cache lines, and the vectorized kernels in
+     * `audio-kernels.h` can operate on aligned memory.
+     */
+    static constexpr uint32_t cache_line_size = 64;
+    /**
+     * The page size used to lay out the audio channels. The input and output
+     * channels always start on separate pages, and with the
+     * `audio_page_aligned_channels` option every channel starts on its own
+     * page.
+     */
+    static constexpr uint32_t page_size = 4096;
+    /**
+     * The size of a transparent huge page on x86. With the `audio_huge_pages`
+     * option the buffer's size is rounded up to a multiple of this.
+     */
+    static constexpr uint32_t huge_page_size = 2 * 1024 * 1024;
+
+    /**
+     * Round an offset **in samples** up so that a channel starting at that
+     * offset will be aligned to `alignment` bytes. `alignment` should be a
+     * multiple of `sample_size`. This assumes the buffer itself is page
+     * aligned, which is always the case since it's mapped using `mmap()`.
+     */
+    static constexpr uint32_t align_offset(uint32_t offset,
+                                           uint32_t sample_size,
+                                           uint32_t alignment) noexcept {
+        const uint32_t alignment_in_samples = alignment / sample_size;
+        return ((offset + alignment_in_samples - 1) / alignment_in_samples) *
+               alignment_in_samples;
+    }
+
     /**
      * The parameters needed for creating, configuring and connecting to a
      * shared audio buffer object. This is done on the Wine plugin host. For
@@ -92,10 +223,87 @@ class AudioShmBuffer {
          */
         std::vector<std::vector<uint32_t>> output_offsets;
 
+        /**
+         * The size in bytes of both the request and the response area in the
+         * control block at the start of the buffer. If this is 0, then the
+         * futex handshake is disabled, there's no control block, and the
+         * regular socket based messages are used instead.
+         *
+         * @see AudioShmBuffer::control_block_size
+         */
+        uint32_t message_capacity = 0;
+
+        /**
+         * Whether the audio channels in this buffer store double precision
+         * samples. If the host processes double precision audio but the plugin
+         * only supports single precision audio, then this will be false and the
+         * native plugin will convert the host's audio to and from single
+         * precision when copying it to and from this buffer. The Windows plugin
+         * then always processes audio at a precision it supports.
+         */
+        bool double_precision = false;
+
+        /**
+         * Whether the kernel should be asked to back this buffer with
+         * transparent huge pages. This reduces TLB pressure for plugins with
+         * a large number of channels. `size` should then be a multiple of
+         * `huge_page_size`.
+         */
+        bool huge_pages = false;
+
+        /**
+         * Whether both sides should explicitly lock this buffer into RAM and
+         * verify that it's resident after mapping it, instead of relying on
+         * `MAP_LOCKED` alone. `MAP_LOCKED` silently does nothing when
+         * `RLIMIT_MEMLOCK` is too low.
+         *
+         * @see AudioShmBuffer::memory_lock_result
+         */
+        bool lock_memory = false;
+
+        /**
+         * Whether this buffer is backed by an anonymous `memfd_create()` file
+         * instead of a named shared memory object in `/dev/shm`. The file
+         * descriptor is passed to the native plugin along with this
+         * configuration, so the buffer can't leak when either side crashes,
+         * and resizing the buffer only needs an `ftruncate()` and an
+         * `mremap()`.
+         */
+        bool memfd = false;
+
+        /**
+         * The memfd backing this buffer if `memfd` is set. The Wine plugin host
+         * leaves this at -1 when creating the buffer, and the buffer will then
+         * create the memfd. When this configuration is sent over a socket, the
+         * native plugin receives a new file descriptor for the same memfd,
+         * which `AudioShmBuffer` takes ownership of.
+         *
+         * @see bitsery::ext::FileDescriptor
+         */
+        int fd = -1;
+
+        /**
+         * If this buffer was allocated from a plugin group's
+         * `AudioShmArena`, then this is the page aligned offset in bytes of
+         * the buffer within the shared memory object called `name`. The
+         * native plugin then maps only `[arena_offset, arena_offset + size)`
+         * and it will not resize or remove the object since it's shared with
+         * the other plugins in the group.
+         */
+        std::optional<uint32_t> arena_offset;
+
         template <typename S>
         void serialize(S& s) {
             s.text1b(name, 1024);
             s.value4b(size);
+            s.value4b(message_capacity);
+            s.value1b(double_precision);
+            s.value1b(huge_pages);
+            s.value1b(lock_memory);
+            s.value1b(memfd);
+            s.ext(fd, bitsery::ext::FileDescriptor{});
+            s.ext(arena_offset, bitsery::ext::InPlaceOptional(),
+                  [](S& s, auto& v) { s.value4b(v); });
             s.container(input_offsets, 8192, [](S& s, auto& offsets) {
                 s.container4b(offsets, 8192);
             });
@@ -108,14 +316,27 @@ class AudioShmBuffer {
     /**
      * Connect to or create the shared memory object and map it to this
      * process's memory. The configuration is created on the Wine side using the
-     * process described in `Config`'s docstring.
+     * process described in `Config`'s docstring. If `config.memfd` is set,
+     * then this creates a new memfd when `config.fd` is -1, and it takes
+     * ownership of `config.fd` otherwise.
      */
     AudioShmBuffer(const Config& config);
 
+    /**
+     * Allocate the buffer from a plugin group's shared memory arena instead of
+     * creating a new shared memory object for it. Used on the Wine plugin host
+     * side. `config.name` and `config.arena_offset` will be overwritten, so the
+     * configuration should be read back from `config` afterwards and sent to
+     * the native plugin. The arena needs to outlive this object.
+     */
+    AudioShmBuffer(const Config& config, AudioShmArena& arena);
+
     /**
      * Destroy the shared memory object. Either side dropping the object will
      * cause the object to get destroyed in an effort to avoid memory leaks
-     * caused by crashing plugins or hosts.
+     * caused by crashing plugins or hosts. Buffers allocated from an arena are
+     * instead returned to the arena by the Wine plugin host, and the native
+     * plugin only unmaps its part of the arena.
      */
     ~AudioShmBuffer() noexcept;
 
@@ -127,13 +348,194 @@ class AudioShmBuffer {
 
     /**
      * Adapt to a new buffer size or channel layout. The name of the buffer
-     * needs to remain the same.
+     * needs to remain the same, unless the buffer was allocated from an arena.
+     * In that case the Wine plugin host may need to move the buffer to another
+     * place in the arena, and the new name and offset can be read from
+     * `config` afterwards. Memfd backed buffers are resized in place when
+     * possible, and the native plugin takes ownership of the new file
+     * descriptor in `new_config.fd`.
      *
      * @throw `std::invalid_argument` If the config is for a buffer with a
      *   different name.
      */
     void resize(const Config& new_config);
 
+    /**
+     * The result of pre-faulting and locking the buffer after it was last
+     * mapped. Only meaningful if `config.lock_memory` is set.
+     */
+    inline const MemoryLockResult& memory_lock_result() const noexcept {
+        return buffer_lock_result;
+    }
+
+    /**
+     * Whether this buffer contains a control block for the futex handshake.
+     * If this returns false, then the functions below should not be used.
+     */
+    inline bool uses_futex_handshake() const noexcept {
+        return config.message_capacity > 0;
+    }
+
+    /**
+     * The area the native plugin should write its request to before calling
+     * `send_request_and_wait()`. This is `config.message_capacity` bytes large.
+     */
+    inline uint8_t* request_data() noexcept {
+        return address + sizeof(Control);
+    }
+
+    /**
+     * The area the Wine plugin host should write its response to before
+     * calling `send_response()`. This is `config.message_capacity` bytes
+     * large.
+     */
+    inline uint8_t* response_data() noexcept {
+        return request_data() +
+               aligned_message_capacity(config.message_capacity);
+    }
+
+    /**
+     * Access the request area as a fixed-layout request object of type `T`.
+     * This lets both sides read and write the request in place without having
+     * to serialize it first. `T` needs to be trivially copyable and it needs
+     * to have the same layout on 32-bit and 64-bit platforms, and
+     * `config.message_capacity` has to be at least `sizeof(T)`.
+     */
+    template <typename T>
+    T& request_as() noexcept {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(alignof(T) <= alignof(Control));
+        assert(sizeof(T) <= config.message_capacity);
+
+        return *reinterpret_cast<T*>(request_data());
+    }
+
+    /**
+     * The same as `request_as()`, but for the response area.
+     */
+    template <typename T>
+    T& response_as() noexcept {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(alignof(T) <= alignof(Control));
+        assert(sizeof(T) <= config.message_capacity);
+
+        return *reinterpret_cast<T*>(response_data());
+    }
+
+    inline Control& control() noexcept {
+        return *reinterpret_cast<Control*>(address);
+    }
+
+    /**
+     * Signal the Wine plugin host that a request of `request_size` bytes has
+     * been written to `request_data()` without waiting for the response. Used
+     * on the native plugin side. `wait_for_response()` has to be called before
+     * the next request can be sent, and before the request and response areas
+     * or the audio channels can be accessed again.
+     */
+    void send_request(uint32_t request_size) noexcept;
+
+    /**
+     * Wait until the Wine plugin host has written its response to the last
+     * request sent through `send_request()` to `response_data()`. Used on the
+     * native plugin side. The size of the response can be read from
+     * `control().response_size` afterwards.
+     *
+     * @param is_alive A function that's called every second while we're
+     *   waiting. If this returns false, then we'll stop waiting. This prevents
+     *   us from hanging forever if the Wine plugin host crashes.
+     *
+     * @throw std::runtime_error If `is_alive` returned false.
+     */
+    template <std::invocable F>
+    void wait_for_response(F&& is_alive) {
+        Control& control = this->control();
+
+        uint32_t response_seq;
+        while ((response_seq = control.response_seq.load(
+                    std::memory_order_acquire)) != sent_request_seq) {
+            if (!futex_wait(control.response_seq, response_seq) &&
+                !is_alive()) {
+                throw std::runtime_error(
+                    "The Wine plugin host stopped responding to audio "
+                    "processing requests");
+            }
+        }
+    }
+
+    /**
+     * `send_request()` followed by `wait_for_response()`.
+     */
+    template <std::invocable F>
+    void send_request_and_wait(uint32_t request_size, F&& is_alive) {
+        send_request(request_size);
+        wait_for_response(std::forward<F>(is_alive));
+    }
+
+    /**
+     * Statistics about the spin wait in `wait_for_request()`.
+     *
+     * @see AudioShmBuffer::set_spin_wait_limit
+     */
+    struct SpinWaitStatistics {
+        /**
+         * The number of requests received through `wait_for_request()`.
+         */
+        uint64_t num_requests = 0;
+        /**
+         * The number of those requests that arrived while we were still
+         * spinning, so the thread did not have to be woken up by the
+         * scheduler.
+         */
+        uint64_t num_spin_hits = 0;
+    };
+
+    /**
+     * Allow `wait_for_request()` to spin for up to `limit` before blocking on
+     * a futex. This avoids the scheduler's wakeup latency when the next request
+     * arrives shortly after the last response was sent, which can make up a
+     * considerable part of the processing period at low latencies. Based on
+     * how long we've been waiting for new requests in previous cycles, we'll
+     * sleep until shortly before the next request is expected to arrive and
+     * then spin for at most `limit` around that point. A limit of zero
+     * disables spinning, which is the default.
+     */
+    void set_spin_wait_limit(std::chrono::nanoseconds limit) noexcept;
+
+    /**
+     * Get the statistics for the spin wait in `wait_for_request()`. These are
+     * only tracked when spinning is enabled. This can be called from any
+     * thread.
+     */
+    SpinWaitStatistics spin_wait_statistics() const noexcept;
+
+    /**
+     * Wait for the native plugin to call `send_request_and_wait()`. Used on
+     * the Wine plugin host side on the thread dedicated to handling these
+     * requests. The request can then be read from `request_data()`. This may
+     * spin for a short while before blocking, see `set_spin_wait_limit()`.
+     *
+     * @return True if a new request has been written to the request area, or
+     *   false if `interrupt_request_wait()` has been called and the thread
+     *   calling this function should terminate.
+     */
+    bool wait_for_request() noexcept;
+
+    /**
+     * Signal the native plugin that the `response_size` bytes large response
+     * to the last request received through `wait_for_request()` has been
+     * written to `response_data()`.
+     */
+    void send_response(uint32_t response_size) noexcept;
+
+    /**
+     * Make the thread currently blocked in `wait_for_request()` return false.
+     * This needs to be done before resizing or destroying this buffer while
+     * the futex handshake is in use, and it should only be called when such a
+     * thread is actually running.
+     */
+    void interrupt_request_wait() noexcept;
+
     inline size_t num_input_channels(const uint32_t bus) const {
         return config.input_offsets[bus].size();
     }
@@ -149,14 +551,14 @@ class AudioShmBuffer {
      */
     template <typename T>
     T* input_channel_ptr(const uint32_t bus, const uint32_t channel) noexcept {
-        return reinterpret_cast<T*>(buffer.get_address()) +
+        return reinterpret_cast<T*>(address) +
                config.input_offsets[bus][channel];
     }
 
     template <typename T>
     const T* input_channel_ptr(const uint32_t bus,
                                const uint32_t channel) const noexcept {
-        return reinterpret_cast<const T*>(buffer.get_address()) +
+        return reinterpret_cast<const T*>(address) +
                config.input_offsets[bus][channel];
     }
 
@@ -167,22 +569,164 @@ class AudioShmBuffer {
      */
     template <typename T>
     T* output_channel_ptr(const uint32_t bus, const uint32_t channel) noexcept {
-        return reinterpret_cast<T*>(buffer.get_address()) +
+        return reinterpret_cast<T*>(address) +
                config.output_offsets[bus][channel];
     }
 
     template <typename T>
     const T* output_channel_ptr(const uint32_t bus,
                                 const uint32_t channel) const noexcept {
-        return reinterpret_cast<const T*>(buffer.get_address()) +
+        return reinterpret_cast<const T*>(address) +
                config.output_offsets[bus][channel];
     }
 
+    /**
+     * Copy `num_samples` samples from `samples` to an input audio channel
+     * storing samples of type `T`. If the host's samples are of a different
+     * type, then they will be converted. Used on the native plugin side.
+     */
+    template <typename T, typename U>
+    void write_input_channel(const uint32_t bus,
+                             const uint32_t channel,
+                             const U* samples,
+                             const uint32_t num_samples) noexcept {
+        if constexpr (std::is_same_v<T, U>) {
+            std::copy_n(samples, num_samples,
+                        input_channel_ptr<T>(bus, channel));
+        } else {
+            convert_samples(samples, num_samples,
+                            input_channel_ptr<T>(bus, channel));
+        }
+    }
+
+    /**
+     * Make sure the first `num_samples` samples of an input audio channel are
+     * silent. Used on the native plugin side for channels the host marked as
+     * silent. This is cheaper than copying the host's silent buffer since we
+     * don't have to read from it.
+     *
+     * NOTE: We can't skip this when the channel was already cleared during the
+     *       last processing cycle. Nothing stops a plugin from processing in
+     *       place by writing to its input buffers, so the shared memory may no
+     *       longer contain silence.
+     */
+    template <typename T>
+    void clear_input_channel(const uint32_t bus,
+                             const uint32_t channel,
+                             const uint32_t num_samples) noexcept {
+        std::fill_n(input_channel_ptr<T>(bus, channel), num_samples, T(0));
+    }
+
     Config config;
 
    private:
+    /**
+     * `message_capacity` rounded up to a multiple of 64 bytes. The request and
+     * response areas are this large so the response area and the audio data
+     * following it stay aligned.
+     */
+    static constexpr uint32_t aligned_message_capacity(
+        uint32_t message_capacity) noexcept {
+        return (message_capacity + 63) & ~static_cast<uint32_t>(63);
+    }
+
+    /**
+     * Wait until `word` no longer contains `expected`, or until `timeout_ns`
+     * has passed. This may also return spuriously, so the caller should check
+     * the value again.
+     *
+     * @return False if we timed out, true otherwise.
+     */
+    static bool futex_wait(std::atomic<uint32_t>& word,
+                           uint32_t expected,
+                           std::chrono::nanoseconds timeout_ns =
+                               std::chrono::seconds(1)) noexcept;
+
+    /**
+     * Hint to the CPU that we're in a spin loop.
+     */
+    static void cpu_relax() noexcept;
+
+    /**
+     * Map the shared memory object using the size from `config`, and ask the
+     * kernel to use transparent huge pages if `config.huge_pages` is set. For
+     * buffers allocated from an arena this only maps this buffer's part of the
+     * object on the native side, and it reuses the arena's mapping on the Wine
+     * side.
+     */
+    void map_buffer();
+
+    /**
+     * Free this buffer's shared memory, mapping, or arena allocation as
+     * described in the destructor. Does nothing if this object has been moved
+     * from.
+     */
+    void release() noexcept;
+
+    /**
+     * Wake up all threads waiting on `word`. This works across processes
+     * since we're using shared (not private) futexes.
+     */
+    static void futex_wake(std::atomic<uint32_t>& word) noexcept;
+
+    /**
+     * The sequence number of the last request handled through
+     * `wait_for_request()`. Only used on the Wine plugin host side.
+     */
+    uint32_t last_request_seq = 0;
+    /**
+     * The sequence number of the last request sent through `send_request()`.
+     * Only used on the native plugin side.
+     */
+    uint32_t sent_request_seq = 0;
+
+    /**
+     * The maximum amount of time `wait_for_request()` may spin for before
+     * blocking. Zero if spinning is disabled.
+     */
+    std::chrono::nanoseconds spin_wait_limit{0};
+    /**
+     * An exponential moving average of the time between `wait_for_request()`
+     * being called and the next request arriving. This is used to determine
+     * the spin window.
+     */
+    std::chrono::nanoseconds idle_time_estimate{0};
+
+    // These counters are only written to from the thread calling
+    // `wait_for_request()`, but they may be read from other threads
+    std::atomic_uint64_t num_spin_wait_requests = 0;
+    std::atomic_uint64_t num_spin_wait_hits = 0;
+
+    MemoryLockResult buffer_lock_result;
+
+    /**
+     * The arena this buffer was allocated from, if it was allocated from an
+     * arena on the Wine plugin host side. In that case `shm` and `buffer` are
+     * not used.
+     */
+    AudioShmArena* arena = nullptr;
+    AudioShmArena::Allocation allocation;
+
     boost::interprocess::shared_memory_object shm;
     boost::interprocess::mapped_region buffer;
 
+    /**
+     * The memfd backing this buffer when `config.memfd` is set. In that case
+     * we'll manage the mapping ourselves instead of using `shm` and `buffer`,
+     * since Boost.Interprocess can't resize mappings in place.
+     */
+    int memfd = -1;
+    /**
+     * The size of the memfd mapping starting at `address`.
+     */
+    size_t memfd_mapping_size = 0;
+
+    /**
+     * The start of the buffer in this process's address space. This is either
+     * the start of `buffer` or of the memfd mapping, or it points into one of
+     * the arena's mappings.
+     */
+    uint8_t* address = nullptr;
+
     bool is_moved = false;
 };
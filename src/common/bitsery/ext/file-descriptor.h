@@ -0,0 +1,109 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <bitsery/details/serialization_common.h>
+#include <bitsery/traits/core/traits.h>
+
+namespace bitsery {
+namespace ext {
+
+/**
+ * An adapter for passing file descriptors to the other side of a socket. File
+ * descriptor numbers are meaningless in another process, so instead of
+ * serializing the number itself, we'll add the file descriptor to a thread
+ * local list and serialize its index in that list. `write_object()` then sends
+ * all file descriptors in that list along with the message using
+ * `SCM_RIGHTS`, and `read_object()` receives them into another thread local
+ * list before deserializing the object. The deserialized object will contain
+ * a new file descriptor referring to the same file, which the receiving side
+ * is responsible for closing.
+ *
+ * Objects containing file descriptors should only be sent using
+ * `write_object()`. A file descriptor of -1 is passed as is.
+ */
+class FileDescriptor {
+   public:
+    template <typename Ser, typename Fnc>
+    void serialize(Ser& ser, const int& fd, Fnc&&) const {
+        int32_t index = -1;
+        if (fd != -1) {
+            index = static_cast<int32_t>(outgoing().size());
+            outgoing().push_back(fd);
+        }
+
+        ser.value4b(index);
+    }
+
+    template <typename Des, typename Fnc>
+    void deserialize(Des& des, int& fd, Fnc&&) const {
+        int32_t index;
+        des.value4b(index);
+
+        if (index == -1) {
+            fd = -1;
+            return;
+        }
+        if (index < 0 || static_cast<size_t>(index) >= incoming().size() ||
+            incoming()[index] == -1) {
+            throw std::runtime_error(
+                "Expected a file descriptor to be sent along with the object");
+        }
+
+        // `read_object()` closes all received file descriptors that were not
+        // claimed by the object, so we'll make sure they're claimed only once
+        fd = incoming()[index];
+        incoming()[index] = -1;
+    }
+
+    /**
+     * The file descriptors that should be sent along with the object that's
+     * currently being serialized on this thread.
+     */
+    static std::vector<int>& outgoing() {
+        thread_local std::vector<int> file_descriptors;
+        return file_descriptors;
+    }
+
+    /**
+     * The file descriptors that were received along with the object that's
+     * currently being deserialized on this thread.
+     */
+    static std::vector<int>& incoming() {
+        thread_local std::vector<int> file_descriptors;
+        return file_descriptors;
+    }
+};
+
+}  // namespace ext
+
+namespace traits {
+
+template <>
+struct ExtensionTraits<ext::FileDescriptor, int> {
+    using TValue = void;
+    static constexpr bool SupportValueOverload = false;
+    static constexpr bool SupportObjectOverload = true;
+    static constexpr bool SupportLambdaOverload = false;
+};
+
+}  // namespace traits
+}  // namespace bitsery
@@ -1,5 +1,9 @@
 #include "common.h"
 
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
 #include <random>
 
 #include "../utils.h"
@@ -36,3 +40,120 @@ boost::filesystem::path generate_endpoint_base(const std::string& plugin_name) {
 
     return candidate_endpoint;
 }
+
+void write_message_length(int socket,
+                          uint64_t size,
+                          const std::vector<int>& file_descriptors) {
+    assert(file_descriptors.size() <= max_passed_file_descriptors);
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) *
+                                             max_passed_file_descriptors)]{};
+    const size_t file_descriptors_size =
+        sizeof(int) * file_descriptors.size();
+
+    iovec message_length{.iov_base = &size, .iov_len = sizeof(size)};
+    msghdr message{};
+    message.msg_iov = &message_length;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = CMSG_SPACE(file_descriptors_size);
+
+    cmsghdr* control_message = CMSG_FIRSTHDR(&message);
+    control_message->cmsg_level = SOL_SOCKET;
+    control_message->cmsg_type = SCM_RIGHTS;
+    control_message->cmsg_len = CMSG_LEN(file_descriptors_size);
+    std::copy(file_descriptors.begin(), file_descriptors.end(),
+              reinterpret_cast<int*>(CMSG_DATA(control_message)));
+
+    // The file descriptors are attached to the first byte, so if this somehow
+    // results in a short write we'll write the rest of the size without them
+    size_t bytes_written = 0;
+    while (bytes_written < sizeof(size)) {
+        const ssize_t result = sendmsg(socket, &message, MSG_NOSIGNAL);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Boost.Asio may have put the socket in non-blocking mode
+                pollfd poll_fd{.fd = socket, .events = POLLOUT, .revents = 0};
+                poll(&poll_fd, 1, -1);
+                continue;
+            }
+
+            throw boost::system::system_error(boost::system::error_code(
+                errno, boost::system::system_category()));
+        }
+
+        bytes_written += result;
+        message_length.iov_base =
+            reinterpret_cast<uint8_t*>(&size) + bytes_written;
+        message_length.iov_len = sizeof(size) - bytes_written;
+        message.msg_control = nullptr;
+        message.msg_controllen = 0;
+    }
+}
+
+uint64_t read_message_length(int socket, std::vector<int>& file_descriptors) {
+    close_file_descriptors(file_descriptors);
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) *
+                                             max_passed_file_descriptors)];
+
+    uint64_t size;
+    size_t bytes_read = 0;
+    while (bytes_read < sizeof(size)) {
+        iovec message_length{
+            .iov_base = reinterpret_cast<uint8_t*>(&size) + bytes_read,
+            .iov_len = sizeof(size) - bytes_read};
+        msghdr message{};
+        message.msg_iov = &message_length;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        const ssize_t result = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+        if (result == 0) {
+            throw boost::system::system_error(boost::asio::error::eof);
+        } else if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                pollfd poll_fd{.fd = socket, .events = POLLIN, .revents = 0};
+                poll(&poll_fd, 1, -1);
+                continue;
+            }
+
+            throw boost::system::system_error(boost::system::error_code(
+                errno, boost::system::system_category()));
+        }
+
+        for (cmsghdr* control_message = CMSG_FIRSTHDR(&message);
+             control_message != nullptr;
+             control_message = CMSG_NXTHDR(&message, control_message)) {
+            if (control_message->cmsg_level == SOL_SOCKET &&
+                control_message->cmsg_type == SCM_RIGHTS) {
+                const int* received_file_descriptors =
+                    reinterpret_cast<const int*>(CMSG_DATA(control_message));
+                const size_t num_file_descriptors =
+                    (control_message->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                file_descriptors.insert(
+                    file_descriptors.end(), received_file_descriptors,
+                    received_file_descriptors + num_file_descriptors);
+            }
+        }
+
+        bytes_read += result;
+    }
+
+    return size;
+}
+
+void close_file_descriptors(std::vector<int>& file_descriptors) noexcept {
+    for (const int fd : file_descriptors) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    file_descriptors.clear();
+}
@@ -16,8 +16,18 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <bitsery/adapter/buffer.h>
 #include <bitsery/bitsery.h>
@@ -33,6 +43,7 @@
 #include <boost/container/small_vector.hpp>
 #include <boost/filesystem.hpp>
 
+#include "../bitsery/ext/file-descriptor.h"
 #include "../bitsery/traits/small-vector.h"
 #include "../logging/common.h"
 #include "../utils.h"
@@ -119,9 +130,50 @@ inline BOOST_ASIO_MUTABLE_BUFFER buffer(
 }  // namespace asio
 }  // namespace boost
 
+/**
+ * The maximum number of file descriptors that can be passed along with a
+ * single object using `bitsery::ext::FileDescriptor`.
+ */
+constexpr size_t max_passed_file_descriptors = 16;
+
+/**
+ * Write the size prefix for a serialized object to a socket, and pass
+ * `file_descriptors` along with it using `SCM_RIGHTS`. The other side will
+ * receive these with `read_message_length()`.
+ *
+ * @throw boost::system::system_error If the socket is closed or gets closed
+ *   during sending.
+ *
+ * @see bitsery::ext::FileDescriptor
+ */
+void write_message_length(int socket,
+                          uint64_t size,
+                          const std::vector<int>& file_descriptors);
+
+/**
+ * Read the size prefix for a serialized object from a socket. Any file
+ * descriptors sent along with it by `write_message_length()` will be stored in
+ * `file_descriptors`. Any file descriptors left in `file_descriptors` from a
+ * previous call will be closed first.
+ *
+ * @throw boost::system::system_error If the socket is closed or gets closed
+ *   while reading.
+ *
+ * @see bitsery::ext::FileDescriptor
+ */
+uint64_t read_message_length(int socket, std::vector<int>& file_descriptors);
+
+/**
+ * Close all file descriptors in `file_descriptors` that have not been claimed
+ * by `bitsery::ext::FileDescriptor` while deserializing, and clear the list.
+ */
+void close_file_descriptors(std::vector<int>& file_descriptors) noexcept;
+
 /**
  * Serialize an object using bitsery and write it to a socket. This will write
  * both the size of the serialized object and the object itself over the socket.
+ * If the object contains file descriptors serialized using
+ * `bitsery::ext::FileDescriptor`, then those are sent along with it.
  *
  * @param socket The Boost.Asio socket to write to.
  * @param object The object to write to the stream.
@@ -138,6 +190,10 @@ template <typename T, typename Socket>
 inline void write_object(Socket& socket,
                          const T& object,
                          SerializationBufferBase& buffer) {
+    std::vector<int>& file_descriptors =
+        bitsery::ext::FileDescriptor::outgoing();
+    file_descriptors.clear();
+
     const size_t size =
         bitsery::quickSerialization<OutputAdapter<SerializationBufferBase>>(
             buffer, object);
@@ -149,8 +205,13 @@ inline void write_object(Socket& socket,
     //       bit bridge. This won't make any function difference aside from the
     //       32-bit host application having to convert between 64 and 32 bit
     //       integers.
-    boost::asio::write(socket,
-                       boost::asio::buffer(std::array<uint64_t, 1>{size}));
+    if (file_descriptors.empty()) [[likely]] {
+        boost::asio::write(socket,
+                           boost::asio::buffer(std::array<uint64_t, 1>{size}));
+    } else {
+        write_message_length(socket.native_handle(), size, file_descriptors);
+        file_descriptors.clear();
+    }
     const size_t bytes_written =
         boost::asio::write(socket, boost::asio::buffer(buffer, size));
     assert(bytes_written == size);
@@ -189,13 +250,15 @@ template <typename T, typename Socket>
 inline T& read_object(Socket& socket,
                       T& object,
                       SerializationBufferBase& buffer) {
-    // See the note above on the use of `uint64_t` instead of `size_t`
-    std::array<uint64_t, 1> message_length;
-    boost::asio::read(socket, boost::asio::buffer(message_length),
-                      boost::asio::transfer_exactly(sizeof(message_length)));
+    // See the note above on the use of `uint64_t` instead of `size_t`. We
+    // can't use `boost::asio::read()` here since that would drop any file
+    // descriptors passed along with the object.
+    std::vector<int>& file_descriptors =
+        bitsery::ext::FileDescriptor::incoming();
+    const size_t size =
+        read_message_length(socket.native_handle(), file_descriptors);
 
     // Make sure the buffer is large enough
-    const size_t size = message_length[0];
     buffer.resize(size);
 
     // `boost::asio::read/write` will handle all the packet splitting and
@@ -207,6 +270,9 @@ inline T& read_object(Socket& socket,
     auto [_, success] =
         bitsery::quickDeserialization<InputAdapter<SerializationBufferBase>>(
             {buffer.begin(), size}, object);
+    if (!file_descriptors.empty()) [[unlikely]] {
+        close_file_descriptors(file_descriptors);
+    }
 
     if (!success) [[unlikely]] {
         throw std::runtime_error("Deserialization failure in call: " +
@@ -257,6 +323,72 @@ inline T read_object(Socket& socket) {
     return object;
 }
 
+/**
+ * Serialize an object using bitsery and copy it to a fixed size area in shared
+ * memory, like the request and response areas used for `AudioShmBuffer`'s
+ * futex handshake. Unlike `write_object()` this does not write the object's
+ * size, so that should be stored alongside it.
+ *
+ * @param area The memory area to write the serialized object to.
+ * @param capacity The size of `area` in bytes.
+ * @param object The object to serialize.
+ * @param buffer The buffer to serialize into before copying the results to
+ *   `area`.
+ *
+ * @return The size of the serialized object in bytes, or a nullopt if it did
+ *   not fit in `area`. In that case nothing will have been written.
+ *
+ * @relates read_object_from
+ */
+template <typename T>
+inline std::optional<uint32_t> write_object_to(
+    uint8_t* area,
+    uint32_t capacity,
+    const T& object,
+    SerializationBufferBase& buffer) {
+    const size_t size =
+        bitsery::quickSerialization<OutputAdapter<SerializationBufferBase>>(
+            buffer, object);
+    if (size > capacity) [[unlikely]] {
+        return std::nullopt;
+    }
+
+    std::copy_n(buffer.begin(), size, area);
+
+    return static_cast<uint32_t>(size);
+}
+
+/**
+ * Deserialize an object written to shared memory using `write_object_to()`.
+ *
+ * @param area The memory area containing the serialized object.
+ * @param size The size of the serialized object in bytes.
+ * @param object The object to deserialize into.
+ * @param buffer The buffer to copy the data to before deserializing it.
+ *
+ * @throw std::runtime_error If the conversion to an object was not successful.
+ *
+ * @relates write_object_to
+ */
+template <typename T>
+inline T& read_object_from(const uint8_t* area,
+                           uint32_t size,
+                           T& object,
+                           SerializationBufferBase& buffer) {
+    buffer.assign(area, area + size);
+
+    auto [_, success] =
+        bitsery::quickDeserialization<InputAdapter<SerializationBufferBase>>(
+            {buffer.begin(), size}, object);
+
+    if (!success) [[unlikely]] {
+        throw std::runtime_error("Deserialization failure in call: " +
+                                 std::string(__PRETTY_FUNCTION__));
+    }
+
+    return object;
+}
+
 /**
  * Generate a unique base directory that can be used as a prefix for all Unix
  * domain socket endpoints used in `Vst2PluginBridge`/`Vst2Bridge`. This will
@@ -530,6 +662,252 @@ class SocketHandler {
     std::optional<boost::asio::local::stream_protocol::acceptor> acceptor;
 };
 
+/**
+ * The maximum number of idle secondary sockets `AdHocSocketHandler::send()`
+ * will keep around for reuse. When more threads than this are sending requests
+ * at the same time, the excess connections will be closed again after they've
+ * been used.
+ */
+constexpr size_t max_idle_secondary_sockets = 8;
+
+/**
+ * Idle secondary sockets that have not been used for this long will be closed
+ * by `AdHocSocketHandler::send()`. This also causes the worker thread on the
+ * receiving side to exit.
+ */
+constexpr std::chrono::seconds secondary_socket_idle_timeout(10);
+
+/**
+ * Counters for how often `AdHocSocketHandler::send()` had to use something
+ * other than the primary socket. These can be used to see whether a host
+ * consistently triggers the overflow path.
+ */
+struct AdHocSocketStatistics {
+    /**
+     * The number of requests sent over the primary socket.
+     */
+    uint64_t num_primary_requests = 0;
+    /**
+     * The number of requests sent over a secondary socket that was reused from
+     * the pool of idle secondary sockets.
+     */
+    uint64_t num_pooled_requests = 0;
+    /**
+     * The number of times we had to connect a new secondary socket because the
+     * primary socket was busy and there were no idle secondary sockets.
+     */
+    uint64_t num_new_connections = 0;
+};
+
+/**
+ * The maximum number of idle worker threads an `AdHocWorkerPool` keeps around
+ * for handling future secondary socket connections.
+ */
+constexpr size_t max_idle_ad_hoc_workers = 8;
+
+/**
+ * Idle worker threads in an `AdHocWorkerPool` will exit after they haven't
+ * received a new connection for this long, as long as there are still
+ * `max_idle_ad_hoc_workers` other idle workers.
+ */
+constexpr std::chrono::seconds ad_hoc_worker_idle_timeout(30);
+
+/**
+ * A pool of worker threads used by `AdHocSocketHandler::receive_multi()` to
+ * serve incoming secondary socket connections. A worker serves a single
+ * connection until the other side closes it, and it will then wait for the
+ * next connection instead of exiting. This way bursts of concurrent requests
+ * don't have to spawn a new thread for every connection, which is especially
+ * expensive on the Wine side. New workers are only spawned when all existing
+ * workers are busy, and the number of idle workers is bounded by
+ * `max_idle_ad_hoc_workers`.
+ *
+ * @tparam Thread The thread implementation to use. On the Linux side this
+ *   should be `std::jthread` and on the Wine side this should be `Win32Thread`.
+ */
+template <typename Thread>
+class AdHocWorkerPool {
+   public:
+    /**
+     * Create an empty pool. Worker threads will be spawned on demand in
+     * `submit()`.
+     *
+     * @param callback The function that does a single read cycle for a
+     *   secondary socket. Workers will call this in a loop until the socket is
+     *   closed.
+     * @param realtime_priority The `SCHED_FIFO` priority the workers should run
+     *   with, or a nullopt if they should use the regular scheduling policy.
+     *   This should be the priority of the thread handling the primary socket,
+     *   since the pooled workers are not necessarily spawned from that thread.
+     */
+    AdHocWorkerPool(
+        std::function<void(boost::asio::local::stream_protocol::socket&)>
+            callback,
+        std::optional<int> realtime_priority)
+        : callback(std::move(callback)),
+          realtime_priority(realtime_priority) {}
+
+    /**
+     * Shuts down all sockets and joins all worker threads.
+     */
+    ~AdHocWorkerPool() noexcept { shutdown(); }
+
+    AdHocWorkerPool(const AdHocWorkerPool&) = delete;
+    AdHocWorkerPool& operator=(const AdHocWorkerPool&) = delete;
+
+    /**
+     * Hand a newly accepted secondary socket connection to an idle worker, or
+     * spawn a new worker if all workers are currently busy. Workers that have
+     * exited since the last call will be joined here.
+     */
+    void submit(boost::asio::local::stream_protocol::socket secondary_socket) {
+        std::lock_guard lock(workers_mutex);
+        if (is_shutting_down) {
+            return;
+        }
+
+        // The join is implicit because we're using `std::jthread`/`Win32Thread`
+        for (const size_t worker_id : finished_workers) {
+            workers.erase(worker_id);
+        }
+        finished_workers.clear();
+
+        pending_sockets.push_back(
+            std::make_shared<boost::asio::local::stream_protocol::socket>(
+                std::move(secondary_socket)));
+        if (pending_sockets.size() <= num_idle_workers) {
+            has_pending_sockets_cv.notify_one();
+        } else {
+            const size_t worker_id = next_worker_id++;
+            workers[worker_id] =
+                Thread([this, worker_id]() { run_worker(worker_id); });
+        }
+    }
+
+    /**
+     * Shut down all sockets the workers are currently serving, and join all
+     * worker threads. Connections submitted after this point will be closed
+     * immediately.
+     */
+    void shutdown() noexcept {
+        std::unordered_map<size_t, Thread> stopped_workers;
+        {
+            std::lock_guard lock(workers_mutex);
+            is_shutting_down = true;
+
+            // The workers would otherwise keep blocking on a read
+            for (const auto& active_socket : active_sockets) {
+                boost::system::error_code err;
+                active_socket->shutdown(
+                    boost::asio::local::stream_protocol::socket::shutdown_both,
+                    err);
+            }
+            pending_sockets.clear();
+
+            has_pending_sockets_cv.notify_all();
+            stopped_workers = std::move(workers);
+            workers.clear();
+        }
+
+        // The workers need to reacquire the lock before they can exit, so we
+        // can only join them after releasing it
+        stopped_workers.clear();
+    }
+
+   private:
+    /**
+     * The loop run by every worker thread. Serves connections from
+     * `pending_sockets` until the pool gets shut down, or until the worker has
+     * been idle for `ad_hoc_worker_idle_timeout` while there are enough other
+     * idle workers.
+     */
+    void run_worker(size_t worker_id) {
+        pthread_setname_np(pthread_self(), "adhoc-worker");
+        set_realtime_priority(realtime_priority.has_value(),
+                              realtime_priority.value_or(0));
+
+        std::unique_lock lock(workers_mutex);
+        while (true) {
+            num_idle_workers++;
+            const bool has_pending_socket = has_pending_sockets_cv.wait_for(
+                lock, ad_hoc_worker_idle_timeout, [&]() {
+                    return is_shutting_down || !pending_sockets.empty();
+                });
+            num_idle_workers--;
+
+            if (is_shutting_down) {
+                break;
+            }
+            if (!has_pending_socket) {
+                if (num_idle_workers >= max_idle_ad_hoc_workers) {
+                    break;
+                } else {
+                    continue;
+                }
+            }
+
+            std::shared_ptr<boost::asio::local::stream_protocol::socket>
+                secondary_socket = std::move(pending_sockets.front());
+            pending_sockets.pop_front();
+            active_sockets.insert(secondary_socket);
+            lock.unlock();
+
+            while (true) {
+                try {
+                    callback(*secondary_socket);
+                } catch (const boost::system::system_error&) {
+                    // The sending side closes idle secondary sockets after a
+                    // timeout, and all sockets will be shut down when the
+                    // plugin exits
+                    break;
+                }
+            }
+
+            lock.lock();
+            active_sockets.erase(secondary_socket);
+        }
+
+        // If we're not shutting down, then the next call to `submit()` will
+        // join this thread
+        if (!is_shutting_down) {
+            finished_workers.push_back(worker_id);
+        }
+    }
+
+    std::function<void(boost::asio::local::stream_protocol::socket&)>
+        callback;
+    std::optional<int> realtime_priority;
+
+    /**
+     * This works the exact same was as `active_plugins` and `next_plugin_id`
+     * in `GroupBridge`. All fields below are guarded by `workers_mutex`.
+     */
+    std::unordered_map<size_t, Thread> workers;
+    size_t next_worker_id = 0;
+    std::mutex workers_mutex;
+
+    /**
+     * Workers that have exited because they were idle for too long. These will
+     * be joined in the next call to `submit()`.
+     */
+    std::vector<size_t> finished_workers;
+    /**
+     * Accepted connections that have not yet been picked up by a worker.
+     */
+    std::deque<std::shared_ptr<boost::asio::local::stream_protocol::socket>>
+        pending_sockets;
+    std::condition_variable has_pending_sockets_cv;
+    size_t num_idle_workers = 0;
+    /**
+     * The connections that are currently being served, so they can be shut
+     * down in `shutdown()`.
+     */
+    std::unordered_set<
+        std::shared_ptr<boost::asio::local::stream_protocol::socket>>
+        active_sockets;
+    bool is_shutting_down = false;
+};
+
 /**
  * There are situations where we can not know in advance how many sockets we
  * need. The main example of this are VST2 `dispatcher()` and `audioMaster()`
@@ -547,8 +925,15 @@ class SocketHandler {
  *   send data and the primary socket is in use, it will instantiate a new
  *   connection to same socket endpoint and it will send the data over that
  *   socket instead. On the listening side the new connection will be accepted,
- *   and a newly spawned thread will handle incoming connection just like it
- *   would for the primary socket.
+ *   and a thread from an `AdHocWorkerPool` will handle incoming connection
+ *   just like it would for the primary socket.
+ * - Those secondary sockets are not closed after a single request. Instead
+ *   the sending side keeps a small pool of idle secondary sockets that will be
+ *   reused for the next request that can't use the primary socket, and the
+ *   thread on the listening side keeps reading from its socket until the
+ *   sending side closes it. Idle sockets get closed again after
+ *   `secondary_socket_idle_timeout`, so the pool only grows when a host
+ *   actually makes a lot of concurrent calls.
  *
  * @tparam Thread The thread implementation to use. On the Linux side this
  *   should be `std::jthread` and on the Wine side this should be `Win32Thread`.
@@ -613,6 +998,12 @@ class AdHocSocketHandler {
             boost::asio::local::stream_protocol::socket::shutdown_both, err);
         socket.close();
 
+        {
+            std::lock_guard lock(idle_secondary_sockets_mutex);
+            idle_secondary_sockets.clear();
+            num_idle_secondary_sockets = 0;
+        }
+
         while (currently_listening) {
             // If another thread is currently calling `receive_multi()`, we'll
             // spinlock until that function has exited. We would otherwise get a
@@ -620,6 +1011,18 @@ class AdHocSocketHandler {
         }
     }
 
+    /**
+     * Get the number of requests that were sent over the primary socket, over
+     * a pooled secondary socket, and the number of new secondary socket
+     * connections we had to make.
+     */
+    AdHocSocketStatistics statistics() const noexcept {
+        return AdHocSocketStatistics{
+            .num_primary_requests = num_primary_requests.load(),
+            .num_pooled_requests = num_pooled_requests.load(),
+            .num_new_connections = num_new_connections.load()};
+    }
+
    protected:
     /**
      * Serialize and send an event over a socket. This is used for both the host
@@ -645,12 +1048,11 @@ class AdHocSocketHandler {
         constexpr bool returns_void = std::is_void_v<std::invoke_result_t<
             F, boost::asio::local::stream_protocol::socket&>>;
 
-        // XXX: Maybe at some point we should benchmark how often this
-        //      ad hoc socket spawning mechanism gets used. If some hosts
-        //      for instance consistently and repeatedly trigger this then
-        //      we might be able to do some optimizations there.
         std::unique_lock lock(write_mutex, std::try_to_lock);
         if (lock.owns_lock()) {
+            num_primary_requests.fetch_add(1, std::memory_order_relaxed);
+            prune_idle_secondary_sockets();
+
             // This was used to always block when sending the first message,
             // because the other side may not be listening for additional
             // connections yet
@@ -664,43 +1066,65 @@ class AdHocSocketHandler {
                 return result;
             }
         } else {
-            try {
-                boost::asio::local::stream_protocol::socket secondary_socket(
-                    io_context);
-                secondary_socket.connect(endpoint);
-
-                return callback(secondary_socket);
-            } catch (const boost::system::system_error& e) {
-                // So, what do we do when noone is listening on the endpoint
-                // yet? This can happen with plugin groups when the Wine
-                // host process does an `audioMaster()` call before the
-                // plugin is listening. If that happens we'll fall back to a
-                // synchronous request. This is not very pretty, so if
-                // anyone can think of a better way to structure all of this
-                // while still mainting a long living primary socket please
-                // let me know.
-                // Note that this should **only** be done before the call to
-                // `connect()`. If we get here at any other point then it
-                // means that the plugin side is no longer listening on the
-                // sockets, and we should thus just exit.
-                if (!sent_first_event) {
-                    std::lock_guard lock(write_mutex);
-
-                    if constexpr (returns_void) {
-                        callback(socket);
-                        sent_first_event = true;
+            std::optional<boost::asio::local::stream_protocol::socket>
+                secondary_socket = acquire_idle_secondary_socket();
+            if (secondary_socket) {
+                num_pooled_requests.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                try {
+                    secondary_socket.emplace(io_context);
+                    secondary_socket->connect(endpoint);
+                    num_new_connections.fetch_add(1,
+                                                  std::memory_order_relaxed);
+                } catch (const boost::system::system_error& e) {
+                    // So, what do we do when noone is listening on the endpoint
+                    // yet? This can happen with plugin groups when the Wine
+                    // host process does an `audioMaster()` call before the
+                    // plugin is listening. If that happens we'll fall back to a
+                    // synchronous request. This is not very pretty, so if
+                    // anyone can think of a better way to structure all of this
+                    // while still mainting a long living primary socket please
+                    // let me know.
+                    // Note that this should **only** be done before the call to
+                    // `connect()`. If we get here at any other point then it
+                    // means that the plugin side is no longer listening on the
+                    // sockets, and we should thus just exit.
+                    if (!sent_first_event) {
+                        std::lock_guard lock(write_mutex);
+                        num_primary_requests.fetch_add(
+                            1, std::memory_order_relaxed);
+
+                        if constexpr (returns_void) {
+                            callback(socket);
+                            sent_first_event = true;
+
+                            return;
+                        } else {
+                            auto result = callback(socket);
+                            sent_first_event = true;
+
+                            return result;
+                        }
                     } else {
-                        auto result = callback(socket);
-                        sent_first_event = true;
-
-                        return result;
+                        // Rethrow the exception if the sockets we're not
+                        // handling the specific case described above
+                        throw e;
                     }
-                } else {
-                    // Rethrow the exception if the sockets we're not
-                    // handling the specific case described above
-                    throw e;
                 }
             }
+
+            // If the callback throws then the socket will be in an undefined
+            // state, so we'll only return it to the pool after a successful
+            // request
+            if constexpr (returns_void) {
+                callback(*secondary_socket);
+                release_idle_secondary_socket(std::move(*secondary_socket));
+            } else {
+                auto result = callback(*secondary_socket);
+                release_idle_secondary_socket(std::move(*secondary_socket));
+
+                return result;
+            }
         }
     }
 
@@ -714,10 +1138,12 @@ class AdHocSocketHandler {
      * @param primary_callback A function that will do a single read cycle for
      *   the primary socket socket that should do a single read cycle. This is
      *   called in a loop so it shouldn't do any looping itself.
-     * @param secondary_callback A function that will be called when we receive
-     *   an incoming connection on a secondary socket. This would often do the
-     *   same thing as `primary_callback`, but secondary sockets may need some
-     *   different handling.
+     * @param secondary_callback A function that will do a single read cycle
+     *   for a secondary socket. This is called in a loop on a dedicated thread
+     *   for every incoming secondary socket connection until the other side
+     *   closes that socket. This would often do the same thing as
+     *   `primary_callback`, but secondary sockets may need some different
+     *   handling.
      */
     template <std::invocable<boost::asio::local::stream_protocol::socket&> F,
               std::invocable<boost::asio::local::stream_protocol::socket&> G>
@@ -732,47 +1158,24 @@ class AdHocSocketHandler {
 
         // As described above we'll handle incoming requests for `socket` on
         // this thread. We'll also listen for incoming connections on `endpoint`
-        // on another thread. For any incoming connection we'll spawn a new
-        // thread to handle the request. When `socket` closes and this loop
-        // breaks, the listener and any still active threads will be cleaned up
-        // before this function exits.
+        // on another thread. Every incoming connection will be handed to a
+        // worker from `worker_pool`. When `socket` closes and this loop breaks,
+        // the listener and all workers will be cleaned up before this function
+        // exits.
         boost::asio::io_context secondary_context{};
 
         // The previous acceptor has already been shut down by
         // `AdHocSocketHandler::connect()`
         acceptor.emplace(secondary_context, endpoint);
 
-        // This works the exact same was as `active_plugins` and
-        // `next_plugin_id` in `GroupBridge`
-        std::unordered_map<size_t, Thread> active_secondary_requests{};
-        std::atomic_size_t next_request_id{};
-        std::mutex active_secondary_requests_mutex{};
+        // The workers should run with the same scheduling policy as the thread
+        // that handles the primary socket
+        AdHocWorkerPool<Thread> worker_pool(std::ref(secondary_callback),
+                                            get_realtime_priority());
         accept_requests(
             *acceptor, logger,
             [&](boost::asio::local::stream_protocol::socket secondary_socket) {
-                const size_t request_id = next_request_id.fetch_add(1);
-
-                // We have to make sure to keep moving these sockets into the
-                // threads that will handle them
-                std::lock_guard lock(active_secondary_requests_mutex);
-                active_secondary_requests[request_id] = Thread(
-                    [&, request_id](boost::asio::local::stream_protocol::socket
-                                        secondary_socket) {
-                        secondary_callback(secondary_socket);
-
-                        // When we have processed this request, we'll join the
-                        // thread again with the thread that's handling
-                        // `secondary_context`
-                        boost::asio::post(secondary_context, [&, request_id]() {
-                            std::lock_guard lock(
-                                active_secondary_requests_mutex);
-
-                            // The join is implicit because we're using
-                            // `std::jthread`/`Win32Thread`
-                            active_secondary_requests.erase(request_id);
-                        });
-                    },
-                    std::move(secondary_socket));
+                worker_pool.submit(std::move(secondary_socket));
             });
 
         Thread secondary_requests_handler([&]() {
@@ -793,12 +1196,12 @@ class AdHocSocketHandler {
             }
         }
 
-        // After the primary socket gets terminated (during shutdown) we'll make
-        // sure all outstanding jobs have been processed and then drop all work
-        // from the IO context
-        std::lock_guard lock(active_secondary_requests_mutex);
+        // After the primary socket gets terminated (during shutdown) we'll
+        // drop all work from the IO context and then wait for the workers to
+        // exit
         secondary_context.stop();
         acceptor.reset();
+        worker_pool.shutdown();
 
         currently_listening = false;
     }
@@ -816,6 +1219,95 @@ class AdHocSocketHandler {
     }
 
    private:
+    /**
+     * An idle secondary socket in the pool, along with the last time it was
+     * used.
+     */
+    struct IdleSecondarySocket {
+        boost::asio::local::stream_protocol::socket socket;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+    /**
+     * Take the most recently used idle secondary socket from the pool, if
+     * there is one. Sockets that have been idle for longer than
+     * `secondary_socket_idle_timeout` will be closed instead.
+     */
+    std::optional<boost::asio::local::stream_protocol::socket>
+    acquire_idle_secondary_socket() {
+        if (num_idle_secondary_sockets.load(std::memory_order_relaxed) == 0) {
+            return std::nullopt;
+        }
+
+        std::lock_guard lock(idle_secondary_sockets_mutex);
+        prune_idle_secondary_sockets_locked();
+        if (idle_secondary_sockets.empty()) {
+            return std::nullopt;
+        }
+
+        boost::asio::local::stream_protocol::socket secondary_socket =
+            std::move(idle_secondary_sockets.back().socket);
+        idle_secondary_sockets.pop_back();
+        num_idle_secondary_sockets = idle_secondary_sockets.size();
+
+        return secondary_socket;
+    }
+
+    /**
+     * Return a secondary socket to the pool after it has been used. If the pool
+     * is already full, then the least recently used socket will be closed.
+     */
+    void release_idle_secondary_socket(
+        boost::asio::local::stream_protocol::socket secondary_socket) {
+        std::lock_guard lock(idle_secondary_sockets_mutex);
+        idle_secondary_sockets.push_back(IdleSecondarySocket{
+            .socket = std::move(secondary_socket),
+            .last_used = std::chrono::steady_clock::now()});
+        if (idle_secondary_sockets.size() > max_idle_secondary_sockets) {
+            idle_secondary_sockets.erase(idle_secondary_sockets.begin());
+        }
+
+        prune_idle_secondary_sockets_locked();
+    }
+
+    /**
+     * Close the idle secondary sockets that have timed out. This is called when
+     * sending over the primary socket so the pool can shrink again after a host
+     * stops making concurrent calls. We won't wait for the lock if another
+     * thread is currently using the pool.
+     */
+    void prune_idle_secondary_sockets() {
+        if (num_idle_secondary_sockets.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+
+        std::unique_lock lock(idle_secondary_sockets_mutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            prune_idle_secondary_sockets_locked();
+        }
+    }
+
+    /**
+     * The actual pruning for `prune_idle_secondary_sockets()`. The caller
+     * should hold a lock on `idle_secondary_sockets_mutex`. Since the pool is
+     * ordered from least to most recently used, we only need to look at the
+     * front of the vector. Dropping a socket closes the connection, which in
+     * turn causes the worker thread on the receiving side to exit.
+     */
+    void prune_idle_secondary_sockets_locked() {
+        const auto cutoff =
+            std::chrono::steady_clock::now() - secondary_socket_idle_timeout;
+        const auto first_active = std::find_if(
+            idle_secondary_sockets.begin(), idle_secondary_sockets.end(),
+            [&](const IdleSecondarySocket& idle_socket) {
+                return idle_socket.last_used >= cutoff;
+            });
+        idle_secondary_sockets.erase(idle_secondary_sockets.begin(),
+                                     first_active);
+
+        num_idle_secondary_sockets = idle_secondary_sockets.size();
+    }
+
     /**
      * Used in `receive_multi()` to asynchronously listen for secondary socket
      * connections. After `callback()` returns this function will continue to be
@@ -901,4 +1393,25 @@ class AdHocSocketHandler {
      * this fallback behaviour should only happen during initialization.
      */
     std::atomic_bool sent_first_event = false;
+
+    /**
+     * Secondary sockets that are currently not in use, ordered from least to
+     * most recently used. When the primary socket is busy, `send()` will first
+     * try to reuse one of these before connecting a new socket. The other side
+     * will have a worker thread waiting for requests on each of these sockets.
+     */
+    std::vector<IdleSecondarySocket> idle_secondary_sockets;
+    std::mutex idle_secondary_sockets_mutex;
+    /**
+     * The size of `idle_secondary_sockets`, so we don't have to touch the mutex
+     * on the primary socket's path when the pool is empty.
+     */
+    std::atomic_size_t num_idle_secondary_sockets = 0;
+
+    /**
+     * Counters for `statistics()`.
+     */
+    std::atomic_uint64_t num_primary_requests = 0;
+    std::atomic_uint64_t num_pooled_requests = 0;
+    std::atomic_uint64_t num_new_connections = 0;
 };
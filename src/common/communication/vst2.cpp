@@ -72,10 +72,20 @@ intptr_t DefaultDataConverter::return_value(const int /*opcode*/,
     return original;
 }
 
+bool DefaultDataConverter::is_one_way(const int /*opcode*/) const {
+    return false;
+}
+
 Vst2EventResult DefaultDataConverter::send_event(
     boost::asio::local::stream_protocol::socket& socket,
     const Vst2Event& event,
     SerializationBufferBase& buffer) const {
     write_object(socket, event, buffer);
+    if (event.one_way) {
+        return Vst2EventResult{.return_value = 0,
+                               .payload = nullptr,
+                               .value_payload = std::nullopt};
+    }
+
     return read_object<Vst2EventResult>(socket, buffer);
 }
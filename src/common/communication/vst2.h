@@ -79,6 +79,17 @@ class DefaultDataConverter {
     virtual intptr_t return_value(const int opcode,
                                   const intptr_t original) const;
 
+    /**
+     * Whether an event with this opcode should be sent as a one-way event. The
+     * sending side won't wait for those events to be handled, and the caller
+     * will always receive a return value of 0. This should only be enabled for
+     * pure notifications where the return value is meaningless, and where the
+     * receiving side doesn't need to call back into the sending thread. Events
+     * sent over the same socket are still handled in order. The default
+     * implementation returns `false` for every opcode.
+     */
+    virtual bool is_one_way(const int opcode) const;
+
     /**
      * Send an event over the socket. The default implementation will just send
      * the event over the socket, and then wait for the response to be sent
@@ -195,7 +206,8 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
                               .value = value,
                               .option = option,
                               .payload = std::move(payload),
-                              .value_payload = std::move(value_payload)};
+                              .value_payload = std::move(value_payload),
+                              .one_way = data_converter.is_one_way(opcode)};
 
         // A socket only handles a single request at a time as to prevent
         // messages from arriving out of order. `AdHocSocketHandler::send()`
@@ -211,7 +223,7 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
                                                  serialization_buffer());
             });
 
-        if (logging) {
+        if (logging && !event.one_way) {
             auto [logger, is_dispatch] = *logging;
             logger.log_event_response(is_dispatch, opcode,
                                       response.return_value, response.payload,
@@ -261,7 +273,14 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
                                      event.value_payload);
                 }
 
+                // The other side is not waiting for a response to one-way
+                // events, but we still need to fully handle them before
+                // reading the next event to keep everything in order
                 Vst2EventResult response = callback(event, on_main_thread);
+                if (event.one_way) {
+                    return;
+                }
+
                 if (logging) {
                     auto [logger, is_dispatch] = *logging;
                     logger.log_event_response(
@@ -137,15 +137,21 @@ class Vst3MessageHandler : public AdHocSocketHandler<Thread> {
         // A socket only handles a single request at a time as to prevent
         // messages from arriving out of order. `AdHocSocketHandler::send()`
         // will either use a long-living primary socket, or if that's currently
-        // in use it will spawn a new socket for us.
+        // in use it will spawn a new socket for us. One-way requests don't get
+        // a response, but since the other side will handle them before reading
+        // the next request from this socket they still stay in order.
         this->send([&](boost::asio::local::stream_protocol::socket& socket) {
             write_object(socket, Request(object), buffer);
-            read_object<TResponse>(socket, response_object, buffer);
+            if constexpr (!std::is_same_v<TResponse, OneWay>) {
+                read_object<TResponse>(socket, response_object, buffer);
+            }
         });
 
-        if (should_log_response) {
-            auto [logger, is_host_vst] = *logging;
-            logger.log_response(!is_host_vst, response_object);
+        if constexpr (!std::is_same_v<TResponse, OneWay>) {
+            if (should_log_response) {
+                auto [logger, is_host_vst] = *logging;
+                logger.log_response(!is_host_vst, response_object);
+            }
         }
 
         return response_object;
@@ -249,15 +255,21 @@ class Vst3MessageHandler : public AdHocSocketHandler<Thread> {
                     [&]<typename T>(T object) {
                         typename T::Response response = callback(object);
 
-                        if (should_log_response) {
-                            auto [logger, is_host_vst] = *logging;
-                            logger.log_response(!is_host_vst, response);
-                        }
-
-                        if constexpr (persistent_buffers) {
-                            write_object(socket, response, persistent_buffer);
-                        } else {
-                            write_object(socket, response);
+                        // The other side is not waiting for a response to
+                        // one-way requests
+                        if constexpr (!std::is_same_v<typename T::Response,
+                                                      OneWay>) {
+                            if (should_log_response) {
+                                auto [logger, is_host_vst] = *logging;
+                                logger.log_response(!is_host_vst, response);
+                            }
+
+                            if constexpr (persistent_buffers) {
+                                write_object(socket, response,
+                                             persistent_buffer);
+                            } else {
+                                write_object(socket, response);
+                            }
                         }
                     },
                     // See above
@@ -459,6 +471,19 @@ class Vst3Sockets final : public Sockets {
             object_ref, response_object, object_ref.get().instance_id, logging);
     }
 
+    /**
+     * Alternative to `send_audio_processor_message()` where we deserialize
+     * into an existing object.
+     */
+    template <typename T>
+    typename T::Response& receive_audio_processor_message_into(
+        const T& object,
+        typename T::Response& response_object,
+        std::optional<std::pair<Vst3Logger&, bool>> logging) {
+        return receive_audio_processor_message_into(
+            object, response_object, object.instance_id, logging);
+    }
+
     /**
      * Alternative to `send_audio_processor_message()` for use with
      * `MessageReference<T>`, where we also want deserialize into an existing
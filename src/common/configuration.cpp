@@ -86,6 +86,107 @@ Configuration::Configuration(const fs::path& config_path,
                 } else {
                     invalid_options.push_back(key);
                 }
+            } else if (key == "audio_futex_handshake") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    audio_futex_handshake = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "audio_pipelining") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    audio_pipelining = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "audio_spin_wait") {
+                // This option can be enabled with a boolean to use the default
+                // limit, or it can be set to a number of microseconds
+                if (const auto parsed_value = value.as_boolean()) {
+                    if (*parsed_value) {
+                        audio_spin_wait = default_audio_spin_wait_us;
+                    } else {
+                        audio_spin_wait = std::nullopt;
+                    }
+                } else if (const auto parsed_value = value.as_integer();
+                           parsed_value && parsed_value->get() >= 0 &&
+                           parsed_value->get() <= UINT32_MAX) {
+                    audio_spin_wait =
+                        static_cast<uint32_t>(parsed_value->get());
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "audio_silence_gating") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    audio_silence_gating = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "audio_page_aligned_channels") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    audio_page_aligned_channels = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "audio_huge_pages") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    audio_huge_pages = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "audio_realtime_memory") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    audio_realtime_memory = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "audio_memfd") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    audio_memfd = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "audio_double_precision_adapter") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    audio_double_precision_adapter = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "audio_thread_affinity") {
+                // This option can be set to either follow the host's audio
+                // thread, or to a list of cores to pin the audio threads to
+                if (const auto parsed_value = value.as_string()) {
+                    if (parsed_value->get() == "none") {
+                        audio_thread_affinity = AudioThreadAffinity::none;
+                    } else if (parsed_value->get() == "host") {
+                        audio_thread_affinity = AudioThreadAffinity::host;
+                    } else if (parsed_value->get() == "same_core") {
+                        audio_thread_affinity = AudioThreadAffinity::same_core;
+                    } else {
+                        invalid_options.push_back(key);
+                    }
+                } else if (const auto parsed_value = value.as_array();
+                           parsed_value && !parsed_value->empty()) {
+                    std::vector<uint32_t> cores;
+                    for (const auto& core : *parsed_value) {
+                        if (const auto parsed_core = core.as_integer();
+                            parsed_core && parsed_core->get() >= 0 &&
+                            parsed_core->get() < CpuSet::capacity) {
+                            cores.push_back(
+                                static_cast<uint32_t>(parsed_core->get()));
+                        } else {
+                            break;
+                        }
+                    }
+
+                    if (cores.size() == parsed_value->size()) {
+                        audio_thread_affinity = AudioThreadAffinity::cores;
+                        audio_thread_cores = std::move(cores);
+                    } else {
+                        invalid_options.push_back(key);
+                    }
+                } else {
+                    invalid_options.push_back(key);
+                }
             } else if (key == "disable_pipes") {
                 // This option can be either enabled or disable with a boolean,
                 // or it can be set to an absolute path
@@ -136,6 +237,24 @@ Configuration::Configuration(const fs::path& config_path,
                 } else {
                     invalid_options.push_back(key);
                 }
+            } else if (key == "parameter_mirror") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    parameter_mirror = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "parameter_queue") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    parameter_queue = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
+            } else if (key == "vst3_coalesce_edits") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    vst3_coalesce_edits = parsed_value->get();
+                } else {
+                    invalid_options.push_back(key);
+                }
             } else if (key == "vst3_no_scaling") {
                 if (const auto parsed_value = value.as_boolean()) {
                     vst3_no_scaling = parsed_value->get();
@@ -153,6 +272,16 @@ Configuration::Configuration(const fs::path& config_path,
             }
         }
 
+        // When the Wine plugin host's audio thread is pinned to the same core
+        // as the host's audio thread, spinning on that thread would only keep
+        // the host's audio thread from running. We'll ignore the spin wait
+        // option in that case and print a warning.
+        if (audio_thread_affinity == AudioThreadAffinity::same_core &&
+            audio_spin_wait) {
+            audio_spin_wait.reset();
+            invalid_options.push_back("audio_spin_wait");
+        }
+
         break;
     }
 }
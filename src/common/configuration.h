@@ -22,10 +22,45 @@
 #include <boost/filesystem.hpp>
 
 #include <chrono>
+#include <cstdint>
 #include <optional>
 
 #include "bitsery/ext/boost-path.h"
 #include "bitsery/ext/in-place-optional.h"
+#include "utils.h"
+
+/**
+ * The spin wait limit in microseconds used when the `audio_spin_wait` option is
+ * set to `true`. This is about a tenth of the processing period at 48 kHz with
+ * a buffer size of 128 samples.
+ */
+constexpr uint32_t default_audio_spin_wait_us = 250;
+
+/**
+ * How the CPU affinity of the Wine plugin host's audio threads should be
+ * managed. This is set through the `audio_thread_affinity` option.
+ */
+enum class AudioThreadAffinity : uint8_t {
+    /**
+     * Leave the audio threads' affinity up to the scheduler. This is the
+     * default.
+     */
+    none,
+    /**
+     * Periodically copy the affinity mask of the host's audio thread.
+     */
+    host,
+    /**
+     * Pin the audio thread to the core the host's audio thread is currently
+     * running on, so both threads share the same caches.
+     */
+    same_core,
+    /**
+     * Pin the audio threads to the cores in
+     * `Configuration::audio_thread_cores`.
+     */
+    cores,
+};
 
 /**
  * An object that's used to provide plugin-specific configuration. Right now
@@ -81,6 +116,135 @@ class Configuration {
      */
     std::optional<std::string> group;
 
+    /**
+     * If enabled, the native plugin and the Wine plugin host will use a futex
+     * based handshake on a control block in the shared audio buffers to
+     * exchange audio processing requests and responses instead of sending
+     * messages over a socket. This reduces the per-cycle overhead for very
+     * small buffer sizes, at the cost of one additional thread on the Wine
+     * side per plugin instance.
+     *
+     * @see AudioShmBuffer
+     */
+    bool audio_futex_handshake = false;
+
+    /**
+     * If enabled, VST2 plugins will process audio one block behind the host.
+     * The native plugin will hand the current block of audio to the Wine
+     * plugin host and then immediately return the outputs from the previous
+     * block instead of waiting for the Wine plugin host to finish processing.
+     * This lets the Windows plugin process audio in parallel with the rest of
+     * the host's processing graph, and the additional block of latency gets
+     * added to the latency reported by the plugin when it gets resumed. This
+     * is not implemented for VST3 plugins, since those would need to report
+     * the additional latency through `IAudioProcessor::getLatencySamples()`.
+     */
+    bool audio_pipelining = false;
+
+    /**
+     * The maximum number of microseconds the Wine plugin host's audio thread
+     * may spin for while waiting for the next processing request before
+     * blocking. This only has an effect when `audio_futex_handshake` is also
+     * enabled. The actual spin window is tuned automatically based on the time
+     * between processing cycles. Setting this option to `true` uses
+     * `default_audio_spin_wait_us`. This is reset when `audio_thread_affinity`
+     * is set to `AudioThreadAffinity::same_core`, since both threads would
+     * then be competing for the same core.
+     *
+     * @see AudioShmBuffer::set_spin_wait_limit
+     */
+    std::optional<uint32_t> audio_spin_wait;
+
+    /**
+     * If enabled, the native plugin will skip the round trip to the Wine plugin
+     * host entirely and output silence when an effect has been receiving
+     * silent input for longer than its reported tail length. Any input audio,
+     * parameter change, or MIDI event will cause the plugin to process audio
+     * again.
+     *
+     * @see SilenceGate
+     */
+    bool audio_silence_gating = false;
+
+    /**
+     * If enabled, every audio channel in the shared memory audio buffers will
+     * start on its own page instead of only being aligned to a cache line.
+     *
+     * @see AudioShmBuffer::align_offset
+     */
+    bool audio_page_aligned_channels = false;
+
+    /**
+     * If enabled, the shared memory audio buffers will be rounded up to a
+     * multiple of the huge page size and the kernel will be asked to back them
+     * with transparent huge pages. This can reduce TLB pressure for plugins
+     * with many audio channels.
+     *
+     * @see AudioShmBuffer::Config::huge_pages
+     */
+    bool audio_huge_pages = false;
+
+    /**
+     * If enabled, the shared memory audio buffers and the stacks of the Wine
+     * plugin host's audio threads will be explicitly pre-faulted and locked
+     * into RAM, and the result will be verified and logged on both sides.
+     * Without this option the buffers are only mapped with `MAP_LOCKED`, which
+     * silently does nothing when `RLIMIT_MEMLOCK` is too low. The buffers used
+     * to serialize messages and the request and response objects that are
+     * reused between processing cycles are not locked.
+     *
+     * @see lock_memory
+     */
+    bool audio_realtime_memory = false;
+
+    /**
+     * If enabled, the shared memory audio buffers will be backed by an
+     * anonymous memfd that's passed to the native plugin over a socket instead
+     * of by a named shared memory object in `/dev/shm`. These buffers can't
+     * leak when the host or the Wine plugin host crashes, and they can be
+     * resized without having to remap them from scratch. This takes precedence
+     * over the shared buffer arena used for plugin groups.
+     *
+     * @see AudioShmBuffer::Config::memfd
+     */
+    bool audio_memfd = false;
+
+    /**
+     * If enabled, plugins that only support single precision audio will also
+     * advertise support for double precision audio to the host. For VST2
+     * plugins this sets `effFlagsCanDoubleReplacing`, and for VST3 plugins
+     * `IAudioProcessor::canProcessSampleSize(kSample64)` will return
+     * `kResultTrue`. The native plugin then converts the host's double
+     * precision audio to and from single precision audio while copying it to
+     * and from the shared memory audio buffers, and the Windows plugin still
+     * processes single precision audio. This lets hosts that process
+     * everything in double precision skip their own conversion for these
+     * plugins, and it halves the size of the shared memory audio buffers
+     * compared to plugins that support double precision audio.
+     *
+     * @see AudioShmBuffer::Config::double_precision
+     */
+    bool audio_double_precision_adapter = false;
+
+    /**
+     * Controls the CPU affinity of the Wine plugin host's audio threads. By
+     * default the scheduler is free to run those threads on any core, which
+     * means that the Wine plugin host's audio thread may wake up on a
+     * different core than the one the host's audio thread just wrote the
+     * audio buffers from. This can be set to follow the host's audio thread's
+     * affinity mask or the core it's running on, or to pin the audio threads
+     * to a fixed list of (isolated) cores.
+     *
+     * @see AudioThreadAffinitySync
+     */
+    AudioThreadAffinity audio_thread_affinity = AudioThreadAffinity::none;
+
+    /**
+     * The cores the Wine plugin host's audio threads should be pinned to when
+     * `audio_thread_affinity` is set to `AudioThreadAffinity::cores`.
+     */
+    std::vector<uint32_t> audio_thread_cores;
+
     /**
      * If enabled, we'll redirect the plugin's STDOUT and STDERR streams to this
      * file instead of using pipes to intersperse it with yabridge's other
@@ -146,6 +310,53 @@ class Configuration {
      */
     bool hide_daw = false;
 
+    /**
+     * If enabled, the Wine plugin host will keep a copy of a VST2 plugin's
+     * parameter values in a shared memory table, and `getParameter()` calls
+     * from the host will read from that table instead of requiring a round
+     * trip to the Wine plugin host. Values the Wine plugin host doesn't know
+     * yet are still queried from the plugin directly. For VST3 plugins the
+     * native plugin keeps a table of parameter values itself based on the
+     * parameter changes it sees passing through, and
+     * `IEditController::getParamNormalized()` calls are then served from that
+     * table. This is disabled again for plugin instances that turn out to
+     * change their parameters without notifying the host.
+     *
+     * To catch VST2 parameter changes the plugin didn't report, the Wine plugin
+     * host calls `getParameter()` for `parameter_mirror_refresh_batch_size`
+     * parameters on every event loop tick. This happens on the GUI thread, so
+     * it doesn't add any work to the audio thread.
+     *
+     * @see ParameterMirror
+     * @see ParameterValueMirror
+     */
+    bool parameter_mirror = false;
+
+    /**
+     * If enabled, `setParameter()` calls made by the host from the audio thread
+     * are queued and sent to the Wine plugin host along with the next
+     * processing request instead of each requiring a round trip. The Wine
+     * plugin host applies them in order right before processing audio. Calls
+     * from other threads flush the queue first and are still sent
+     * immediately. This only affects VST2 plugins.
+     *
+     * @see ParameterQueue
+     */
+    bool parameter_queue = false;
+
+    /**
+     * If enabled, `IComponentHandler::beginEdit()`, `performEdit()` and
+     * `endEdit()` calls made by a VST3 plugin are buffered on the Wine side and
+     * sent to the native plugin as a single message at the end of the event
+     * loop cycle they were made in. Consecutive `performEdit()` calls for the
+     * same parameter within a gesture are collapsed into the last value. Any
+     * other component handler callback sends the buffered edits first, so the
+     * host still sees all calls in order.
+     *
+     * @see Vst3ComponentHandlerProxyImpl::flush_parameter_edits
+     */
+    bool vst3_coalesce_edits = false;
+
     /**
      * Disable `IPlugViewContentScaleSupport::setContentScaleFactor()`. Wine
      * does not properly implement fractional DPI scaling, so without this
@@ -200,6 +411,18 @@ class Configuration {
         s.ext(group, bitsery::ext::InPlaceOptional(),
               [](S& s, auto& v) { s.text1b(v, 4096); });
 
+        s.value1b(audio_futex_handshake);
+        s.value1b(audio_pipelining);
+        s.ext(audio_spin_wait, bitsery::ext::InPlaceOptional(),
+              [](S& s, auto& v) { s.value4b(v); });
+        s.value1b(audio_silence_gating);
+        s.value1b(audio_page_aligned_channels);
+        s.value1b(audio_huge_pages);
+        s.value1b(audio_realtime_memory);
+        s.value1b(audio_memfd);
+        s.value1b(audio_double_precision_adapter);
+        s.value1b(audio_thread_affinity);
+        s.container4b(audio_thread_cores, CpuSet::capacity);
         s.ext(disable_pipes, bitsery::ext::InPlaceOptional(),
               [](S& s, auto& v) { s.ext(v, bitsery::ext::BoostPath{}); });
         s.value1b(editor_double_embed);
@@ -208,6 +431,9 @@ class Configuration {
         s.ext(frame_rate, bitsery::ext::InPlaceOptional(),
               [](S& s, auto& v) { s.value4b(v); });
         s.value1b(hide_daw);
+        s.value1b(parameter_mirror);
+        s.value1b(parameter_queue);
+        s.value1b(vst3_coalesce_edits);
         s.value1b(vst3_no_scaling);
         s.value1b(vst3_prefer_32bit);
 
@@ -101,6 +101,20 @@ Logger Logger::create_wine_stderr() {
                   verbosity_level, "", false);
 }
 
+void Logger::log_memory_lock_result(const std::string& description,
+                                    const MemoryLockResult& result) {
+    if (!result.succeeded()) {
+        log("WARNING: Could not lock the " + description + " into memory (" +
+            std::to_string(result.resident_bytes / 1024) + " of " +
+            std::to_string(result.size / 1024) + " KiB resident, " +
+            (result.locked ? "locked" : "mlock() failed") +
+            "). Try increasing RLIMIT_MEMLOCK.");
+    } else if (verbosity >= Verbosity::most_events) {
+        log("[realtime memory] locked " + std::to_string(result.size / 1024) +
+            " KiB of " + description);
+    }
+}
+
 void Logger::log(const std::string& message) {
     std::ostringstream formatted_message;
 
@@ -134,6 +134,18 @@ class Logger {
      */
     void log(const std::string& message);
 
+    /**
+     * Log the result of pre-faulting and locking memory used during audio
+     * processing when the `audio_realtime_memory` option is enabled. Failures
+     * are always printed, and the locked footprint is printed when the
+     * verbosity level is set to at least `most_events`. This is used on both
+     * the native plugin and the Wine plugin host side.
+     *
+     * @param description What was being locked, e.g. `"audio buffers"`.
+     */
+    void log_memory_lock_result(const std::string& description,
+                                const MemoryLockResult& result);
+
     /**
      * Write output from an async pipe to the log on a line by line basis.
      * Useful for logging the Wine process's STDOUT and STDERR streams.
@@ -250,6 +250,15 @@ bool Vst3Logger::log_request(
     });
 }
 
+bool Vst3Logger::log_request(
+    bool is_host_vst,
+    const YaEditController::GetAllParameterInfo& request) {
+    return log_request_base(is_host_vst, [&](auto& message) {
+        message << request.instance_id
+                << ": IEditController::getParameterInfo() for all parameters";
+    });
+}
+
 bool Vst3Logger::log_request(
     bool is_host_vst,
     const YaEditController::GetParamStringByValue& request) {
@@ -1075,6 +1084,16 @@ bool Vst3Logger::log_request(
         });
 }
 
+bool Vst3Logger::log_request(
+    bool is_host_vst,
+    const YaAudioProcessor::GetOversizedProcessResponse& request) {
+    return log_request_base(is_host_vst, [&](auto& message) {
+        message << request.instance_id
+                << ": IAudioProcessor::process() <fetching the response that "
+                   "did not fit in shared memory>";
+    });
+}
+
 bool Vst3Logger::log_request(bool is_host_vst,
                              const YaAudioProcessor::GetTailSamples& request) {
     return log_request_base(
@@ -1199,6 +1218,16 @@ bool Vst3Logger::log_request(bool is_host_vst,
     });
 }
 
+bool Vst3Logger::log_request(bool is_host_vst,
+                             const YaComponentHandler::PerformEdits& request) {
+    return log_request_base(is_host_vst, [&](auto& message) {
+        message << request.owner_instance_id
+                << ": IComponentHandler::{beginEdit,performEdit,endEdit}() "
+                   "with <"
+                << request.edits.size() << " coalesced edits>";
+    });
+}
+
 bool Vst3Logger::log_request(
     bool is_host_vst,
     const YaComponentHandler::RestartComponent& request) {
@@ -1496,6 +1525,15 @@ void Vst3Logger::log_response(
     });
 }
 
+void Vst3Logger::log_response(
+    bool is_host_vst,
+    const YaEditController::GetAllParameterInfoResponse& response) {
+    log_response_base(is_host_vst, [&](auto& message) {
+        message << "<ParameterInfo for " << response.parameters.size() << " of "
+                << response.parameter_count << " parameters>";
+    });
+}
+
 void Vst3Logger::log_response(
     bool is_host_vst,
     const YaEditController::GetParamStringByValueResponse& response) {
@@ -85,6 +85,8 @@ class Vst3Logger {
                      const YaEditController::GetParameterCount&);
     bool log_request(bool is_host_vst,
                      const YaEditController::GetParameterInfo&);
+    bool log_request(bool is_host_vst,
+                     const YaEditController::GetAllParameterInfo&);
     bool log_request(bool is_host_vst,
                      const YaEditController::GetParamStringByValue&);
     bool log_request(bool is_host_vst,
@@ -194,6 +196,8 @@ class Vst3Logger {
     bool log_request(bool is_host_vst, const YaAudioProcessor::SetProcessing&);
     bool log_request(bool is_host_vst,
                      const MessageReference<YaAudioProcessor::Process>&);
+    bool log_request(bool is_host_vst,
+                     const YaAudioProcessor::GetOversizedProcessResponse&);
     bool log_request(bool is_host_vst, const YaAudioProcessor::GetTailSamples&);
     bool log_request(bool is_host_vst,
                      const YaComponent::GetControllerClassId&);
@@ -211,6 +215,8 @@ class Vst3Logger {
     bool log_request(bool is_host_vst, const YaComponentHandler::BeginEdit&);
     bool log_request(bool is_host_vst, const YaComponentHandler::PerformEdit&);
     bool log_request(bool is_host_vst, const YaComponentHandler::EndEdit&);
+    bool log_request(bool is_host_vst,
+                     const YaComponentHandler::PerformEdits&);
     bool log_request(bool is_host_vst,
                      const YaComponentHandler::RestartComponent&);
     bool log_request(bool is_host_vst, const YaComponentHandler2::SetDirty&);
@@ -257,6 +263,8 @@ class Vst3Logger {
     void log_response(bool is_host_vst,
                       const YaEditController::GetParameterInfoResponse&,
                       bool from_cache = false);
+    void log_response(bool is_host_vst,
+                      const YaEditController::GetAllParameterInfoResponse&);
     void log_response(bool is_host_vst,
                       const YaEditController::GetParamStringByValueResponse&);
     void log_response(bool is_host_vst,
@@ -16,9 +16,19 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #ifdef __WINE__
 #include "../wine-host/boost-fix.h"
@@ -26,6 +36,55 @@
 #include <boost/asio/dispatch.hpp>
 #include <boost/asio/io_context.hpp>
 
+/**
+ * The maximum number of idle helper threads and IO contexts a
+ * `MutualRecursionHelper` keeps around for future `fork()` calls. A single
+ * mutually recursive call only needs one of each, so this only has to be large
+ * enough to cover the nesting depth we'd normally see.
+ */
+constexpr size_t max_idle_mutual_recursion_helpers = 4;
+
+/**
+ * Counters for how often and how deeply a `MutualRecursionHelper` was used.
+ * These are printed when a plugin shuts down if the verbosity level is set to
+ * at least `most_events`.
+ */
+struct MutualRecursionStatistics {
+    /**
+     * The number of calls to `MutualRecursionHelper::fork()`.
+     */
+    uint64_t num_forks = 0;
+    /**
+     * How many of those calls could reuse an idle helper thread instead of
+     * having to spawn a new one.
+     */
+    uint64_t num_reused_threads = 0;
+    /**
+     * The number of function calls that were run on a thread calling `fork()`
+     * through `handle()` or `maybe_handle()`.
+     */
+    uint64_t num_handled_calls = 0;
+    /**
+     * The deepest level of nested `fork()` calls we have seen.
+     */
+    uint64_t max_depth = 0;
+};
+
+/**
+ * Format `MutualRecursionStatistics` as a log message. Used on both the native
+ * plugin and the Wine plugin host side when a plugin shuts down.
+ */
+inline std::string format_mutual_recursion_statistics(
+    const MutualRecursionStatistics& statistics) {
+    return "[mutual recursion] " + std::to_string(statistics.num_forks) +
+           " mutually recursive calls (" +
+           std::to_string(statistics.num_reused_threads) +
+           " on reused threads), " +
+           std::to_string(statistics.num_handled_calls) +
+           " calls handled on the calling thread, nested up to " +
+           std::to_string(statistics.max_depth) + " levels deep";
+}
+
 /**
  * A helper to allow mutually recursive calling sequences with remote function
  * calls. Some plugins (and hosts) are very picky about which thread a function
@@ -49,14 +108,19 @@
  * thread 2:            \-----waiting for fn() to return-----/
  * ```
  *
- * Here `fork(fn)` will call the function `fn` on a new thread (which presumably
- * does some blocking socket operations), and `handle(foo)` will call `foo()` on
- * the thread that originally called `fork(fn)`. If the function passed to
- * `handle()` also calls `fork()` (or more likely, the function pass to
- * `handle()` calls an unmanaged plugin/host function that ends up performing a
- * mutually recursive callback), then this sequence allows for arbitrarily
+ * Here `fork(fn)` will call the function `fn` on another thread (which
+ * presumably does some blocking socket operations), and `handle(foo)` will call
+ * `foo()` on the thread that originally called `fork(fn)`. If the function
+ * passed to `handle()` also calls `fork()` (or more likely, the function pass
+ * to `handle()` calls an unmanaged plugin/host function that ends up performing
+ * a mutually recursive callback), then this sequence allows for arbitrarily
  * nested mutual recursion.
  *
+ * Opening an editor or resizing it can easily result in a handful of these
+ * calls, so both the threads used for `fn` and the IO contexts used to accept
+ * calls from `handle()` are pooled. A nested `fork()` will simply use another
+ * helper thread while the outer helper thread is still blocked.
+ *
  * @tparam Thread The thread implementation to use. On the Linux side this
  *   should be `std::jthread` and on the Wine side this should be `Win32Thread`.
  */
@@ -64,8 +128,28 @@ template <typename Thread>
 class MutualRecursionHelper {
    public:
     /**
-     * Run `fn` from a new thread, while handling calls to `handle()` and
-     * `maybe_handle()` on this thread. See the docstring on
+     * Joins all idle helper threads. There cannot be any active `fork()` calls
+     * at this point.
+     */
+    ~MutualRecursionHelper() noexcept {
+        std::unordered_map<size_t, Thread> stopped_helper_threads;
+        {
+            std::lock_guard lock(helper_threads_mutex);
+            is_shutting_down = true;
+
+            has_pending_tasks_cv.notify_all();
+            stopped_helper_threads = std::move(helper_threads);
+            helper_threads.clear();
+        }
+
+        // The helper threads need to reacquire the lock before they can exit,
+        // so we can only join them after releasing it
+        stopped_helper_threads.clear();
+    }
+
+    /**
+     * Run `fn` from a pooled helper thread, while handling calls to `handle()`
+     * and `maybe_handle()` on this thread. See the docstring on
      * `MutualRecursionHelper` for more information on this mechanism.
      *
      * @param fn A (blocking) function that should be called on another thread..
@@ -83,12 +167,22 @@ class MutualRecursionHelper {
         // as we need to support multiple levels of mutual recursion. This can
         // for instance happen during `IPlugView::attached() ->
         // IPlugFrame::resizeView() -> IPlugView::onSize()`.
-        std::shared_ptr<boost::asio::io_context> current_io_context =
-            std::make_shared<boost::asio::io_context>();
+        std::shared_ptr<boost::asio::io_context> current_io_context;
         {
             std::unique_lock lock(mutual_recursion_contexts_mutex);
+            if (idle_io_contexts.empty()) {
+                current_io_context =
+                    std::make_shared<boost::asio::io_context>();
+            } else {
+                current_io_context = std::move(idle_io_contexts.back());
+                idle_io_contexts.pop_back();
+            }
+
             mutual_recursion_contexts.push_back(current_io_context);
+            max_depth = std::max<uint64_t>(max_depth,
+                                           mutual_recursion_contexts.size());
         }
+        num_forks.fetch_add(1, std::memory_order_relaxed);
 
         // Instead of directly stopping the IO context, we'll reset this work
         // guard instead. This prevents us from accidentally cancelling any
@@ -96,9 +190,13 @@ class MutualRecursionHelper {
         auto work_guard = boost::asio::make_work_guard(*current_io_context);
 
         // We will call the function from another thread so we can handle calls
-        // to `handle()`/`maybe_handle()` from this thread
-        std::promise<Result> response_promise{};
-        Thread sending_thread([&]() {
+        // to `handle()`/`maybe_handle()` from this thread. The helper thread
+        // outlives this call, so it needs to share ownership of the promise
+        // since it may still be inside of `set_value()` when we return.
+        std::shared_ptr<std::promise<Result>> response_promise =
+            std::make_shared<std::promise<Result>>();
+        std::future<Result> response_future = response_promise->get_future();
+        run_on_helper_thread([&, response_promise]() {
             const Result response = fn();
 
             // Stop accepting additional work to be run from the calling thread
@@ -112,14 +210,25 @@ class MutualRecursionHelper {
                 std::find(mutual_recursion_contexts.begin(),
                           mutual_recursion_contexts.end(), current_io_context));
 
-            response_promise.set_value(response);
+            response_promise->set_value(response);
         });
 
         // Accept work from the other thread until we receive a response, at
         // which point the context will be stopped
         current_io_context->run();
+        Result response = response_future.get();
+
+        // The context has run out of work, so it can be reused for the next
+        // `fork()` after a restart
+        current_io_context->restart();
+        {
+            std::lock_guard lock(mutual_recursion_contexts_mutex);
+            if (idle_io_contexts.size() < max_idle_mutual_recursion_helpers) {
+                idle_io_contexts.push_back(std::move(current_io_context));
+            }
+        }
 
-        return response_promise.get_future().get();
+        return response;
     }
 
     /**
@@ -170,11 +279,95 @@ class MutualRecursionHelper {
         boost::asio::dispatch(*mutual_recursion_contexts.back(),
                               std::move(do_call));
         mutual_recursion_lock.unlock();
+        num_handled_calls.fetch_add(1, std::memory_order_relaxed);
 
         return do_call_response.get();
     }
 
+    /**
+     * Get a snapshot of the counters for this helper.
+     */
+    MutualRecursionStatistics statistics() {
+        uint64_t current_max_depth;
+        {
+            std::lock_guard lock(mutual_recursion_contexts_mutex);
+            current_max_depth = max_depth;
+        }
+
+        return MutualRecursionStatistics{
+            .num_forks = num_forks.load(std::memory_order_relaxed),
+            .num_reused_threads =
+                num_reused_threads.load(std::memory_order_relaxed),
+            .num_handled_calls =
+                num_handled_calls.load(std::memory_order_relaxed),
+            .max_depth = current_max_depth};
+    }
+
    private:
+    /**
+     * Run `task` on an idle helper thread, or spawn a new helper thread if all
+     * of them are currently busy. This works the same way as
+     * `AdHocWorkerPool::submit()`.
+     */
+    void run_on_helper_thread(std::function<void()> task) {
+        std::lock_guard lock(helper_threads_mutex);
+
+        // The join is implicit because we're using `std::jthread`/`Win32Thread`
+        for (const size_t thread_id : finished_helper_threads) {
+            helper_threads.erase(thread_id);
+        }
+        finished_helper_threads.clear();
+
+        pending_tasks.push_back(std::move(task));
+        if (pending_tasks.size() <= num_idle_helper_threads) {
+            num_reused_threads.fetch_add(1, std::memory_order_relaxed);
+            has_pending_tasks_cv.notify_one();
+        } else {
+            const size_t thread_id = next_helper_thread_id++;
+            helper_threads[thread_id] =
+                Thread([this, thread_id]() { run_helper_thread(thread_id); });
+        }
+    }
+
+    /**
+     * The loop run by every helper thread. Runs tasks from `pending_tasks`
+     * until the helper gets destroyed, or until there are already enough other
+     * idle helper threads after finishing a task.
+     */
+    void run_helper_thread(size_t thread_id) {
+        std::unique_lock lock(helper_threads_mutex);
+        while (true) {
+            num_idle_helper_threads++;
+            has_pending_tasks_cv.wait(lock, [&]() {
+                return is_shutting_down || !pending_tasks.empty();
+            });
+            num_idle_helper_threads--;
+
+            if (is_shutting_down) {
+                break;
+            }
+
+            {
+                std::function<void()> task = std::move(pending_tasks.front());
+                pending_tasks.pop_front();
+                lock.unlock();
+
+                task();
+            }
+
+            lock.lock();
+            if (num_idle_helper_threads >= max_idle_mutual_recursion_helpers) {
+                break;
+            }
+        }
+
+        // If we're not shutting down, then the next call to
+        // `run_on_helper_thread()` will join this thread
+        if (!is_shutting_down) {
+            finished_helper_threads.push_back(thread_id);
+        }
+    }
+
     /**
      * These IO contexts will let us call functions from the thread that's
      * currently calling `fork()` while we're waiting for the passed function to
@@ -187,5 +380,39 @@ class MutualRecursionHelper {
      */
     std::vector<std::shared_ptr<boost::asio::io_context>>
         mutual_recursion_contexts;
+    /**
+     * IO contexts from earlier `fork()` calls that can be reused. These have
+     * already been restarted.
+     */
+    std::vector<std::shared_ptr<boost::asio::io_context>> idle_io_contexts;
+    /**
+     * The deepest `mutual_recursion_contexts` stack we've seen. Guarded by
+     * `mutual_recursion_contexts_mutex` since it's updated together with that
+     * stack.
+     */
+    uint64_t max_depth = 0;
     std::mutex mutual_recursion_contexts_mutex;
+
+    /**
+     * The threads `fork()` runs its functions on. All fields below are guarded
+     * by `helper_threads_mutex`.
+     */
+    std::unordered_map<size_t, Thread> helper_threads;
+    size_t next_helper_thread_id = 0;
+    std::mutex helper_threads_mutex;
+
+    /**
+     * Helper threads that have exited because there were already enough idle
+     * helper threads. These will be joined in the next call to
+     * `run_on_helper_thread()`.
+     */
+    std::vector<size_t> finished_helper_threads;
+    std::deque<std::function<void()>> pending_tasks;
+    std::condition_variable has_pending_tasks_cv;
+    size_t num_idle_helper_threads = 0;
+    bool is_shutting_down = false;
+
+    std::atomic_uint64_t num_forks = 0;
+    std::atomic_uint64_t num_reused_threads = 0;
+    std::atomic_uint64_t num_handled_calls = 0;
 };
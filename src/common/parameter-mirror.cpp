@@ -0,0 +1,48 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "parameter-mirror.h"
+
+#include <algorithm>
+
+static_assert(std::atomic_uint32_t::is_always_lock_free);
+
+ParameterMirror::ParameterMirror(const Config& config)
+    : config(config),
+      shm(boost::interprocess::open_or_create,
+          config.name.c_str(),
+          boost::interprocess::read_write) {
+    // Plugins without any parameters still get a single entry, since mapping
+    // an empty shared memory object would fail
+    const size_t size =
+        std::max<size_t>(config.num_parameters, 1) * sizeof(uint32_t);
+    shm.truncate(static_cast<boost::interprocess::offset_t>(size));
+    region = boost::interprocess::mapped_region(
+        shm, boost::interprocess::read_write, 0, size);
+
+    values = reinterpret_cast<std::atomic_uint32_t*>(region.get_address());
+}
+
+ParameterMirror::~ParameterMirror() noexcept {
+    boost::interprocess::shared_memory_object::remove(config.name.c_str());
+}
+
+void ParameterMirror::invalidate_all() noexcept {
+    for (uint32_t i = 0; i < config.num_parameters; i++) {
+        values[i].store(unknown_value, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+}
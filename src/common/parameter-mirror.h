@@ -0,0 +1,155 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#ifdef __WINE__
+#include "../wine-host/boost-fix.h"
+#endif
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+/**
+ * The number of parameters the Wine plugin host refreshes in a
+ * `ParameterMirror` on every event loop tick. Parameters are refreshed in a
+ * round robin fashion from the main thread, so for plugins with a lot of
+ * parameters a change the plugin didn't report through `audioMasterAutomate()`
+ * may take a couple of frames to show up.
+ */
+constexpr uint32_t parameter_mirror_refresh_batch_size = 32;
+
+/**
+ * A table of parameter values shared between the native plugin and the Wine
+ * plugin host, used for the `parameter_mirror` option. Hosts tend to poll every
+ * single parameter of a plugin multiple times per second for automation lanes
+ * and generic plugin UIs, and without this every one of those calls would
+ * require a round trip to the Wine plugin host. With this table the Wine plugin
+ * host keeps a copy of the plugin's parameter values up to date, and the native
+ * plugin can then read from that table without any locking or communication.
+ *
+ * Entries start out as unknown. The native plugin should fall back to asking
+ * the plugin directly for unknown values, and the Wine plugin host then stores
+ * the value it got from the plugin in the table. The Wine plugin host updates
+ * entries when the host changes a parameter, when the plugin reports a
+ * parameter change to the host, and periodically while processing audio.
+ * Plugins that compute parameter values lazily will still be queried directly,
+ * since their values only end up in the table after they've been queried once.
+ *
+ * The values are stored as 32-bit atomics so this also works between the
+ * native plugin and the 32-bit bitbridge.
+ */
+class ParameterMirror {
+   public:
+    /**
+     * The information needed to connect to the shared memory object. This is
+     * created on the Wine side and then sent to the native plugin.
+     */
+    struct Config {
+        /**
+         * The name of the shared memory object.
+         */
+        std::string name;
+        /**
+         * The number of parameters in the table. Any parameters with a higher
+         * index are never mirrored.
+         */
+        uint32_t num_parameters;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.text1b(name, 1024);
+            s.value4b(num_parameters);
+        }
+    };
+
+    /**
+     * Create or connect to the shared memory object described by `config`.
+     * After creating the object on the Wine side, `invalidate_all()` should be
+     * called before sending the configuration to the native plugin.
+     *
+     * @throw boost::interprocess::interprocess_exception If the shared memory
+     *   object could not be created or mapped.
+     */
+    explicit ParameterMirror(const Config& config);
+
+    /**
+     * Removes the shared memory object. Like with `AudioShmBuffer`, this is
+     * done on both sides.
+     */
+    ~ParameterMirror() noexcept;
+
+    ParameterMirror(const ParameterMirror&) = delete;
+    ParameterMirror& operator=(const ParameterMirror&) = delete;
+
+    /**
+     * Get the mirrored value for a parameter, if we know it.
+     */
+    inline std::optional<float> get(uint32_t index) const noexcept {
+        if (index >= config.num_parameters) {
+            return std::nullopt;
+        }
+
+        const uint32_t bits = values[index].load(std::memory_order_acquire);
+        if (bits == unknown_value) {
+            return std::nullopt;
+        }
+
+        return std::bit_cast<float>(bits);
+    }
+
+    /**
+     * Update the mirrored value for a parameter. Indices outside of the table
+     * are ignored.
+     */
+    inline void set(uint32_t index, float value) noexcept {
+        if (index < config.num_parameters) {
+            values[index].store(std::bit_cast<uint32_t>(value),
+                                std::memory_order_release);
+        }
+    }
+
+    /**
+     * Mark all parameter values as unknown. This should be done whenever any
+     * of the plugin's parameters may have changed without us knowing, like
+     * after loading a preset.
+     */
+    void invalidate_all() noexcept;
+
+    const Config config;
+
+   private:
+    /**
+     * The bit pattern used to mark values as unknown. This is a NaN that a
+     * plugin should never return. If it does, then we'll simply always ask the
+     * plugin for that parameter's value.
+     */
+    static constexpr uint32_t unknown_value = 0xffffffff;
+
+    boost::interprocess::shared_memory_object shm;
+    boost::interprocess::mapped_region region;
+
+    /**
+     * `config.num_parameters` values stored in `region`, with their float bit
+     * patterns.
+     */
+    std::atomic_uint32_t* values;
+};
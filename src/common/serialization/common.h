@@ -43,6 +43,19 @@ struct Ack {
     void serialize(S&) {}
 };
 
+/**
+ * The response type for one-way requests. These requests are handled in order
+ * with the other requests sent over the same socket, but the sending side will
+ * not wait for them to be handled and the receiving side will not write back a
+ * response. This should only be used for notifications where the result is
+ * meaningless and where the receiving side does not need to call back into the
+ * sending thread.
+ */
+struct OneWay {
+    template <typename S>
+    void serialize(S&) {}
+};
+
 /**
  * An object containing the startup options for hosting a plugin. These options
  * are passed to `yabridge-host.exe` as command line arguments, and they are
@@ -447,6 +447,14 @@ struct Vst2Event {
      * `effSetSpeakerArrangement` are the only events that use this.
      */
     std::optional<Payload> value_payload;
+    /**
+     * Whether the sending side is waiting for a response. One-way events are
+     * handled in order with the other events sent over the same socket, but
+     * the receiving side won't send back an `Vst2EventResult`.
+     *
+     * @see DefaultDataConverter::is_one_way
+     */
+    bool one_way = false;
 
     template <typename S>
     void serialize(S& s) {
@@ -458,6 +466,7 @@ struct Vst2Event {
         s.object(payload);
         s.ext(value_payload, bitsery::ext::InPlaceOptional(),
               [](S& s, auto& v) { s.object(v); });
+        s.value1b(one_way);
     }
 };
 
@@ -507,6 +516,50 @@ struct Parameter {
     }
 };
 
+/**
+ * The maximum number of parameter changes that can be sent along with a single
+ * `Vst2ProcessRequest`.
+ */
+constexpr size_t max_parameter_changes = 1 << 16;
+
+/**
+ * A single `setParameter()` call. With the `parameter_queue` option enabled,
+ * parameter changes made by the host from the audio thread are sent along with
+ * the next processing request as a list of these.
+ */
+struct ParameterChange {
+    int32_t index;
+    float value;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.value4b(index);
+        s.value4b(value);
+    }
+};
+
+/**
+ * The response to a `Vst2ProcessRequest`. The audio itself is written to the
+ * shared memory buffers, but MIDI output sent by the plugin through
+ * `audioMasterProcessEvents()` during audio processing is buffered on the Wine
+ * side and returned as part of this response. That avoids a host callback
+ * round trip from within the audio thread for every block the plugin produces
+ * MIDI output in. These events need to be passed to the host before returning
+ * from the processing function.
+ */
+struct Vst2ProcessResponse {
+    /**
+     * All MIDI events sent by the plugin from the audio thread during this
+     * processing cycle, in order.
+     */
+    DynamicVstEvents output_events;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.object(output_events);
+    }
+};
+
 /**
  * When the host calls `processReplacing()`, `processDoubleReplacing()`, or the
  * deprecated `process()` function on our VST2 plugin, we'll write the input
@@ -515,7 +568,7 @@ struct Parameter {
  * host with the rest of the .
  */
 struct Vst2ProcessRequest {
-    using Response = Ack;
+    using Response = Vst2ProcessResponse;
 
     /**
      * The number of samples per channel. We'll trust the host to never provide
@@ -553,6 +606,33 @@ struct Vst2ProcessRequest {
      */
     std::optional<int> new_realtime_priority;
 
+    /**
+     * With the `audio_thread_affinity` option set to follow the host, we'll
+     * send the CPU affinity the Wine plugin host's audio thread should use
+     * whenever it changes.
+     *
+     * @see AudioThreadAffinitySync
+     */
+    std::optional<CpuSet> new_cpu_affinity;
+
+    /**
+     * The MIDI events the host passed to the plugin through
+     * `effProcessEvents()` since the last processing cycle. Hosts call that
+     * function right before processing audio, so instead of sending those
+     * events over the dispatch socket we'll attach them to the processing
+     * request. The Wine plugin host will then call `effProcessEvents()` right
+     * before processing the audio.
+     */
+    DynamicVstEvents midi_events;
+
+    /**
+     * With the `parameter_queue` option enabled, these are the parameter
+     * changes the host made from the audio thread since the last processing
+     * cycle. The Wine plugin host will apply these in order right before
+     * processing audio.
+     */
+    boost::container::small_vector<ParameterChange, 64> parameter_changes;
+
     template <typename S>
     void serialize(S& s) {
         s.value4b(sample_frames);
@@ -563,9 +643,165 @@ struct Vst2ProcessRequest {
 
         s.ext(new_realtime_priority, bitsery::ext::InPlaceOptional{},
               [](S& s, int& priority) { s.value4b(priority); });
+        s.ext(new_cpu_affinity, bitsery::ext::InPlaceOptional{});
+
+        s.object(midi_events);
+        s.container(parameter_changes, max_parameter_changes);
     }
 };
 
+/**
+ * The maximum number of MIDI events that can be sent as part of a
+ * `Vst2ProcessRequestBlock`. If the host sends more events than this, then
+ * they'll be sent through the dispatch socket instead.
+ */
+constexpr size_t max_process_request_events = 64;
+
+/**
+ * The maximum number of parameter changes that can be sent as part of a
+ * `Vst2ProcessRequestBlock`. If more parameters have been changed, then those
+ * changes will be sent over the parameters socket instead.
+ */
+constexpr size_t max_process_request_parameter_changes = 128;
+
+/**
+ * The same information as in `Vst2ProcessRequest`, but as a fixed-layout,
+ * trivially copyable struct. When the `audio_futex_handshake` option is
+ * enabled the native plugin will write the processing request directly to the
+ * request area in the `AudioShmBuffer`'s control block using this struct, and
+ * the Wine plugin host will read it from there in place. That way we don't
+ * need to serialize anything during audio processing, and the cost of sending
+ * a request no longer depends on whether the host provided transport
+ * information.
+ *
+ * The time info, CPU set, MIDI events and parameter changes are stored first
+ * so this struct has the same layout on both 32-bit and 64-bit platforms,
+ * which is needed for the bitbridge.
+ */
+struct alignas(8) Vst2ProcessRequestBlock {
+    Vst2ProcessRequestBlock() noexcept = default;
+
+    /**
+     * Copy the information from a `Vst2ProcessRequest` received over a socket
+     * into this fixed-layout struct. The MIDI events and parameter changes are
+     * not copied, and `num_midi_events` and `num_parameter_changes` will be set
+     * to zero. Those are passed separately to `Vst2Bridge::process_audio()`
+     * when receiving the request over a socket, and they're written directly
+     * to the shared memory buffer when using the futex handshake.
+     */
+    explicit Vst2ProcessRequestBlock(const Vst2ProcessRequest& request) noexcept
+        : sample_frames(request.sample_frames),
+          current_process_level(request.current_process_level),
+          new_realtime_priority(request.new_realtime_priority.value_or(0)),
+          num_midi_events(0),
+          num_parameter_changes(0),
+          double_precision(request.double_precision),
+          has_current_time_info(request.current_time_info.has_value()),
+          has_new_realtime_priority(
+              request.new_realtime_priority.has_value()),
+          has_new_cpu_affinity(request.new_cpu_affinity.has_value()) {
+        if (request.current_time_info) {
+            current_time_info = *request.current_time_info;
+        }
+        if (request.new_cpu_affinity) {
+            new_cpu_affinity = *request.new_cpu_affinity;
+        }
+    }
+
+    /**
+     * @see Vst2ProcessRequest::current_time_info
+     * @see has_current_time_info
+     */
+    VstTimeInfo current_time_info;
+    /**
+     * @see Vst2ProcessRequest::new_cpu_affinity
+     * @see has_new_cpu_affinity
+     */
+    CpuSet new_cpu_affinity;
+    /**
+     * @see Vst2ProcessRequest::midi_events
+     * @see num_midi_events
+     */
+    VstEvent midi_events[max_process_request_events];
+    /**
+     * @see Vst2ProcessRequest::parameter_changes
+     * @see num_parameter_changes
+     */
+    ParameterChange parameter_changes[max_process_request_parameter_changes];
+
+    /**
+     * @see Vst2ProcessRequest::sample_frames
+     */
+    int32_t sample_frames;
+    /**
+     * @see Vst2ProcessRequest::current_process_level
+     */
+    int32_t current_process_level;
+    /**
+     * @see Vst2ProcessRequest::new_realtime_priority
+     * @see has_new_realtime_priority
+     */
+    int32_t new_realtime_priority;
+    /**
+     * The number of elements in `midi_events` that contain MIDI events.
+     */
+    int32_t num_midi_events;
+    /**
+     * The number of elements in `parameter_changes` that contain parameter
+     * changes.
+     */
+    int32_t num_parameter_changes;
+
+    /**
+     * @see Vst2ProcessRequest::double_precision
+     */
+    bool double_precision;
+    /**
+     * Whether `current_time_info` contains the host's transport information.
+     */
+    bool has_current_time_info;
+    /**
+     * Whether `new_realtime_priority` contains a new priority the audio thread
+     * on the Wine side should switch to.
+     */
+    bool has_new_realtime_priority;
+    /**
+     * Whether `new_cpu_affinity` contains a new CPU affinity the audio thread
+     * on the Wine side should switch to.
+     */
+    bool has_new_cpu_affinity;
+};
+
+static_assert(std::is_trivially_copyable_v<Vst2ProcessRequestBlock>);
+static_assert(sizeof(VstTimeInfo) == 88 &&
+              sizeof(Vst2ProcessRequestBlock) == 3312);
+
+/**
+ * The maximum number of MIDI events that can be returned through a
+ * `Vst2ProcessResponseBlock`. Any events beyond this are sent through the
+ * regular host callback socket instead.
+ */
+constexpr size_t max_process_response_events = 64;
+
+/**
+ * The fixed-layout counterpart to `Vst2ProcessResponse`, written by the Wine
+ * plugin host to the `AudioShmBuffer`'s response area when the
+ * `audio_futex_handshake` option is enabled.
+ */
+struct alignas(8) Vst2ProcessResponseBlock {
+    /**
+     * The number of elements in `output_events` that contain MIDI events.
+     */
+    int32_t num_output_events;
+
+    /**
+     * @see Vst2ProcessResponse::output_events
+     */
+    VstEvent output_events[max_process_response_events];
+};
+
+static_assert(std::is_trivially_copyable_v<Vst2ProcessResponseBlock>);
+
 /**
  * The serialization function for `AEffect` structs. This will s serialize all
  * of the values but it will not touch any of the pointer fields. That way you
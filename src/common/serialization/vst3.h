@@ -81,6 +81,7 @@ using ControlRequest =
                  YaEditController::SetComponentState,
                  YaEditController::GetParameterCount,
                  YaEditController::GetParameterInfo,
+                 YaEditController::GetAllParameterInfo,
                  YaEditController::GetParamStringByValue,
                  YaEditController::GetParamValueByString,
                  YaEditController::NormalizedParamToPlain,
@@ -186,6 +187,7 @@ struct AudioProcessorRequest {
                      // destroy the object (and deallocate all vectors in it) on
                      // the Wine side during every processing cycle.
                      MessageReference<YaAudioProcessor::Process>,
+                     YaAudioProcessor::GetOversizedProcessResponse,
                      YaAudioProcessor::GetTailSamples,
                      YaComponent::GetControllerClassId,
                      YaComponent::SetIoMode,
@@ -238,6 +240,7 @@ using CallbackRequest =
                  YaComponentHandler::BeginEdit,
                  YaComponentHandler::PerformEdit,
                  YaComponentHandler::EndEdit,
+                 YaComponentHandler::PerformEdits,
                  YaComponentHandler::RestartComponent,
                  YaComponentHandler2::SetDirty,
                  YaComponentHandler2::RequestOpenEditor,
@@ -63,10 +63,12 @@ class YaComponentHandler2 : public Steinberg::Vst::IComponentHandler2 {
 
     /**
      * Message to pass through a call to `IComponentHandler2::setDirty(state)`
-     * to the component handler provided by the host.
+     * to the component handler provided by the host. This is a one-way
+     * message since this is only a notification for the host, and plugins
+     * don't do anything with the result.
      */
     struct SetDirty {
-        using Response = UniversalTResult;
+        using Response = OneWay;
 
         native_size_t owner_instance_id;
 
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <pluginterfaces/vst/ivsteditcontroller.h>
 
 #include "../../common.h"
@@ -126,6 +128,56 @@ class YaComponentHandler : public Steinberg::Vst::IComponentHandler {
 
     virtual tresult PLUGIN_API endEdit(Steinberg::Vst::ParamID id) override = 0;
 
+    /**
+     * A single `beginEdit()`, `performEdit()` or `endEdit()` call that was
+     * buffered on the Wine side. Used in `PerformEdits`.
+     */
+    struct ParameterEdit {
+        enum class Type {
+            begin,
+            perform,
+            end,
+        };
+
+        Type type;
+
+        Steinberg::Vst::ParamID id;
+        /**
+         * The new normalized value. Only meaningful for `Type::perform`.
+         */
+        Steinberg::Vst::ParamValue value_normalized;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value4b(type);
+            s.value4b(id);
+            s.value8b(value_normalized);
+        }
+    };
+
+    /**
+     * Message to pass through a batch of `IComponentHandler::beginEdit()`,
+     * `IComponentHandler::performEdit()` and `IComponentHandler::endEdit()`
+     * calls at once. When the `vst3_coalesce_edits` option is enabled, the
+     * Wine plugin host will buffer these calls during an event loop cycle and
+     * only keep the last value for a parameter within a gesture. The native
+     * plugin will then replay these edits to the host's component handler in
+     * order.
+     */
+    struct PerformEdits {
+        using Response = UniversalTResult;
+
+        native_size_t owner_instance_id;
+
+        std::vector<ParameterEdit> edits;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(owner_instance_id);
+            s.container(edits, 1 << 16);
+        }
+    };
+
     /**
      * Message to pass through a call to
      * `IComponentHandler::restartComponent(flags)` to the component handler
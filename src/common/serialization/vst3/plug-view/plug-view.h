@@ -258,10 +258,11 @@ class YaPlugView : public Steinberg::IPlugView {
 
     /**
      * Message to pass through a call to `IPlugView::onFocus(state)` to the Wine
-     * plugin host.
+     * plugin host. This is a one-way message, so the host won't have to wait
+     * for this to be run from the Wine plugin host's GUI thread.
      */
     struct OnFocus {
-        using Response = UniversalTResult;
+        using Response = OneWay;
 
         native_size_t owner_instance_id;
 
@@ -20,6 +20,7 @@
 
 #include "../../../audio-shm.h"
 #include "../../../bitsery/ext/in-place-optional.h"
+#include "../../../utils.h"
 #include "../../common.h"
 #include "../base.h"
 #include "../process-data.h"
@@ -274,6 +275,15 @@ class YaAudioProcessor : public Steinberg::Vst::IAudioProcessor {
          */
         std::optional<int> new_realtime_priority;
 
+        /**
+         * The CPU affinity the Wine plugin host's audio thread should switch
+         * to when the `audio_thread_affinity` option is set to follow the
+         * host's audio thread.
+         *
+         * @see AudioThreadAffinitySync
+         */
+        std::optional<CpuSet> new_cpu_affinity;
+
         template <typename S>
         void serialize(S& s) {
             s.value8b(instance_id);
@@ -281,6 +291,26 @@ class YaAudioProcessor : public Steinberg::Vst::IAudioProcessor {
 
             s.ext(new_realtime_priority, bitsery::ext::InPlaceOptional{},
                   [](S& s, int& priority) { s.value4b(priority); });
+            s.ext(new_cpu_affinity, bitsery::ext::InPlaceOptional{});
+        }
+    };
+
+    /**
+     * Sent by the native plugin after a `Process` request made through the
+     * futex handshake if the Wine plugin host reported that its response did
+     * not fit in the shared memory response area. The Wine plugin host will
+     * then send that response over the socket instead. The response's output
+     * data still points to the `Process` request's data on both sides, just
+     * like in a normal `Process` call.
+     */
+    struct GetOversizedProcessResponse {
+        using Response = ProcessResponse;
+
+        native_size_t instance_id;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
         }
     };
 
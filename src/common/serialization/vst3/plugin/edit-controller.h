@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <pluginterfaces/vst/ivsteditcontroller.h>
 
 #include "../../../bitsery/ext/in-place-optional.h"
@@ -150,6 +152,41 @@ class YaEditController : public Steinberg::Vst::IEditController {
     getParameterInfo(int32 paramIndex,
                      Steinberg::Vst::ParameterInfo& info /*out*/) override = 0;
 
+    /**
+     * The parameter count and the parameter information for every parameter,
+     * as returned by `IEditController::getParameterCount()` and
+     * `IEditController::getParameterInfo()`. `parameters[i]` contains the
+     * result for parameter index `i`.
+     */
+    struct GetAllParameterInfoResponse {
+        int32 parameter_count;
+        std::vector<GetParameterInfoResponse> parameters;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value4b(parameter_count);
+            s.container(parameters, 1 << 20);
+        }
+    };
+
+    /**
+     * Message to fetch the results of `IEditController::getParameterCount()`
+     * and of `IEditController::getParameterInfo()` for every parameter in a
+     * single request. This is used to fill the parameter information cache on
+     * the plugin side, since hosts will query the information for every
+     * parameter when loading a plugin. This is not an actual VST3 function.
+     */
+    struct GetAllParameterInfo {
+        using Response = GetAllParameterInfoResponse;
+
+        native_size_t instance_id;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+        }
+    };
+
     /**
      * The response code and returned parameter information for a call to
      * `IEditController::getParamStringByValue(id, value_normalized,
@@ -0,0 +1,677 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "process-data-shm.h"
+
+/**
+ * The size of the parameter changes and event regions following a
+ * `ShmProcessInputs` or `ShmProcessOutputs` header.
+ */
+static size_t regions_size_for(
+    const ShmProcessDataCapacity& capacity) noexcept {
+    return ShmParameterChanges::size_for(capacity.parameter_queues,
+                                         capacity.parameter_points) +
+           ShmEventList::size_for(capacity.events);
+}
+
+/**
+ * Get the `ShmEventList` region that directly follows a `ShmParameterChanges`
+ * region.
+ */
+static ShmEventList& events_after(
+    ShmParameterChanges& parameter_changes) noexcept {
+    return *reinterpret_cast<ShmEventList*>(
+        reinterpret_cast<uint8*>(&parameter_changes) +
+        parameter_changes.size());
+}
+
+static const ShmEventList& events_after(
+    const ShmParameterChanges& parameter_changes) noexcept {
+    return *reinterpret_cast<const ShmEventList*>(
+        reinterpret_cast<const uint8*>(&parameter_changes) +
+        parameter_changes.size());
+}
+
+size_t ShmParameterChanges::size_for(uint32 queue_capacity,
+                                     uint32 point_capacity) noexcept {
+    return sizeof(ShmParameterChanges) +
+           (queue_capacity * sizeof(ShmParamValueQueueInfo)) +
+           (point_capacity * sizeof(ShmParamValuePoint));
+}
+
+void ShmParameterChanges::init(uint32 queue_capacity,
+                               uint32 point_capacity) noexcept {
+    this->queue_capacity = queue_capacity;
+    this->point_capacity = point_capacity;
+    clear();
+}
+
+size_t ShmParameterChanges::size() const noexcept {
+    return size_for(queue_capacity, point_capacity);
+}
+
+ShmParamValueQueueInfo* ShmParameterChanges::queues() noexcept {
+    return reinterpret_cast<ShmParamValueQueueInfo*>(this + 1);
+}
+
+const ShmParamValueQueueInfo* ShmParameterChanges::queues() const noexcept {
+    return reinterpret_cast<const ShmParamValueQueueInfo*>(this + 1);
+}
+
+ShmParamValuePoint* ShmParameterChanges::points() noexcept {
+    return reinterpret_cast<ShmParamValuePoint*>(queues() + queue_capacity);
+}
+
+const ShmParamValuePoint* ShmParameterChanges::points() const noexcept {
+    return reinterpret_cast<const ShmParamValuePoint*>(queues() +
+                                                       queue_capacity);
+}
+
+void ShmParameterChanges::clear() noexcept {
+    num_queues = 0;
+    num_points = 0;
+}
+
+bool ShmParameterChanges::repopulate(
+    Steinberg::Vst::IParameterChanges& original_queues) {
+    const int32 parameter_count = original_queues.getParameterCount();
+    if (parameter_count < 0 ||
+        static_cast<uint32>(parameter_count) > queue_capacity) {
+        return false;
+    }
+
+    // We'll check whether everything fits before copying anything, so the
+    // caller can fall back to `YaParameterChanges` without having copied the
+    // points twice
+    uint32 total_point_count = 0;
+    for (int32 i = 0; i < parameter_count; i++) {
+        Steinberg::Vst::IParamValueQueue* original_queue =
+            original_queues.getParameterData(i);
+        const int32 point_count =
+            original_queue ? original_queue->getPointCount() : 0;
+        if (point_count < 0 || total_point_count +
+                                       static_cast<uint32>(point_count) >
+                                   point_capacity) {
+            return false;
+        }
+
+        total_point_count += static_cast<uint32>(point_count);
+    }
+
+    // Every queue's points are stored contiguously, so the views on the Wine
+    // side can index them directly
+    ShmParamValueQueueInfo* const queues = this->queues();
+    ShmParamValuePoint* const points = this->points();
+    num_queues = static_cast<uint32>(parameter_count);
+    num_points = 0;
+    for (uint32 queue_index = 0; queue_index < num_queues; queue_index++) {
+        Steinberg::Vst::IParamValueQueue* original_queue =
+            original_queues.getParameterData(static_cast<int32>(queue_index));
+        const int32 point_count =
+            original_queue ? original_queue->getPointCount() : 0;
+
+        ShmParamValueQueueInfo& queue = queues[queue_index];
+        queue.parameter_id =
+            original_queue ? original_queue->getParameterId() : 0;
+        queue.num_points = static_cast<uint32>(point_count);
+        queue.first_point = num_points;
+        queue.last_point = num_points + queue.num_points - 1;
+
+        for (int32 i = 0; i < point_count; i++) {
+            ShmParamValuePoint& point = points[num_points++];
+            point.queue_index = queue_index;
+
+            // We're skipping the assertions here and just assume that the
+            // function returns `kResultOk`
+            original_queue->getPoint(i, point.sample_offset, point.value);
+        }
+    }
+
+    return true;
+}
+
+void ShmParameterChanges::write_back_outputs(
+    Steinberg::Vst::IParameterChanges& output_queues) const {
+    // The plugin may have interleaved the points for different parameters, so
+    // we'll first add all of the queues to the host's object and we'll then
+    // add the points in the order the plugin added them. This way we don't have
+    // to search through the points for every queue.
+    const ShmParamValueQueueInfo* const queues = this->queues();
+    const ShmParamValuePoint* const points = this->points();
+    std::array<Steinberg::Vst::IParamValueQueue*, max_shm_parameter_queues>
+        output_queue_pointers;
+    assert(num_queues <= max_shm_parameter_queues);
+    for (uint32 queue_index = 0; queue_index < num_queues; queue_index++) {
+        // We don't need this, but the SDK requires us to need this
+        int32 output_queue_index;
+        output_queue_pointers[queue_index] = output_queues.addParameterData(
+            queues[queue_index].parameter_id, output_queue_index);
+    }
+
+    for (uint32 i = 0; i < num_points; i++) {
+        const ShmParamValuePoint& point = points[i];
+        if (Steinberg::Vst::IParamValueQueue* output_queue =
+                output_queue_pointers[point.queue_index]) {
+            // We don't check for `kResultOk` here
+            int32 index;
+            output_queue->addPoint(point.sample_offset, point.value, index);
+        }
+    }
+}
+
+bool ShmEvent::is_supported(const Steinberg::Vst::Event& event) noexcept {
+    switch (event.type) {
+        case Steinberg::Vst::Event::kNoteOnEvent:
+        case Steinberg::Vst::Event::kNoteOffEvent:
+        case Steinberg::Vst::Event::kPolyPressureEvent:
+        case Steinberg::Vst::Event::kNoteExpressionValueEvent:
+        case Steinberg::Vst::Event::kLegacyMIDICCOutEvent:
+            return true;
+            break;
+        default:
+            // These other events contain pointers to heap data
+            return false;
+            break;
+    }
+}
+
+void ShmEvent::set(const Steinberg::Vst::Event& event) noexcept {
+    bus_index = event.busIndex;
+    sample_offset = event.sampleOffset;
+    ppq_position = event.ppqPosition;
+    flags = event.flags;
+    type = event.type;
+
+    switch (event.type) {
+        case Steinberg::Vst::Event::kNoteOnEvent:
+            note_on = event.noteOn;
+            break;
+        case Steinberg::Vst::Event::kNoteOffEvent:
+            note_off = event.noteOff;
+            break;
+        case Steinberg::Vst::Event::kPolyPressureEvent:
+            poly_pressure = event.polyPressure;
+            break;
+        case Steinberg::Vst::Event::kNoteExpressionValueEvent:
+            note_expression_value = event.noteExpressionValue;
+            break;
+        case Steinberg::Vst::Event::kLegacyMIDICCOutEvent:
+            midi_cc_out = event.midiCCOut;
+            break;
+        default:
+            assert(false);
+            break;
+    }
+}
+
+Steinberg::Vst::Event ShmEvent::get() const noexcept {
+    // We of course can't fully initialize a field with an untagged union
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+    Steinberg::Vst::Event event{.busIndex = bus_index,
+                                .sampleOffset = sample_offset,
+                                .ppqPosition = ppq_position,
+                                .flags = flags,
+                                .type = type};
+#pragma GCC diagnostic pop
+    switch (type) {
+        case Steinberg::Vst::Event::kNoteOnEvent:
+            event.noteOn = note_on;
+            break;
+        case Steinberg::Vst::Event::kNoteOffEvent:
+            event.noteOff = note_off;
+            break;
+        case Steinberg::Vst::Event::kPolyPressureEvent:
+            event.polyPressure = poly_pressure;
+            break;
+        case Steinberg::Vst::Event::kNoteExpressionValueEvent:
+            event.noteExpressionValue = note_expression_value;
+            break;
+        case Steinberg::Vst::Event::kLegacyMIDICCOutEvent:
+            event.midiCCOut = midi_cc_out;
+            break;
+    }
+
+    return event;
+}
+
+size_t ShmEventList::size_for(uint32 event_capacity) noexcept {
+    return sizeof(ShmEventList) + (event_capacity * sizeof(ShmEvent));
+}
+
+void ShmEventList::init(uint32 event_capacity) noexcept {
+    this->event_capacity = event_capacity;
+    clear();
+}
+
+size_t ShmEventList::size() const noexcept {
+    return size_for(event_capacity);
+}
+
+ShmEvent* ShmEventList::events() noexcept {
+    return reinterpret_cast<ShmEvent*>(this + 1);
+}
+
+const ShmEvent* ShmEventList::events() const noexcept {
+    return reinterpret_cast<const ShmEvent*>(this + 1);
+}
+
+void ShmEventList::clear() noexcept {
+    num_events = 0;
+}
+
+bool ShmEventList::repopulate(Steinberg::Vst::IEventList& event_list) {
+    const int32 event_count = event_list.getEventCount();
+    if (event_count < 0 || static_cast<uint32>(event_count) > event_capacity) {
+        return false;
+    }
+
+    // Like in `ShmParameterChanges::repopulate()`, we'll make sure all events
+    // can be stored here before copying anything. We're skipping the
+    // `kResultOk` assertions here.
+    Steinberg::Vst::Event event;
+    for (int32 i = 0; i < event_count; i++) {
+        event_list.getEvent(i, event);
+        if (!ShmEvent::is_supported(event)) {
+            return false;
+        }
+    }
+
+    ShmEvent* const events = this->events();
+    num_events = static_cast<uint32>(event_count);
+    for (int32 i = 0; i < event_count; i++) {
+        event_list.getEvent(i, event);
+        events[i].set(event);
+    }
+
+    return true;
+}
+
+void ShmEventList::write_back_outputs(Steinberg::Vst::IEventList& output_events,
+                                      YaEventList& overflow_events) const {
+    // `ShmEventListView::addEvent()` only starts using the overflow list once
+    // an event didn't fit here, so the events stored here were all added
+    // before the ones in `overflow_events`. Plugins don't have to add their
+    // events in order, so we can't merge these lists by sample offset.
+    const ShmEvent* const events = this->events();
+    for (uint32 i = 0; i < num_events; i++) {
+        Steinberg::Vst::Event event = events[i].get();
+        output_events.addEvent(event);
+    }
+
+    overflow_events.write_back_outputs(output_events);
+}
+
+void ShmProcessContext::set(
+    const Steinberg::Vst::ProcessContext& context) noexcept {
+    sample_rate = context.sampleRate;
+    project_time_samples = context.projectTimeSamples;
+    system_time = context.systemTime;
+    continous_time_samples = context.continousTimeSamples;
+    project_time_music = context.projectTimeMusic;
+    bar_position_music = context.barPositionMusic;
+    cycle_start_music = context.cycleStartMusic;
+    cycle_end_music = context.cycleEndMusic;
+    tempo = context.tempo;
+
+    state = context.state;
+    time_sig_numerator = context.timeSigNumerator;
+    time_sig_denominator = context.timeSigDenominator;
+    chord = context.chord;
+    smpte_offset_subframes = context.smpteOffsetSubframes;
+    frame_rate = context.frameRate;
+    samples_to_next_clock = context.samplesToNextClock;
+}
+
+Steinberg::Vst::ProcessContext ShmProcessContext::get() const noexcept {
+    return Steinberg::Vst::ProcessContext{
+        .state = state,
+        .sampleRate = sample_rate,
+        .projectTimeSamples = project_time_samples,
+        .systemTime = system_time,
+        .continousTimeSamples = continous_time_samples,
+        .projectTimeMusic = project_time_music,
+        .barPositionMusic = bar_position_music,
+        .cycleStartMusic = cycle_start_music,
+        .cycleEndMusic = cycle_end_music,
+        .tempo = tempo,
+        .timeSigNumerator = time_sig_numerator,
+        .timeSigDenominator = time_sig_denominator,
+        .chord = chord,
+        .smpteOffsetSubframes = smpte_offset_subframes,
+        .frameRate = frame_rate,
+        .samplesToNextClock = samples_to_next_clock};
+}
+
+size_t ShmProcessInputs::size_for(
+    const ShmProcessDataCapacity& capacity) noexcept {
+    return sizeof(ShmProcessInputs) + regions_size_for(capacity);
+}
+
+void ShmProcessInputs::init(const ShmProcessDataCapacity& capacity) noexcept {
+    has_process_context = false;
+    parameter_changes_in_shm = false;
+    events_in_shm = false;
+
+    parameter_changes().init(capacity.parameter_queues,
+                             capacity.parameter_points);
+    events().init(capacity.events);
+}
+
+size_t ShmProcessInputs::size() const noexcept {
+    return sizeof(ShmProcessInputs) + parameter_changes().size() +
+           events().size();
+}
+
+ShmParameterChanges& ShmProcessInputs::parameter_changes() noexcept {
+    return *reinterpret_cast<ShmParameterChanges*>(this + 1);
+}
+
+const ShmParameterChanges& ShmProcessInputs::parameter_changes()
+    const noexcept {
+    return *reinterpret_cast<const ShmParameterChanges*>(this + 1);
+}
+
+ShmEventList& ShmProcessInputs::events() noexcept {
+    return events_after(parameter_changes());
+}
+
+const ShmEventList& ShmProcessInputs::events() const noexcept {
+    return events_after(parameter_changes());
+}
+
+size_t ShmProcessOutputs::size_for(
+    const ShmProcessDataCapacity& capacity) noexcept {
+    return sizeof(ShmProcessOutputs) + regions_size_for(capacity);
+}
+
+void ShmProcessOutputs::init(const ShmProcessDataCapacity& capacity) noexcept {
+    parameter_changes().init(capacity.parameter_queues,
+                             capacity.parameter_points);
+    events().init(capacity.events);
+}
+
+size_t ShmProcessOutputs::size() const noexcept {
+    return sizeof(ShmProcessOutputs) + parameter_changes().size() +
+           events().size();
+}
+
+ShmParameterChanges& ShmProcessOutputs::parameter_changes() noexcept {
+    return *reinterpret_cast<ShmParameterChanges*>(this + 1);
+}
+
+const ShmParameterChanges& ShmProcessOutputs::parameter_changes()
+    const noexcept {
+    return *reinterpret_cast<const ShmParameterChanges*>(this + 1);
+}
+
+ShmEventList& ShmProcessOutputs::events() noexcept {
+    return events_after(parameter_changes());
+}
+
+const ShmEventList& ShmProcessOutputs::events() const noexcept {
+    return events_after(parameter_changes());
+}
+
+ShmParamValueQueueView::ShmParamValueQueueView() noexcept {FUNKNOWN_CTOR}
+
+ShmParamValueQueueView::~ShmParamValueQueueView() noexcept {
+    FUNKNOWN_DTOR
+}
+
+void ShmParamValueQueueView::set_queue(ShmParameterChanges& region,
+                                       uint32 queue_index) noexcept {
+    this->region = &region;
+    this->queue_index = queue_index;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdelete-non-virtual-dtor"
+IMPLEMENT_FUNKNOWN_METHODS(ShmParamValueQueueView,
+                           Steinberg::Vst::IParamValueQueue,
+                           Steinberg::Vst::IParamValueQueue::iid)
+#pragma GCC diagnostic pop
+
+Steinberg::Vst::ParamID PLUGIN_API ShmParamValueQueueView::getParameterId() {
+    return region->queues()[queue_index].parameter_id;
+}
+
+int32 PLUGIN_API ShmParamValueQueueView::getPointCount() {
+    return static_cast<int32>(region->queues()[queue_index].num_points);
+}
+
+tresult PLUGIN_API
+ShmParamValueQueueView::getPoint(int32 index,
+                                 int32& sampleOffset /*out*/,
+                                 Steinberg::Vst::ParamValue& value /*out*/) {
+    const ShmParamValueQueueInfo& queue = region->queues()[queue_index];
+    if (index < 0 || static_cast<uint32>(index) >= queue.num_points) {
+        return Steinberg::kInvalidArgument;
+    }
+
+    // Input queues, and output queues the plugin filled in one go, are stored
+    // contiguously. Otherwise we'll need to look for the point.
+    const ShmParamValuePoint* point = nullptr;
+    if (queue.last_point - queue.first_point + 1 == queue.num_points) {
+        point = &region->points()[queue.first_point + index];
+    } else {
+        int32 current_index = 0;
+        for (uint32 i = queue.first_point; i <= queue.last_point; i++) {
+            if (region->points()[i].queue_index == queue_index &&
+                current_index++ == index) {
+                point = &region->points()[i];
+                break;
+            }
+        }
+    }
+
+    assert(point);
+    sampleOffset = point->sample_offset;
+    value = point->value;
+
+    return Steinberg::kResultOk;
+}
+
+tresult PLUGIN_API
+ShmParamValueQueueView::addPoint(int32 sampleOffset,
+                                 Steinberg::Vst::ParamValue value,
+                                 int32& index /*out*/) {
+    if (region->num_points >= region->point_capacity) {
+        return Steinberg::kOutOfMemory;
+    }
+
+    const uint32 point_index = region->num_points++;
+    region->points()[point_index] =
+        ShmParamValuePoint{.queue_index = queue_index,
+                           .sample_offset = sampleOffset,
+                           .value = value};
+
+    ShmParamValueQueueInfo& queue = region->queues()[queue_index];
+    if (queue.num_points == 0) {
+        queue.first_point = point_index;
+    }
+    queue.last_point = point_index;
+    index = static_cast<int32>(queue.num_points++);
+
+    return Steinberg::kResultOk;
+}
+
+ShmParameterChangesView::ShmParameterChangesView(ShmParameterChanges& region)
+    : region(region), queue_views(region.queue_capacity) {
+    FUNKNOWN_CTOR
+
+    for (uint32 queue_index = 0; queue_index < region.queue_capacity;
+         queue_index++) {
+        queue_views[queue_index].set_queue(region, queue_index);
+    }
+}
+
+ShmParameterChangesView::~ShmParameterChangesView() noexcept {FUNKNOWN_DTOR}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdelete-non-virtual-dtor"
+IMPLEMENT_FUNKNOWN_METHODS(ShmParameterChangesView,
+                           Steinberg::Vst::IParameterChanges,
+                           Steinberg::Vst::IParameterChanges::iid)
+#pragma GCC diagnostic pop
+
+int32 PLUGIN_API ShmParameterChangesView::getParameterCount() {
+    return static_cast<int32>(region.num_queues);
+}
+
+Steinberg::Vst::IParamValueQueue* PLUGIN_API
+ShmParameterChangesView::getParameterData(int32 index) {
+    if (index >= 0 && static_cast<uint32>(index) < region.num_queues) {
+        return &queue_views[index];
+    } else {
+        return nullptr;
+    }
+}
+
+Steinberg::Vst::IParamValueQueue* PLUGIN_API
+ShmParameterChangesView::addParameterData(const Steinberg::Vst::ParamID& id,
+                                          int32& index /*out*/) {
+    // Like the SDK's implementation, we'll return the existing queue if the
+    // plugin adds the same parameter twice
+    for (uint32 queue_index = 0; queue_index < region.num_queues;
+         queue_index++) {
+        if (region.queues()[queue_index].parameter_id == id) {
+            index = static_cast<int32>(queue_index);
+            return &queue_views[queue_index];
+        }
+    }
+
+    if (region.num_queues >= region.queue_capacity) {
+        return nullptr;
+    }
+
+    const uint32 queue_index = region.num_queues++;
+    region.queues()[queue_index] = ShmParamValueQueueInfo{
+        .parameter_id = id, .num_points = 0, .first_point = 0, .last_point = 0};
+    index = static_cast<int32>(queue_index);
+
+    return &queue_views[queue_index];
+}
+
+ShmEventListView::ShmEventListView(ShmEventList& region) noexcept
+    : region(region) {
+    FUNKNOWN_CTOR
+}
+
+ShmEventListView::~ShmEventListView() noexcept {FUNKNOWN_DTOR}
+
+void ShmEventListView::set_overflow_events(
+    YaEventList* overflow_events) noexcept {
+    this->overflow_events = overflow_events;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdelete-non-virtual-dtor"
+IMPLEMENT_FUNKNOWN_METHODS(ShmEventListView,
+                           Steinberg::Vst::IEventList,
+                           Steinberg::Vst::IEventList::iid)
+#pragma GCC diagnostic pop
+
+int32 PLUGIN_API ShmEventListView::getEventCount() {
+    const int32 num_overflow_events =
+        overflow_events ? overflow_events->getEventCount() : 0;
+
+    return static_cast<int32>(region.num_events) + num_overflow_events;
+}
+
+tresult PLUGIN_API
+ShmEventListView::getEvent(int32 index, Steinberg::Vst::Event& e /*out*/) {
+    if (index < 0) {
+        return Steinberg::kInvalidArgument;
+    }
+
+    // The overflow events are always added after the events in the region,
+    // see `addEvent()`
+    if (static_cast<uint32>(index) < region.num_events) {
+        e = region.events()[index].get();
+
+        return Steinberg::kResultOk;
+    } else if (overflow_events) {
+        return overflow_events->getEvent(
+            index - static_cast<int32>(region.num_events), e);
+    } else {
+        return Steinberg::kInvalidArgument;
+    }
+}
+
+tresult PLUGIN_API ShmEventListView::addEvent(Steinberg::Vst::Event& e /*in*/) {
+    // Events containing pointers, and any events added after the region has
+    // filled up, will be sent back in the serialized response instead. After
+    // that we'll keep adding events to the overflow list so the host receives
+    // them in the same order the plugin added them in.
+    const bool has_overflowed =
+        overflow_events && overflow_events->getEventCount() > 0;
+    if (!has_overflowed && ShmEvent::is_supported(e) &&
+        region.num_events < region.event_capacity) {
+        region.events()[region.num_events++].set(e);
+
+        return Steinberg::kResultOk;
+    } else if (overflow_events) {
+        return overflow_events->addEvent(e);
+    } else {
+        return Steinberg::kResultFalse;
+    }
+}
+
+ShmProcessDataViews::ShmProcessDataViews(ShmProcessInputs& inputs,
+                                         ShmProcessOutputs& outputs)
+    : inputs(inputs),
+      outputs(outputs),
+      input_parameter_changes(inputs.parameter_changes()),
+      input_events(inputs.events()),
+      output_parameter_changes(outputs.parameter_changes()),
+      output_events(outputs.events()),
+      process_context() {}
+
+void ShmProcessDataViews::apply(
+    Steinberg::Vst::ProcessData& reconstructed_process_data,
+    YaProcessData& data) {
+    if (inputs.parameter_changes_in_shm) {
+        reconstructed_process_data.inputParameterChanges =
+            &input_parameter_changes;
+    }
+
+    // `YaProcessData::input_events` still indicates whether the host passed an
+    // event list or not
+    if (inputs.events_in_shm && reconstructed_process_data.inputEvents) {
+        reconstructed_process_data.inputEvents = &input_events;
+    }
+
+    if (inputs.has_process_context) {
+        process_context = inputs.process_context.get();
+        reconstructed_process_data.processContext = &process_context;
+    }
+
+    // These outputs will only be set if the host supports them
+    if (reconstructed_process_data.outputParameterChanges) {
+        outputs.parameter_changes().clear();
+        reconstructed_process_data.outputParameterChanges =
+            &output_parameter_changes;
+    }
+
+    if (reconstructed_process_data.outputEvents) {
+        assert(data.output_events);
+
+        outputs.events().clear();
+        output_events.set_overflow_events(&*data.output_events);
+        reconstructed_process_data.outputEvents = &output_events;
+    }
+}
@@ -0,0 +1,538 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <type_traits>
+#include <vector>
+
+#include <pluginterfaces/vst/ivstaudioprocessor.h>
+#include <pluginterfaces/vst/ivstevents.h>
+#include <pluginterfaces/vst/ivstparameterchanges.h>
+#include <pluginterfaces/vst/ivstprocesscontext.h>
+
+#include "base.h"
+#include "event-list.h"
+#include "process-data.h"
+
+// This header provides fixed-layout versions of the parameter changes, events
+// and process context from `ProcessData` that can be stored directly in the
+// request and response areas of an `AudioShmBuffer` when the
+// `audio_futex_handshake` option is enabled, along with `IParameterChanges` and
+// `IEventList` implementations that read from and write to that memory
+// directly. All of the structs defined here have the same layout on 32-bit and
+// 64-bit platforms so they can also be used with the bitbridge.
+
+/**
+ * The maximum number of parameters that can have changes in a single
+ * `ShmParameterChanges` region. The regions are sized based on the plugin's
+ * parameter count, up to this limit. The VST3 SDK's own `ParameterChanges`
+ * implementation also has a fixed capacity and returns a null pointer from
+ * `addParameterData()` when it's full, so we'll do the same thing.
+ */
+constexpr uint32 max_shm_parameter_queues = 1024;
+/**
+ * The number of parameter queues we'll reserve space for when we don't know
+ * how many parameters the plugin has. This happens when the plugin's edit
+ * controller is a separate object.
+ */
+constexpr uint32 default_shm_parameter_queues = 128;
+/**
+ * The number of points we'll reserve space for per parameter queue. These are
+ * shared between all queues in a region, so a single parameter can still have
+ * more points than this.
+ */
+constexpr uint32 shm_points_per_parameter_queue = 8;
+/**
+ * The number of events we'll reserve space for per event bus in a
+ * `ShmEventList` region, up to `max_shm_events`. Plugins without any event
+ * busses don't get an event region at all.
+ */
+constexpr uint32 shm_events_per_bus = 256;
+/**
+ * The maximum number of events in a single `ShmEventList` region.
+ */
+constexpr uint32 max_shm_events = 1024;
+
+/**
+ * The capacities of the parameter changes and event regions that follow a
+ * `ShmProcessInputs` or `ShmProcessOutputs` header. These are chosen by the
+ * Wine plugin host when it sets up the shared audio buffers, and they're
+ * stored in the regions themselves so the native plugin can simply read them
+ * back.
+ */
+struct ShmProcessDataCapacity {
+    uint32 parameter_queues;
+    uint32 parameter_points;
+    uint32 events;
+};
+
+/**
+ * A single point in a parameter's value queue.
+ */
+struct alignas(8) ShmParamValuePoint {
+    /**
+     * The index of the queue in `ShmParameterChanges::queues` this point
+     * belongs to. Plugins can add points to their output queues in any order,
+     * so the points for a single queue are not necessarily stored contiguously.
+     */
+    uint32 queue_index;
+    int32 sample_offset;
+    Steinberg::Vst::ParamValue value;
+};
+
+/**
+ * Information about a parameter's value queue. The points are stored in
+ * `ShmParameterChanges::points`.
+ */
+struct ShmParamValueQueueInfo {
+    Steinberg::Vst::ParamID parameter_id;
+    uint32 num_points;
+    /**
+     * The index of this queue's first point in `ShmParameterChanges::points`.
+     */
+    uint32 first_point;
+    /**
+     * The index of this queue's last point in `ShmParameterChanges::points`.
+     * If `last_point - first_point + 1 == num_points`, then all of this queue's
+     * points are stored contiguously and they can be indexed directly. This
+     * is always the case for input parameter changes.
+     */
+    uint32 last_point;
+};
+
+/**
+ * A fixed-layout, capacity-bounded alternative to `YaParameterChanges`. This
+ * struct is only the region's header. It's followed by `queue_capacity`
+ * `ShmParamValueQueueInfo` objects and then by `point_capacity`
+ * `ShmParamValuePoint` objects, so it can only be used in place.
+ */
+struct alignas(8) ShmParameterChanges {
+    /**
+     * The size in bytes of a region with these capacities, including the
+     * header.
+     */
+    static size_t size_for(uint32 queue_capacity,
+                           uint32 point_capacity) noexcept;
+
+    /**
+     * Set this region's capacities and clear it. This is done by the Wine
+     * plugin host when it sets up the shared audio buffers.
+     */
+    void init(uint32 queue_capacity, uint32 point_capacity) noexcept;
+
+    /**
+     * The size in bytes of this region, including the header.
+     */
+    size_t size() const noexcept;
+
+    ShmParamValueQueueInfo* queues() noexcept;
+    const ShmParamValueQueueInfo* queues() const noexcept;
+    ShmParamValuePoint* points() noexcept;
+    const ShmParamValuePoint* points() const noexcept;
+
+    /**
+     * Remove all parameter changes.
+     */
+    void clear() noexcept;
+
+    /**
+     * Copy the parameter changes from the host into this region. Returns false
+     * without copying anything if they don't fit, in which case they should be
+     * sent using `YaParameterChanges` instead.
+     */
+    bool repopulate(Steinberg::Vst::IParameterChanges& original_queues);
+
+    /**
+     * Write the parameter changes output by the plugin back to the output
+     * parameter changes object on the `ProcessData` object provided by the
+     * host.
+     */
+    void write_back_outputs(
+        Steinberg::Vst::IParameterChanges& output_queues) const;
+
+    uint32 num_queues;
+    uint32 num_points;
+    uint32 queue_capacity;
+    uint32 point_capacity;
+};
+
+/**
+ * A fixed-layout version of `Event`. `Event` itself can't be stored in shared
+ * memory as is because its layout differs between 32-bit and 64-bit platforms,
+ * and because some event types contain pointers. Only events without pointers
+ * can be stored this way. The other event types are sent using `YaEventList`
+ * instead.
+ */
+struct alignas(8) ShmEvent {
+    /**
+     * Whether `event` can be stored in a `ShmEvent`.
+     */
+    static bool is_supported(const Steinberg::Vst::Event& event) noexcept;
+
+    /**
+     * Copy an event into this object. The event should be supported according
+     * to `ShmEvent::is_supported()`.
+     */
+    void set(const Steinberg::Vst::Event& event) noexcept;
+
+    /**
+     * Reconstruct the original `Event`.
+     */
+    Steinberg::Vst::Event get() const noexcept;
+
+    // These fields directly reflect those from `Event`
+    int32 bus_index;
+    int32 sample_offset;
+    Steinberg::Vst::TQuarterNotes ppq_position;
+    uint16 flags;
+    uint16 type;
+    uint32 padding;
+
+    union {
+        Steinberg::Vst::NoteOnEvent note_on;
+        Steinberg::Vst::NoteOffEvent note_off;
+        Steinberg::Vst::PolyPressureEvent poly_pressure;
+        Steinberg::Vst::NoteExpressionValueEvent note_expression_value;
+        Steinberg::Vst::LegacyMIDICCOutEvent midi_cc_out;
+    };
+};
+
+/**
+ * A fixed-layout, capacity-bounded alternative to `YaEventList`. Like
+ * `ShmParameterChanges`, this struct is only the region's header and it's
+ * followed by `event_capacity` `ShmEvent` objects.
+ */
+struct alignas(8) ShmEventList {
+    /**
+     * The size in bytes of a region with this capacity, including the header.
+     */
+    static size_t size_for(uint32 event_capacity) noexcept;
+
+    /**
+     * Set this region's capacity and clear it.
+     */
+    void init(uint32 event_capacity) noexcept;
+
+    /**
+     * The size in bytes of this region, including the header.
+     */
+    size_t size() const noexcept;
+
+    ShmEvent* events() noexcept;
+    const ShmEvent* events() const noexcept;
+
+    /**
+     * Remove all events.
+     */
+    void clear() noexcept;
+
+    /**
+     * Copy the events from the host into this region. Returns false without
+     * copying anything if they don't fit or if the list contains events that
+     * can't be stored in a `ShmEvent`, in which case they should be sent using
+     * `YaEventList` instead.
+     */
+    bool repopulate(Steinberg::Vst::IEventList& event_list);
+
+    /**
+     * Write the events output by the plugin back to the output events list on
+     * the `ProcessData` object provided by the host. Events the Wine plugin
+     * host could not store in this region will have been sent in
+     * `overflow_events` instead. `ShmEventListView` only starts adding events
+     * to that list once an event did not fit in this region, so appending
+     * those events after the ones stored here preserves the order the plugin
+     * added them in.
+     */
+    void write_back_outputs(Steinberg::Vst::IEventList& output_events,
+                            YaEventList& overflow_events) const;
+
+    uint32 num_events;
+    uint32 event_capacity;
+};
+
+/**
+ * A fixed-layout version of `ProcessContext`. The regular struct has a
+ * different layout on 32-bit platforms because of the alignment of its
+ * `double` fields, so we'll store all 64-bit fields first.
+ */
+struct alignas(8) ShmProcessContext {
+    /**
+     * Copy the host's process context into this object.
+     */
+    void set(const Steinberg::Vst::ProcessContext& context) noexcept;
+
+    /**
+     * Reconstruct the original `ProcessContext`.
+     */
+    Steinberg::Vst::ProcessContext get() const noexcept;
+
+    double sample_rate;
+    Steinberg::Vst::TSamples project_time_samples;
+    int64 system_time;
+    Steinberg::Vst::TSamples continous_time_samples;
+    Steinberg::Vst::TQuarterNotes project_time_music;
+    Steinberg::Vst::TQuarterNotes bar_position_music;
+    Steinberg::Vst::TQuarterNotes cycle_start_music;
+    Steinberg::Vst::TQuarterNotes cycle_end_music;
+    double tempo;
+
+    uint32 state;
+    int32 time_sig_numerator;
+    int32 time_sig_denominator;
+    Steinberg::Vst::Chord chord;
+    int32 smpte_offset_subframes;
+    Steinberg::Vst::FrameRate frame_rate;
+    int32 samples_to_next_clock;
+};
+
+/**
+ * The part of the request area in an `AudioShmBuffer` that comes before the
+ * serialized `YaAudioProcessor::Process` object when using the futex
+ * handshake. The native plugin will try to store the input parameter changes,
+ * events and the process context here instead of in `YaProcessData`. The flags
+ * indicate which of these have been stored here. If a flag is not set, then
+ * the corresponding data is sent in `YaProcessData` as usual.
+ *
+ * This header is followed by a `ShmParameterChanges` region and a
+ * `ShmEventList` region, and the serialized object starts at `size()` bytes
+ * from the start of the request area.
+ */
+struct alignas(64) ShmProcessInputs {
+    /**
+     * The size in bytes of this header and the regions that follow it.
+     */
+    static size_t size_for(const ShmProcessDataCapacity& capacity) noexcept;
+
+    /**
+     * Initialize the regions following this header with these capacities.
+     * This should be called by the Wine plugin host before it sends the shared
+     * audio buffers' configuration to the native plugin.
+     */
+    void init(const ShmProcessDataCapacity& capacity) noexcept;
+
+    /**
+     * The size in bytes of this header and the regions that follow it.
+     */
+    size_t size() const noexcept;
+
+    ShmParameterChanges& parameter_changes() noexcept;
+    const ShmParameterChanges& parameter_changes() const noexcept;
+    ShmEventList& events() noexcept;
+    const ShmEventList& events() const noexcept;
+
+    /**
+     * Set if the host provided a process context, which is then stored in
+     * `process_context`. `YaProcessData::process_context` will be empty in that
+     * case.
+     */
+    uint8 has_process_context;
+    /**
+     * Set if the input parameter changes are stored in `parameter_changes`
+     * instead of in `YaProcessData::input_parameter_changes`.
+     */
+    uint8 parameter_changes_in_shm;
+    /**
+     * Set if the input events are stored in `events` instead of in
+     * `YaProcessData::input_events`. That field will still be an empty event
+     * list to indicate that the host passed an event list to the plugin.
+     */
+    uint8 events_in_shm;
+
+    ShmProcessContext process_context;
+};
+
+/**
+ * The part of the response area in an `AudioShmBuffer` that comes before the
+ * serialized `YaAudioProcessor::ProcessResponse` object when using the futex
+ * handshake. The Wine plugin host lets the plugin write its output parameter
+ * changes and events directly to the `ShmParameterChanges` and `ShmEventList`
+ * regions following this header, if the host supports them.
+ */
+struct alignas(64) ShmProcessOutputs {
+    /**
+     * The size in bytes of this header and the regions that follow it.
+     */
+    static size_t size_for(const ShmProcessDataCapacity& capacity) noexcept;
+
+    /**
+     * Initialize the regions following this header with these capacities.
+     */
+    void init(const ShmProcessDataCapacity& capacity) noexcept;
+
+    /**
+     * The size in bytes of this header and the regions that follow it.
+     */
+    size_t size() const noexcept;
+
+    ShmParameterChanges& parameter_changes() noexcept;
+    const ShmParameterChanges& parameter_changes() const noexcept;
+    ShmEventList& events() noexcept;
+    const ShmEventList& events() const noexcept;
+};
+
+static_assert(std::is_trivially_copyable_v<ShmProcessInputs> &&
+              std::is_trivially_copyable_v<ShmProcessOutputs>);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+
+/**
+ * An `IParamValueQueue` view over a single queue in a `ShmParameterChanges`
+ * region. Used in `ShmParameterChangesView`.
+ */
+class ShmParamValueQueueView : public Steinberg::Vst::IParamValueQueue {
+   public:
+    ShmParamValueQueueView() noexcept;
+
+    /**
+     * Point this view to a queue in a `ShmParameterChanges` region.
+     */
+    void set_queue(ShmParameterChanges& region, uint32 queue_index) noexcept;
+
+    ~ShmParamValueQueueView() noexcept;
+
+    DECLARE_FUNKNOWN_METHODS
+
+    // From `IParamValueQueue`
+    Steinberg::Vst::ParamID PLUGIN_API getParameterId() override;
+    int32 PLUGIN_API getPointCount() override;
+    tresult PLUGIN_API
+    getPoint(int32 index,
+             int32& sampleOffset /*out*/,
+             Steinberg::Vst::ParamValue& value /*out*/) override;
+    tresult PLUGIN_API addPoint(int32 sampleOffset,
+                                Steinberg::Vst::ParamValue value,
+                                int32& index /*out*/) override;
+
+   private:
+    ShmParameterChanges* region = nullptr;
+    uint32 queue_index = 0;
+};
+
+/**
+ * An `IParameterChanges` view over a `ShmParameterChanges` region. This is
+ * what we pass to the plugin on the Wine plugin host side when the parameter
+ * changes are stored in shared memory.
+ */
+class ShmParameterChangesView : public Steinberg::Vst::IParameterChanges {
+   public:
+    /**
+     * Create a view over a region. The region should stay alive for as long as
+     * this view is being used.
+     */
+    ShmParameterChangesView(ShmParameterChanges& region);
+
+    ~ShmParameterChangesView() noexcept;
+
+    DECLARE_FUNKNOWN_METHODS
+
+    // From `IParameterChanges`
+    int32 PLUGIN_API getParameterCount() override;
+    Steinberg::Vst::IParamValueQueue* PLUGIN_API
+    getParameterData(int32 index) override;
+    Steinberg::Vst::IParamValueQueue* PLUGIN_API
+    addParameterData(const Steinberg::Vst::ParamID& id,
+                     int32& index /*out*/) override;
+
+   private:
+    ShmParameterChanges& region;
+
+    /**
+     * One queue view for every queue the region has room for, preallocated so
+     * we never have to allocate during audio processing.
+     */
+    std::vector<ShmParamValueQueueView> queue_views;
+};
+
+/**
+ * An `IEventList` view over a `ShmEventList` region. This is what we pass to
+ * the plugin on the Wine plugin host side when the events are stored in shared
+ * memory.
+ */
+class ShmEventListView : public Steinberg::Vst::IEventList {
+   public:
+    /**
+     * Create a view over a region. The region should stay alive for as long as
+     * this view is being used.
+     */
+    ShmEventListView(ShmEventList& region) noexcept;
+
+    ~ShmEventListView() noexcept;
+
+    /**
+     * Set the event list events that can't be stored in the region will be
+     * added to. This includes both events that can't be represented as a
+     * `ShmEvent` and any events added after the region has filled up. Once an
+     * event has been added to this list, all following events will be added
+     * to it as well so the order of the events is preserved. This should be
+     * set for output event lists. Without it, those events will be rejected.
+     */
+    void set_overflow_events(YaEventList* overflow_events) noexcept;
+
+    DECLARE_FUNKNOWN_METHODS
+
+    // From `IEventList`
+    virtual int32 PLUGIN_API getEventCount() override;
+    virtual tresult PLUGIN_API
+    getEvent(int32 index, Steinberg::Vst::Event& e /*out*/) override;
+    virtual tresult PLUGIN_API
+    addEvent(Steinberg::Vst::Event& e /*in*/) override;
+
+   private:
+    ShmEventList& region;
+    YaEventList* overflow_events = nullptr;
+};
+
+#pragma GCC diagnostic pop
+
+/**
+ * The views over the `ShmProcessInputs` and `ShmProcessOutputs` stored in an
+ * `AudioShmBuffer`'s request and response areas, used on the Wine plugin host
+ * side. These are created once when the futex handshake handler starts, and
+ * they are then reused for every processing cycle.
+ */
+class ShmProcessDataViews {
+   public:
+    ShmProcessDataViews(ShmProcessInputs& inputs, ShmProcessOutputs& outputs);
+
+    /**
+     * Point the parameter changes, events, and process context pointers in the
+     * `ProcessData` object reconstructed by `YaProcessData::reconstruct()` to
+     * these views wherever the native plugin stored that data in shared
+     * memory. The output parameter changes and events will also be written
+     * directly to shared memory if the host supports them. Output events that
+     * can't be stored there will be added to `data.output_events` instead.
+     */
+    void apply(Steinberg::Vst::ProcessData& reconstructed_process_data,
+               YaProcessData& data);
+
+   private:
+    ShmProcessInputs& inputs;
+    ShmProcessOutputs& outputs;
+
+    ShmParameterChangesView input_parameter_changes;
+    ShmEventListView input_events;
+    ShmParameterChangesView output_parameter_changes;
+    ShmEventListView output_events;
+
+    /**
+     * `ProcessContext` has a different layout on 32-bit platforms, so we can't
+     * point the plugin directly at `inputs.process_context`.
+     */
+    Steinberg::Vst::ProcessContext process_context;
+};
@@ -17,6 +17,7 @@
 #include "process-data.h"
 
 #include "src/common/utils.h"
+#include "process-data-shm.h"
 
 YaProcessData::YaProcessData() noexcept
     // This response object acts as an optimization. It stores pointers to the
@@ -36,15 +37,30 @@ YaProcessData::YaProcessData() noexcept
       reconstructed_process_data() {}
 
 void YaProcessData::repopulate(const Steinberg::Vst::ProcessData& process_data,
-                               AudioShmBuffer& shared_audio_buffers) {
+                               AudioShmBuffer& shared_audio_buffers,
+                               ShmProcessInputs* shm_inputs) {
     // In this function and in every function we call, we should be careful to
     // not use `push_back`/`emplace_back` anywhere. Resizing vectors and
     // modifying them in place performs much better because that avoids
     // destroying and creating objects most of the time.
     process_mode = process_data.processMode;
-    symbolic_sample_size = process_data.symbolicSampleSize;
     num_samples = process_data.numSamples;
 
+    // If the host processes double precision audio but the plugin only supports
+    // single precision audio, then the shared memory buffers will contain
+    // single precision samples. In that case we'll convert the audio while
+    // copying it, and the plugin will process single precision audio.
+    const bool host_double_precision =
+        process_data.symbolicSampleSize == Steinberg::Vst::kSample64;
+    if (host_double_precision &&
+        !shared_audio_buffers.config.double_precision) {
+        symbolic_sample_size = Steinberg::Vst::kSample32;
+    } else {
+        symbolic_sample_size = process_data.symbolicSampleSize;
+    }
+    const bool double_precision_buffers =
+        symbolic_sample_size == Steinberg::Vst::kSample64;
+
     // The actual audio is stored in an accompanying `AudioShmBuffer` object, so
     // these inputs and outputs objects are only used to serialize metadata
     // about the input and output audio bus buffers
@@ -59,18 +75,35 @@ void YaProcessData::repopulate(const Steinberg::Vst::ProcessData& process_data,
         inputs[bus].silenceFlags = process_data.inputs[bus].silenceFlags;
 
         // We copy the actual input audio for every bus to the shared memory
-        // object
+        // object. Channels the host marked as silent don't need to be copied,
+        // we'll just clear the channel in the shared memory object instead.
         for (int channel = 0; channel < inputs[bus].numChannels; channel++) {
-            if (process_data.symbolicSampleSize == Steinberg::Vst::kSample64) {
-                std::copy_n(process_data.inputs[bus].channelBuffers64[channel],
-                            process_data.numSamples,
-                            shared_audio_buffers.input_channel_ptr<double>(
-                                bus, channel));
+            const bool channel_is_silent =
+                channel < 64 && (inputs[bus].silenceFlags &
+                                 (static_cast<uint64>(1) << channel));
+            if (channel_is_silent) {
+                if (double_precision_buffers) {
+                    shared_audio_buffers.clear_input_channel<double>(
+                        bus, channel, process_data.numSamples);
+                } else {
+                    shared_audio_buffers.clear_input_channel<float>(
+                        bus, channel, process_data.numSamples);
+                }
+            } else if (host_double_precision) {
+                const double* samples =
+                    process_data.inputs[bus].channelBuffers64[channel];
+                if (double_precision_buffers) {
+                    shared_audio_buffers.write_input_channel<double>(
+                        bus, channel, samples, process_data.numSamples);
+                } else {
+                    shared_audio_buffers.write_input_channel<float>(
+                        bus, channel, samples, process_data.numSamples);
+                }
             } else {
-                std::copy_n(process_data.inputs[bus].channelBuffers32[channel],
-                            process_data.numSamples,
-                            shared_audio_buffers.input_channel_ptr<float>(
-                                bus, channel));
+                shared_audio_buffers.write_input_channel<float>(
+                    bus, channel,
+                    process_data.inputs[bus].channelBuffers32[channel],
+                    process_data.numSamples);
             }
         }
     }
@@ -86,10 +119,32 @@ void YaProcessData::repopulate(const Steinberg::Vst::ProcessData& process_data,
         outputs[bus].silenceFlags = process_data.outputs[bus].silenceFlags;
     }
 
+    repopulate_parameters_and_events(process_data, shm_inputs);
+}
+
+void YaProcessData::repopulate_parameters_and_events(
+    const Steinberg::Vst::ProcessData& process_data,
+    ShmProcessInputs* shm_inputs) {
     // Even though `ProcessData::inputParamterChanges` is mandatory, the VST3
-    // validator will pass a null pointer here
+    // validator will pass a null pointer here. When using the futex handshake
+    // we'll try to write the parameter changes, events and process context
+    // directly to shared memory first, and we'll only serialize them as part
+    // of this object if they don't fit there.
+    if (shm_inputs) {
+        shm_inputs->parameter_changes_in_shm = false;
+        shm_inputs->events_in_shm = false;
+        shm_inputs->has_process_context = false;
+    }
+
     if (process_data.inputParameterChanges) {
-        input_parameter_changes.repopulate(*process_data.inputParameterChanges);
+        if (shm_inputs && shm_inputs->parameter_changes().repopulate(
+                              *process_data.inputParameterChanges)) {
+            shm_inputs->parameter_changes_in_shm = true;
+            input_parameter_changes.clear();
+        } else {
+            input_parameter_changes.repopulate(
+                *process_data.inputParameterChanges);
+        }
     } else {
         input_parameter_changes.clear();
     }
@@ -108,7 +163,16 @@ void YaProcessData::repopulate(const Steinberg::Vst::ProcessData& process_data,
         if (!input_events) {
             input_events.emplace();
         }
-        input_events->repopulate(*process_data.inputEvents);
+
+        // The (empty) event list will still be serialized to indicate that the
+        // host passed an event list to the plugin
+        if (shm_inputs &&
+            shm_inputs->events().repopulate(*process_data.inputEvents)) {
+            shm_inputs->events_in_shm = true;
+            input_events->clear();
+        } else {
+            input_events->repopulate(*process_data.inputEvents);
+        }
     } else {
         input_events.reset();
     }
@@ -122,7 +186,11 @@ void YaProcessData::repopulate(const Steinberg::Vst::ProcessData& process_data,
         output_events.reset();
     }
 
-    if (process_data.processContext) {
+    if (process_data.processContext && shm_inputs) {
+        shm_inputs->process_context.set(*process_data.processContext);
+        shm_inputs->has_process_context = true;
+        process_context.reset();
+    } else if (process_data.processContext) {
         process_context.emplace(*process_data.processContext);
     } else {
         process_context.reset();
@@ -200,7 +268,8 @@ YaProcessData::Response& YaProcessData::create_response() noexcept {
 
 void YaProcessData::write_back_outputs(
     Steinberg::Vst::ProcessData& process_data,
-    const AudioShmBuffer& shared_audio_buffers) {
+    const AudioShmBuffer& shared_audio_buffers,
+    const ShmProcessOutputs* shm_outputs) {
     assert(static_cast<int32>(outputs.size()) == process_data.numOutputs);
     for (int bus = 0; bus < process_data.numOutputs; bus++) {
         process_data.outputs[bus].silenceFlags = outputs[bus].silenceFlags;
@@ -211,29 +280,69 @@ void YaProcessData::write_back_outputs(
         //       by the plugin during `YaProcessData::repopulate()`.
         for (int channel = 0; channel < outputs[bus].numChannels; channel++) {
             // We copy the output audio for every bus from the shared memory
-            // object back to the buffer provided by the host
+            // object back to the buffer provided by the host. If the plugin
+            // marked a channel as silent, then we can just clear the host's
+            // buffer instead without having to read from the shared memory
+            // object.
+            const bool channel_is_silent =
+                channel < 64 && (outputs[bus].silenceFlags &
+                                 (static_cast<uint64>(1) << channel));
             if (process_data.symbolicSampleSize == Steinberg::Vst::kSample64) {
-                std::copy_n(
-                    shared_audio_buffers.output_channel_ptr<double>(bus,
-                                                                    channel),
-                    process_data.numSamples,
-                    process_data.outputs[bus].channelBuffers64[channel]);
+                if (channel_is_silent) {
+                    std::fill_n(
+                        process_data.outputs[bus].channelBuffers64[channel],
+                        process_data.numSamples, 0.0);
+                } else if (symbolic_sample_size == Steinberg::Vst::kSample32) {
+                    // The plugin processed single precision audio, see
+                    // `YaProcessData::repopulate()`
+                    convert_samples(
+                        shared_audio_buffers.output_channel_ptr<float>(bus,
+                                                                       channel),
+                        process_data.numSamples,
+                        process_data.outputs[bus].channelBuffers64[channel]);
+                } else {
+                    std::copy_n(
+                        shared_audio_buffers.output_channel_ptr<double>(
+                            bus, channel),
+                        process_data.numSamples,
+                        process_data.outputs[bus].channelBuffers64[channel]);
+                }
             } else {
-                std::copy_n(
-                    shared_audio_buffers.output_channel_ptr<float>(bus,
-                                                                   channel),
-                    process_data.numSamples,
-                    process_data.outputs[bus].channelBuffers32[channel]);
+                if (channel_is_silent) {
+                    std::fill_n(
+                        process_data.outputs[bus].channelBuffers32[channel],
+                        process_data.numSamples, 0.0f);
+                } else {
+                    std::copy_n(
+                        shared_audio_buffers.output_channel_ptr<float>(bus,
+                                                                       channel),
+                        process_data.numSamples,
+                        process_data.outputs[bus].channelBuffers32[channel]);
+                }
             }
         }
     }
 
+    // When using the futex handshake the plugin will have written its output
+    // parameter changes and events directly to shared memory. Only the events
+    // that could not be stored there will have been sent as part of this
+    // object.
     if (output_parameter_changes && process_data.outputParameterChanges) {
+        if (shm_outputs) {
+            shm_outputs->parameter_changes().write_back_outputs(
+                *process_data.outputParameterChanges);
+        }
+
         output_parameter_changes->write_back_outputs(
             *process_data.outputParameterChanges);
     }
 
     if (output_events && process_data.outputEvents) {
-        output_events->write_back_outputs(*process_data.outputEvents);
+        if (shm_outputs) {
+            shm_outputs->events().write_back_outputs(*process_data.outputEvents,
+                                                   *output_events);
+        } else {
+            output_events->write_back_outputs(*process_data.outputEvents);
+        }
     }
 }
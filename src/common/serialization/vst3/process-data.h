@@ -29,6 +29,10 @@
 
 // This header provides serialization wrappers around `ProcessData`
 
+// These are defined in `process-data-shm.h`, which includes this header
+struct ShmProcessInputs;
+struct ShmProcessOutputs;
+
 /**
  * A serializable wrapper around `ProcessData`. We'll read all information from
  * the host so we can serialize it and provide an equivalent `ProcessData`
@@ -68,9 +72,26 @@ class YaProcessData {
      * `YaProcessData` object and those buffers, but they should be used as a
      * pair. This is a bit ugly, but optimizations sadly never made code
      * prettier.
+     *
+     * When using the futex handshake, `shm_inputs` should point to the
+     * `ShmProcessInputs` at the start of the shared audio buffers' request
+     * area. The input parameter changes, events, and process context will then
+     * be written there instead of to this object whenever they fit.
      */
     void repopulate(const Steinberg::Vst::ProcessData& process_data,
-                    AudioShmBuffer& shared_audio_buffers);
+                    AudioShmBuffer& shared_audio_buffers,
+                    ShmProcessInputs* shm_inputs = nullptr);
+
+    /**
+     * The part of `repopulate()` that copies the parameter changes, events,
+     * and process context. The native plugin calls this again without
+     * `shm_inputs` when a request that was meant for the futex handshake does
+     * not fit in the request area, so it can send that request over the socket
+     * without having to copy the input audio again.
+     */
+    void repopulate_parameters_and_events(
+        const Steinberg::Vst::ProcessData& process_data,
+        ShmProcessInputs* shm_inputs = nullptr);
 
     /**
      * Reconstruct the original `ProcessData` object passed to the constructor
@@ -149,10 +170,14 @@ class YaProcessData {
     /**
      * Write all of this output data back to the host's `ProcessData` object.
      * During this process we'll also write the output audio from the
-     * corresponding shared memory audio buffers back.
+     * corresponding shared memory audio buffers back. When using the futex
+     * handshake, `shm_outputs` should point to the `ShmProcessOutputs` at the
+     * start of the shared audio buffers' response area so the output parameter
+     * changes and events the plugin wrote there are also written back.
      */
     void write_back_outputs(Steinberg::Vst::ProcessData& process_data,
-                            const AudioShmBuffer& shared_audio_buffers);
+                            const AudioShmBuffer& shared_audio_buffers,
+                            const ShmProcessOutputs* shm_outputs = nullptr);
 
     template <typename S>
     void serialize(S& s) {
@@ -16,8 +16,13 @@
 
 #include "utils.h"
 
+#include <alloca.h>
 #include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <xmmintrin.h>
+#include <algorithm>
+#include <vector>
 #include <boost/process/environment.hpp>
 
 namespace bp = boost::process;
@@ -57,6 +62,48 @@ bool set_realtime_priority(bool sched_fifo, int priority) noexcept {
                               &params) == 0;
 }
 
+CpuSet CpuSet::from_cpus(const std::vector<uint32_t>& cpus) noexcept {
+    CpuSet set{};
+    for (const uint32_t cpu : cpus) {
+        if (cpu < capacity) {
+            set.mask[cpu / 64] |= uint64_t(1) << (cpu % 64);
+        }
+    }
+
+    return set;
+}
+
+std::optional<CpuSet> get_cpu_affinity() noexcept {
+    cpu_set_t native_set;
+    CPU_ZERO(&native_set);
+    if (sched_getaffinity(0, sizeof(native_set), &native_set) != 0) {
+        return std::nullopt;
+    }
+
+    CpuSet set{};
+    for (uint32_t cpu = 0; cpu < CpuSet::capacity && cpu < CPU_SETSIZE;
+         cpu++) {
+        if (CPU_ISSET(cpu, &native_set)) {
+            set.mask[cpu / 64] |= uint64_t(1) << (cpu % 64);
+        }
+    }
+
+    return set;
+}
+
+bool set_cpu_affinity(const CpuSet& cpus) noexcept {
+    cpu_set_t native_set;
+    CPU_ZERO(&native_set);
+    for (uint32_t cpu = 0; cpu < CpuSet::capacity && cpu < CPU_SETSIZE;
+         cpu++) {
+        if (cpus.mask[cpu / 64] & (uint64_t(1) << (cpu % 64))) {
+            CPU_SET(cpu, &native_set);
+        }
+    }
+
+    return sched_setaffinity(0, sizeof(native_set), &native_set) == 0;
+}
+
 std::optional<rlim_t> get_rttime_limit() noexcept {
     rlimit limits{};
     if (getrlimit(RLIMIT_RTTIME, &limits) == 0) {
@@ -66,6 +113,72 @@ std::optional<rlim_t> get_rttime_limit() noexcept {
     }
 }
 
+std::optional<rlim_t> get_memlock_limit() noexcept {
+    rlimit limits{};
+    if (getrlimit(RLIMIT_MEMLOCK, &limits) == 0) {
+        return limits.rlim_cur;
+    } else {
+        return std::nullopt;
+    }
+}
+
+MemoryLockResult lock_memory(const void* data, size_t size) {
+    // All of these functions operate on whole pages, so we'll round the region
+    // out to page boundaries first
+    const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start =
+        reinterpret_cast<uintptr_t>(data) & ~(page_size - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(data) + size +
+                           page_size - 1) &
+                          ~(page_size - 1);
+
+    MemoryLockResult result{};
+    result.size = end - start;
+    if (result.size == 0) {
+        result.locked = true;
+        return result;
+    }
+
+    // If this succeeds then the kernel will have faulted in all of these pages
+    // for us. Otherwise we'll touch every page ourselves.
+    void* region = reinterpret_cast<void*>(start);
+    result.locked = mlock(region, result.size) == 0;
+    if (!result.locked) {
+        for (uintptr_t page = start; page < end; page += page_size) {
+            [[maybe_unused]] volatile uint8_t value =
+                *reinterpret_cast<volatile uint8_t*>(page);
+        }
+    }
+
+    std::vector<unsigned char> residency(result.size / page_size);
+    if (mincore(region, result.size, residency.data()) == 0) {
+        for (const unsigned char page_residency : residency) {
+            if (page_residency & 1) {
+                result.resident_bytes += page_size;
+            }
+        }
+    }
+
+    return result;
+}
+
+// The stack frame for this function should be discarded after it returns
+__attribute__((noinline)) MemoryLockResult lock_current_thread_stack(
+    size_t size) {
+    // The memory allocated here will be part of this thread's stack, and
+    // writing to it causes the kernel to map those stack pages. The pages will
+    // stay mapped and locked after this function returns. We'll touch them from
+    // the top down in the same order the stack would grow.
+    volatile uint8_t* stack_area = static_cast<uint8_t*>(alloca(size));
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    for (size_t offset = size; offset > 0;
+         offset -= std::min(offset, page_size)) {
+        stack_area[offset - 1] = 0;
+    }
+
+    return lock_memory(const_cast<uint8_t*>(stack_area), size);
+}
+
 bool is_watchdog_timer_disabled() {
     // This is safe because we're not storing the pointer anywhere and the
     // environment doesn't get modified anywhere
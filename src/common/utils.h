@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <optional>
+#include <vector>
 
 #include <sys/resource.h>
 
@@ -105,6 +108,49 @@ std::optional<int> get_realtime_priority() noexcept;
  */
 bool set_realtime_priority(bool sched_fifo, int priority = 5) noexcept;
 
+/**
+ * A set of CPUs, used to synchronize the CPU affinity of the Wine plugin host's
+ * audio threads with that of the host's audio threads. This covers the first
+ * 1024 CPUs just like glibc's `cpu_set_t`, but it has a fixed layout so it can
+ * be sent to the Wine plugin host, including from and to the bitbridge. Bit
+ * `n % 64` of `mask[n / 64]` is set if CPU `n` is part of the set.
+ */
+struct CpuSet {
+    /**
+     * The number of CPUs that can be stored in a `CpuSet`.
+     */
+    static constexpr uint32_t capacity = 1024;
+
+    std::array<uint64_t, capacity / 64> mask{};
+
+    /**
+     * Create a set containing only the specified CPUs. CPUs outside of
+     * `[0, capacity)` are ignored.
+     */
+    static CpuSet from_cpus(const std::vector<uint32_t>& cpus) noexcept;
+
+    inline bool operator==(const CpuSet&) const noexcept = default;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.container8b(mask);
+    }
+};
+
+/**
+ * Get the CPU affinity of the calling thread. Returns a nullopt if this could
+ * not be determined.
+ */
+std::optional<CpuSet> get_cpu_affinity() noexcept;
+
+/**
+ * Set the CPU affinity of the calling thread.
+ *
+ * @return Whether setting the affinity succeeded. This fails when none of the
+ *   CPUs in the set are available.
+ */
+bool set_cpu_affinity(const CpuSet& cpus) noexcept;
+
 /**
  * Get the (soft) `RTTIME` resource limit, or the amount of time a `SCHED_FIFO`
  * process may spend uninterrupted before being killed by the scheduler. A value
@@ -117,6 +163,62 @@ bool set_realtime_priority(bool sched_fifo, int priority = 5) noexcept;
  */
 std::optional<rlim_t> get_rttime_limit() noexcept;
 
+/**
+ * Get the (soft) `MEMLOCK` resource limit, or the number of bytes a process may
+ * lock into RAM using `mlock()`. A value of `-1`/`RLIM_INFINITY` means that
+ * there is no limit. If there was some error fetching this value, then a
+ * nullopt will be returned.
+ */
+std::optional<rlim_t> get_memlock_limit() noexcept;
+
+/**
+ * The result of pre-faulting and locking a region of memory.
+ *
+ * @see lock_memory
+ */
+struct MemoryLockResult {
+    /**
+     * The size of the region in bytes, rounded out to whole pages.
+     */
+    size_t size = 0;
+    /**
+     * Whether `mlock()` succeeded. If it did not, then the region will still
+     * have been pre-faulted, but the pages may get swapped out later.
+     */
+    bool locked = false;
+    /**
+     * The number of bytes in the region that were resident in RAM after
+     * locking and pre-faulting it, according to `mincore()`.
+     */
+    size_t resident_bytes = 0;
+
+    /**
+     * Whether the entire region has been locked and is resident in RAM.
+     */
+    inline bool succeeded() const noexcept {
+        return locked && resident_bytes == size;
+    }
+};
+
+/**
+ * Pre-fault and lock a region of memory so that accessing it from an audio
+ * thread will never cause a page fault. `mlock()` is best-effort in the same
+ * way `MAP_LOCKED` is, and it will fail when `RLIMIT_MEMLOCK` is too low. We'll
+ * still touch every page in that case, and the result is verified using
+ * `mincore()`.
+ */
+MemoryLockResult lock_memory(const void* data, size_t size);
+
+/**
+ * Pre-fault and lock the `size` bytes of the calling thread's stack that lie
+ * below the current stack frame. This should be called at the start of an
+ * audio thread so that the deeper call stacks during audio processing won't
+ * cause page faults.
+ *
+ * @see lock_memory
+ */
+MemoryLockResult lock_current_thread_stack(size_t size);
+
 /**
  * Returns `true` if `YABRIDGE_NO_WATCHDOG` is set to `1`. In that case we will
  * not check if the Wine plugin host process successfully started, and we'll
@@ -89,6 +89,13 @@
  */
 [[maybe_unused]] constexpr int kVstProcessPrecision32 = 0;
 
+/**
+ * Set in `AEffect::flags` by plugins that implement
+ * `processDoubleReplacing()`. Not part of VeSTige, also glanced from the JUCE
+ * VST2 wrapper linked above.
+ */
+[[maybe_unused]] constexpr int effFlagsCanDoubleReplacing = 1 << 12;
+
 /**
  * Used by VST2 plugins in REAPER to obtain pointers to host-specific functions
  * implemented by REAPER.
@@ -0,0 +1,160 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * An immutable object that can be read from any thread without taking a lock,
+ * and that can be replaced or cleared from other threads. This is used for
+ * caches that are filled in one go and that are read many times, like the
+ * parameter information cache for VST3 plugins.
+ *
+ * Readers only bump a counter while they're accessing the snapshot. Replacing
+ * the snapshot waits until all readers that may still be using the old
+ * snapshot have finished before freeing it, so the callback passed to `read()`
+ * should be short and it should not call back into this object. Readers are
+ * split into two generations so a writer only ever has to wait for the
+ * readers that started before it swapped out the snapshot, even when new reads
+ * keep coming in. Writes should be rare.
+ *
+ * Every write bumps a version number. This can be used together with
+ * `store_if_unchanged()` to make sure that a snapshot that was being built
+ * while the snapshot got cleared does not overwrite the newer state.
+ */
+template <typename T>
+class AtomicSnapshot {
+   public:
+    AtomicSnapshot() noexcept {}
+
+    ~AtomicSnapshot() noexcept { delete current.load(); }
+
+    AtomicSnapshot(const AtomicSnapshot&) = delete;
+    AtomicSnapshot& operator=(const AtomicSnapshot&) = delete;
+
+    /**
+     * Call `callback` with a pointer to the current snapshot, or with a null
+     * pointer if there currently is no snapshot. The pointer is only valid for
+     * the duration of the callback.
+     */
+    template <std::invocable<const T*> F>
+    std::invoke_result_t<F, const T*> read(F&& callback) const {
+        // Registering as a reader has to happen before loading the pointer, see
+        // `replace()`. If a writer flipped the generation in between reading it
+        // and registering, then we'll have to try again.
+        std::atomic_size_t* num_active_readers;
+        while (true) {
+            const uint64_t generation = reader_generation.load();
+            num_active_readers =
+                &num_active_readers_per_generation[generation % 2];
+
+            num_active_readers->fetch_add(1);
+            if (reader_generation.load() == generation) {
+                break;
+            }
+
+            num_active_readers->fetch_sub(1);
+        }
+
+        const ReadGuard guard{*num_active_readers};
+
+        return callback(current.load());
+    }
+
+    /**
+     * The current version number. This changes whenever the snapshot gets
+     * replaced or cleared.
+     */
+    uint64_t version() const noexcept { return current_version.load(); }
+
+    /**
+     * Replace the current snapshot, or clear it when `snapshot` is a null
+     * pointer.
+     */
+    void store(std::unique_ptr<const T> snapshot) {
+        std::lock_guard lock(writer_mutex);
+        replace(std::move(snapshot));
+    }
+
+    /**
+     * Replace the current snapshot, but only if nothing has been written since
+     * `expected_version` was obtained from `version()`.
+     *
+     * @return Whether the snapshot was stored.
+     */
+    bool store_if_unchanged(std::unique_ptr<const T> snapshot,
+                            uint64_t expected_version) {
+        std::lock_guard lock(writer_mutex);
+        if (current_version.load() != expected_version) {
+            return false;
+        }
+
+        replace(std::move(snapshot));
+
+        return true;
+    }
+
+   private:
+    /**
+     * Decrements the reader count, also when the callback throws.
+     */
+    struct ReadGuard {
+        std::atomic_size_t& num_active_readers;
+
+        ~ReadGuard() noexcept { num_active_readers.fetch_sub(1); }
+    };
+
+    /**
+     * Swap out the snapshot and free the old one. Readers register themselves
+     * in the current generation before loading `current`, so any reader that
+     * could still see the old pointer is guaranteed to be counted in that
+     * generation once we've exchanged it. Readers that start after we flip the
+     * generation will see the new pointer, so we don't need to wait for them.
+     * Must be called while holding `writer_mutex`.
+     */
+    void replace(std::unique_ptr<const T> snapshot) {
+        const T* old_snapshot = current.exchange(snapshot.release());
+        current_version.fetch_add(1);
+
+        const uint64_t old_generation = reader_generation.fetch_add(1);
+        std::atomic_size_t& num_old_readers =
+            num_active_readers_per_generation[old_generation % 2];
+        while (num_old_readers.load() > 0) {
+            std::this_thread::yield();
+        }
+
+        delete old_snapshot;
+    }
+
+    std::atomic<const T*> current = nullptr;
+    std::atomic_uint64_t current_version = 0;
+
+    /**
+     * The generation new readers register themselves in. Only the parity is
+     * used to index `num_active_readers_per_generation`.
+     */
+    mutable std::atomic_uint64_t reader_generation = 0;
+    mutable std::array<std::atomic_size_t, 2>
+        num_active_readers_per_generation{};
+    std::mutex writer_mutex;
+};
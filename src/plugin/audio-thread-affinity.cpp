@@ -0,0 +1,55 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "audio-thread-affinity.h"
+
+#include <sched.h>
+
+std::optional<CpuSet> AudioThreadAffinitySync::update(
+    AudioThreadAffinity mode) noexcept {
+    std::optional<CpuSet> new_affinity;
+    switch (mode) {
+        case AudioThreadAffinity::host: {
+            const time_t now = time(nullptr);
+            if (now > last_synchronization +
+                          audio_thread_priority_synchronization_interval) {
+                new_affinity = get_cpu_affinity();
+                last_synchronization = now;
+            }
+        } break;
+        case AudioThreadAffinity::same_core: {
+            // `sched_getcpu()` goes through the vDSO, so this doesn't need a
+            // system call
+            const int cpu = sched_getcpu();
+            if (cpu >= 0 && cpu != last_cpu) {
+                new_affinity =
+                    CpuSet::from_cpus({static_cast<uint32_t>(cpu)});
+                last_cpu = cpu;
+            }
+        } break;
+        default:
+            // With the `cores` setting the Wine plugin host pins its audio
+            // threads by itself
+            break;
+    }
+
+    if (!new_affinity || new_affinity == last_affinity) {
+        return std::nullopt;
+    }
+
+    last_affinity = new_affinity;
+    return new_affinity;
+}
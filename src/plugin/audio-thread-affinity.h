@@ -0,0 +1,69 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <ctime>
+#include <optional>
+
+#include "../common/configuration.h"
+#include "../common/utils.h"
+
+/**
+ * Decides when the CPU affinity of the Wine plugin host's audio thread should
+ * be updated to match the host's audio thread. This is used for the `host` and
+ * `same_core` settings of the `audio_thread_affinity` option. The new affinity
+ * gets sent along with the processing request, and it's only sent when it has
+ * changed since the last time we sent it since setting a thread's affinity may
+ * cause it to be migrated to another core.
+ *
+ * `update()` should only be called from the audio thread.
+ */
+class AudioThreadAffinitySync {
+   public:
+    /**
+     * Check whether the CPU affinity of the Wine plugin host's audio thread
+     * needs to be updated. In `host` mode the host's audio thread's affinity
+     * mask is only queried every
+     * `audio_thread_priority_synchronization_interval` seconds. In `same_core`
+     * mode we'll check which core the calling thread is running on during every
+     * processing cycle since that's very cheap to do.
+     *
+     * @param mode The value of the `audio_thread_affinity` option. This
+     *   function will always return a nullopt for the other modes.
+     *
+     * @return The new affinity the Wine plugin host's audio thread should
+     *   switch to, if it changed.
+     */
+    std::optional<CpuSet> update(AudioThreadAffinity mode) noexcept;
+
+   private:
+    /**
+     * The last affinity we sent to the Wine plugin host.
+     */
+    std::optional<CpuSet> last_affinity;
+
+    /**
+     * The last time we queried the host's audio thread's affinity mask in
+     * `host` mode.
+     */
+    time_t last_synchronization = 0;
+    /**
+     * The core the calling thread was running on during the last processing
+     * cycle in `same_core` mode.
+     */
+    int last_cpu = -1;
+};
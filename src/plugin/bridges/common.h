@@ -25,8 +25,11 @@
 #include <sys/resource.h>
 
 #include "../../common/configuration.h"
+#include "../../common/mutual-recursion.h"
 #include "../../common/utils.h"
+#include "../audio-thread-affinity.h"
 #include "../host-process.h"
+#include "../silence-gate.h"
 
 /**
  * PipeWire uses rtkit, and both set `RLIMIT_RTTIME` to some low value. Normally
@@ -37,6 +40,15 @@
  */
 constexpr int rttime_min_safe_threshold = 30'000'000;
 
+/**
+ * With the `audio_realtime_memory` option enabled, we'll show a warning when
+ * `RLIMIT_MEMLOCK` is below this many bytes. The Wine plugin host process
+ * inherits this limit, and it needs to be able to lock the shared memory audio
+ * buffers and part of the stacks of its audio threads for every plugin instance
+ * it hosts.
+ */
+constexpr rlim_t memlock_min_safe_threshold = 64 << 20;
+
 /**
  * Handles all common operations for hosting plugins such as initializing up the
  * plugin host process, setting up the logger, and logging debug information on
@@ -118,6 +130,58 @@ class PluginBridge {
 
     virtual ~PluginBridge() noexcept {};
 
+    /**
+     * Print how many processing cycles were skipped because of the
+     * `audio_silence_gating` option. This is only printed when the verbosity
+     * level is set to at least `most_events`, and it should be called when the
+     * plugin gets deactivated.
+     */
+    void log_silence_gating_statistics(const SilenceGate& silence_gate) {
+        if (config.audio_silence_gating &&
+            generic_logger.verbosity >= Logger::Verbosity::most_events) {
+            generic_logger.log(
+                "[silence gating] skipped " +
+                std::to_string(silence_gate.num_skipped_cycles()) + " of " +
+                std::to_string(silence_gate.num_cycles()) +
+                " processing cycles");
+        }
+    }
+
+    /**
+     * Print how often the host's calls had to be sent over a secondary socket
+     * because the primary socket was busy. This is only printed when the
+     * verbosity level is set to at least `most_events`, and it should be called
+     * when the plugin gets shut down.
+     *
+     * @param description The name of the socket, used in the log message.
+     */
+    void log_ad_hoc_socket_statistics(const std::string& description,
+                                      const AdHocSocketStatistics& statistics) {
+        if (generic_logger.verbosity >= Logger::Verbosity::most_events) {
+            generic_logger.log(
+                "[" + description + "] " +
+                std::to_string(statistics.num_primary_requests) +
+                " requests on the primary socket, " +
+                std::to_string(statistics.num_pooled_requests) +
+                " on pooled secondary sockets, " +
+                std::to_string(statistics.num_new_connections) +
+                " new secondary socket connections");
+        }
+    }
+
+    /**
+     * Print how often and how deeply mutually recursive function calls were
+     * made. This is only printed when the verbosity level is set to at least
+     * `most_events`, and it should be called when the plugin gets shut down.
+     */
+    void log_mutual_recursion_statistics(
+        const MutualRecursionStatistics& statistics) {
+        if (generic_logger.verbosity >= Logger::Verbosity::most_events &&
+            statistics.num_forks > 0) {
+            generic_logger.log(format_mutual_recursion_statistics(statistics));
+        }
+    }
+
    protected:
     /**
      * Format and log all relevant debug information during initialization.
@@ -161,6 +225,31 @@ class PluginBridge {
         } else {
             init_msg << "'no'" << std::endl;
         }
+        if (config.audio_realtime_memory) {
+            init_msg << "memory lock:   ";
+            if (auto memlock_limit = get_memlock_limit()) {
+                if (*memlock_limit == RLIM_INFINITY) {
+                    init_msg << "'unlimited'" << std::endl;
+                } else if (*memlock_limit < memlock_min_safe_threshold) {
+                    init_msg << "'" << (*memlock_limit / 1024)
+                             << " KiB, see below'" << std::endl;
+                    init_msg << std::endl;
+                    init_msg << "   RLIMIT_MEMLOCK is set to "
+                             << (*memlock_limit / 1024)
+                             << " KiB. The audio buffers may not" << std::endl;
+                    init_msg << "   get locked into memory. Failures will be "
+                             << "logged when audio" << std::endl;
+                    init_msg << "   processing gets set up." << std::endl;
+                    init_msg << std::endl;
+                } else {
+                    init_msg << "'" << (*memlock_limit / 1024) << " KiB'"
+                             << std::endl;
+                }
+            } else {
+                init_msg << "'WARNING: Could not fetch RLIMIT_MEMLOCK'"
+                         << std::endl;
+            }
+        }
         init_msg << "sockets:       '" << sockets.base_dir.string() << "'"
                  << std::endl;
 
@@ -213,6 +302,53 @@ class PluginBridge {
 
         init_msg << "other options: ";
         std::vector<std::string> other_options;
+        if (config.audio_futex_handshake) {
+            other_options.push_back("audio: futex handshake");
+        }
+        if (config.audio_pipelining) {
+            other_options.push_back("audio: pipelined processing");
+        }
+        if (config.audio_spin_wait) {
+            other_options.push_back("audio: spin wait up to " +
+                                    std::to_string(*config.audio_spin_wait) +
+                                    " us");
+        }
+        if (config.audio_silence_gating) {
+            other_options.push_back("audio: silence gating");
+        }
+        if (config.audio_page_aligned_channels) {
+            other_options.push_back("audio: page aligned channels");
+        }
+        if (config.audio_huge_pages) {
+            other_options.push_back("audio: huge pages");
+        }
+        if (config.audio_realtime_memory) {
+            other_options.push_back("audio: realtime memory");
+        }
+        if (config.audio_memfd) {
+            other_options.push_back("audio: memfd buffers");
+        }
+        if (config.audio_double_precision_adapter) {
+            other_options.push_back("audio: double precision adapter");
+        }
+        switch (config.audio_thread_affinity) {
+            case AudioThreadAffinity::host:
+                other_options.push_back("audio: thread affinity follows host");
+                break;
+            case AudioThreadAffinity::same_core:
+                other_options.push_back(
+                    "audio: thread affinity follows host's core");
+                break;
+            case AudioThreadAffinity::cores: {
+                std::string option = "audio: thread affinity pinned to cores";
+                for (const uint32_t core : config.audio_thread_cores) {
+                    option += " " + std::to_string(core);
+                }
+                other_options.push_back(option);
+            } break;
+            default:
+                break;
+        }
         if (config.disable_pipes) {
             other_options.push_back(
                 "hack: pipes disabled, plugin output will go to \"" +
@@ -236,6 +372,15 @@ class PluginBridge {
         if (config.hide_daw) {
             other_options.push_back("hack: hide DAW name");
         }
+        if (config.parameter_mirror) {
+            other_options.push_back("parameters: shared memory mirror");
+        }
+        if (config.parameter_queue) {
+            other_options.push_back("parameters: audio thread queue");
+        }
+        if (config.vst3_coalesce_edits) {
+            other_options.push_back("vst3: coalesced edits");
+        }
         if (config.vst3_no_scaling) {
             other_options.push_back("vst3: no GUI scaling");
         }
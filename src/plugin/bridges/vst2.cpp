@@ -147,6 +147,24 @@ Vst2PluginBridge::Vst2PluginBridge(audioMasterCallback host_callback)
                                 .value_payload = std::nullopt};
                         }
                     } break;
+                    // With the `audio_silence_gating` option enabled, parameter
+                    // changes made from the plugin's editor should still be
+                    // processed when the input is silent
+                    case audioMasterAutomate: {
+                        if (config.audio_silence_gating) {
+                            silence_gate.notify_activity();
+                        }
+                    } break;
+                    // The additional latency introduced by the
+                    // `audio_pipelining` option needs to be included in the
+                    // updated `AEffect` object
+                    case audioMasterIOChanged: {
+                        if (auto* updated_plugin =
+                                std::get_if<AEffect>(&event.payload)) {
+                            updated_plugin->initialDelay += pipelining_latency;
+                            apply_double_precision_adapter(*updated_plugin);
+                        }
+                    } break;
                     case audioMasterDeadBeef:
                         logger.log("");
                         logger.log(
@@ -182,11 +200,22 @@ Vst2PluginBridge::Vst2PluginBridge(audioMasterCallback host_callback)
     // back to complete the startup process
     sockets.host_vst_control.send(config);
 
+    // With the `parameter_mirror` option enabled the Wine plugin host will
+    // then set up a shared memory table for the plugin's parameter values
+    if (config.parameter_mirror) {
+        parameter_mirror.emplace(
+            sockets.host_vst_control.receive_single<ParameterMirror::Config>());
+    }
+
     update_aeffect(plugin, initialized_plugin);
+    apply_double_precision_adapter(plugin);
 }
 
 Vst2PluginBridge::~Vst2PluginBridge() noexcept {
     try {
+        log_ad_hoc_socket_statistics(
+            "host_vst_dispatch", sockets.host_vst_dispatch.statistics());
+
         // Drop all work make sure all sockets are closed
         plugin_host->terminate();
 
@@ -600,22 +629,205 @@ intptr_t Vst2PluginBridge::dispatch(AEffect* /*plugin*/,
         } break;
     }
 
+    // `effOpen()` updates the `AEffect` object with the plugin's flags, so the
+    // double precision flag has to be reapplied after that. Since
+    // `effProcessEvents()` calls are handled without involving the plugin, we
+    // also need to ask the plugin whether it accepts MIDI events at this point.
+    if (opcode == effOpen) {
+        const intptr_t return_value = sockets.host_vst_dispatch.send_event(
+            converter, std::pair<Vst2Logger&, bool>(logger, true), opcode,
+            index, value, data, option);
+        apply_double_precision_adapter(plugin);
+
+        char receive_vst_events_query[] = "receiveVstEvents";
+        plugin_receives_vst_events =
+            sockets.host_vst_dispatch.send_event(
+                converter, std::pair<Vst2Logger&, bool>(logger, true),
+                effCanDo, 0, 0, receive_vst_events_query, 0.0) == 1;
+
+        return return_value;
+    }
+
+    // With the `audio_pipelining` option enabled the plugin's latency depends
+    // on the host's maximum block size, and the last block of audio needs to
+    // have been processed before the plugin gets suspended or resumed. The host
+    // is still in the middle of `effSetBlockSize()` when we get the new block
+    // size, so the new latency is only reported when the plugin gets resumed.
+    // Since we're on the host's dispatch thread here and the pipeline is being
+    // reset anyways, the last processed block's MIDI events are discarded
+    // instead of being added to the audio thread's `process_output_events`.
+    int pipelining_latency_change = 0;
+    if (config.audio_pipelining) {
+        switch (opcode) {
+            case effSetBlockSize:
+                requested_pipelining_latency = static_cast<int>(value);
+                break;
+            case effMainsChanged:
+                discard_pipelined_request();
+                if (value == 1) {
+                    pipelining_latency_change =
+                        requested_pipelining_latency -
+                        pipelining_latency.exchange(
+                            requested_pipelining_latency);
+                }
+                reset_pipeline();
+                break;
+        }
+    }
+
+    // The same goes for parameter changes queued with the `parameter_queue`
+    // option. These should be applied before the plugin's state gets saved or
+    // replaced, and before it gets suspended or resumed.
+    if (config.parameter_queue) {
+        switch (opcode) {
+            case effGetChunk:
+            case effSetChunk:
+            case effSetProgram:
+            case effMainsChanged:
+                flush_parameter_queue();
+                break;
+        }
+    }
+
+    // With the `audio_silence_gating` option enabled we need to know the
+    // plugin's tail length, and we need to know about anything other than the
+    // input audio that may cause the plugin to produce sound
+    if (config.audio_silence_gating) {
+        switch (opcode) {
+            case effGetTailSize: {
+                const intptr_t tail_size = sockets.host_vst_dispatch.send_event(
+                    converter, std::pair<Vst2Logger&, bool>(logger, true),
+                    opcode, index, value, data, option);
+
+                // A return value of 0 means that the plugin doesn't report a
+                // tail length, and 1 means that the plugin has no tail
+                if (tail_size <= 0) {
+                    silence_gate.set_tail_samples(SilenceGate::unknown_tail);
+                } else if (tail_size == 1) {
+                    silence_gate.set_tail_samples(0);
+                } else {
+                    silence_gate.set_tail_samples(
+                        static_cast<uint64_t>(tail_size));
+                }
+
+                return tail_size;
+            } break;
+            case effMainsChanged:
+                if (value == 0) {
+                    log_silence_gating_statistics(silence_gate);
+                }
+                [[fallthrough]];
+            case effProcessEvents:
+            case effSetChunk:
+            case effSetProgram:
+                silence_gate.notify_activity();
+                break;
+        }
+    }
+
+    // MIDI events are sent to the Wine plugin host together with the next
+    // processing request, since hosts will call `effProcessEvents()` right
+    // before processing audio anyways. Since the plugin doesn't get to see the
+    // events yet, we'll return whether the plugin reported that it accepts
+    // MIDI events instead of the plugin's return value.
+    if (opcode == effProcessEvents) {
+        const VstEvents& events = *static_cast<const VstEvents*>(data);
+        const intptr_t return_value = plugin_receives_vst_events ? 1 : 0;
+        if (logger.logger.verbosity >= Logger::Verbosity::most_events)
+            [[unlikely]] {
+            logger.log_event(true, opcode, index, value,
+                             DynamicVstEvents(events), option, std::nullopt);
+            logger.log_event_response(true, opcode, return_value, nullptr,
+                                      std::nullopt, true);
+        }
+
+        std::lock_guard lock(next_process_midi_events_mutex);
+        for (int i = 0; i < events.numEvents; i++) {
+            next_process_midi_events.events.push_back(*events.events[i]);
+        }
+
+        return return_value;
+    }
+
     // We don't reuse any buffers here like we do for audio processing. This
     // would be useful for chunk data, but since that's only needed when saving
     // and loading plugin state it's much better to have bitsery or our
     // receiving function temporarily allocate a large enough buffer rather than
     // to have a bunch of allocated memory sitting around doing nothing.
-    return sockets.host_vst_dispatch.send_event(
+    const intptr_t return_value = sockets.host_vst_dispatch.send_event(
         converter, std::pair<Vst2Logger&, bool>(logger, true), opcode, index,
         value, data, option);
+
+    // `DispatchDataConverter::write_data()` will have set up or resized the
+    // shared memory audio buffers at this point
+    if (config.audio_realtime_memory && opcode == effMainsChanged &&
+        value == 1 && process_buffers) {
+        generic_logger.log_memory_lock_result(
+            "audio buffers", process_buffers->memory_lock_result());
+    }
+
+    // The plugin has been resumed at this point, so the host should be able to
+    // handle the latency change
+    if (pipelining_latency_change != 0) {
+        plugin.initialDelay += pipelining_latency_change;
+        host_callback_function(&plugin, audioMasterIOChanged, 0, 0, nullptr,
+                               0.0);
+    }
+
+    return return_value;
 }
 
 template <typename T, bool replacing>
 void Vst2PluginBridge::do_process(T** inputs, T** outputs, int sample_frames) {
+    // With the `parameter_queue` option enabled, `setParameter()` calls from
+    // this thread will be sent along with the next processing request
+    if (config.parameter_queue) {
+        audio_thread_id.store(std::this_thread::get_id(),
+                              std::memory_order_relaxed);
+    }
+
+    // With the `audio_silence_gating` option enabled we'll skip the entire
+    // processing cycle when the plugin has been receiving silent input for
+    // longer than its tail length. Plugins without inputs are never skipped,
+    // and neither are synths and other plugins that accept MIDI since those
+    // can still produce sound when the audio input is silent.
+    // With the `audio_pipelining` option enabled the outputs returned to the
+    // host lag behind the inputs, so that latency also counts towards the tail.
+    // If there's still a block in the pipeline then that block's outputs and
+    // MIDI events are returned to the host first below, and the pipeline is
+    // only reset after that.
+    bool input_is_silent = false;
+    bool skip_cycle = false;
+    if (config.audio_silence_gating && !(plugin.flags & effFlagsIsSynth) &&
+        !plugin_receives_vst_events) {
+        input_is_silent = plugin.numInputs > 0;
+        for (int channel = 0; input_is_silent && channel < plugin.numInputs;
+             channel++) {
+            input_is_silent = is_silent(inputs[channel], sample_frames);
+        }
+
+        // Parameter changes that didn't fit in the last request are still
+        // queued, and those should be sent with this cycle
+        skip_cycle = silence_gate.should_skip(
+            input_is_silent && parameter_queue.empty(), sample_frames,
+            static_cast<uint32_t>(std::max(pipelining_latency.load(), 0)));
+        if (skip_cycle && !pipelined_request_pending) {
+            if constexpr (replacing) {
+                for (int channel = 0; channel < plugin.numOutputs; channel++) {
+                    std::fill_n(outputs[channel], sample_frames, 0);
+                }
+            }
+
+            send_incoming_midi_events();
+            return;
+        }
+    }
+
     // During audio processing we'll write the inputs to shared memory buffers,
     // and we'll then send this request alongside it with additional information
-    // needed to process audio
-    Vst2ProcessRequest request{};
+    // needed to process audio. The request object is reused to avoid
+    // allocations.
+    Vst2ProcessRequest& request = process_request;
 
     // To prevent unnecessary bridging overhead, we'll send the time information
     // together with the buffers because basically every plugin needs this
@@ -649,6 +861,11 @@ void Vst2PluginBridge::do_process(T** inputs, T** outputs, int sample_frames) {
         request.new_realtime_priority.reset();
     }
 
+    // The audio thread's CPU affinity can also be kept in sync with the host's
+    // audio thread, see the `audio_thread_affinity` option
+    request.new_cpu_affinity =
+        audio_thread_affinity_sync.update(config.audio_thread_affinity);
+
     // We reuse this audio buffers object both for the request and the response
     // to avoid unnecessary allocations. The inputs and outputs arrays should be
     // `[num_inputs][sample_frames]` and `[num_outputs][sample_frames]` floats
@@ -666,55 +883,294 @@ void Vst2PluginBridge::do_process(T** inputs, T** outputs, int sample_frames) {
         request.double_precision = true;
     } else {
         static_assert(std::is_same_v<T, float>);
+        request.double_precision = false;
     }
 
     // The host should have called `effMainsChanged()` before sending audio to
     // process
     assert(process_buffers);
-    for (int channel = 0; channel < plugin.numInputs; channel++) {
-        T* input_channel = process_buffers->input_channel_ptr<T>(0, channel);
-        std::copy_n(inputs[channel], sample_frames, input_channel);
+
+    // If the host sends double precision audio but the Windows plugin only
+    // supports single precision audio, then the shared memory buffers will
+    // contain single precision samples. In that case we'll convert the audio
+    // while copying it, and the plugin will process single precision audio.
+    const bool convert_precision = std::is_same_v<T, double> &&
+                                   !process_buffers->config.double_precision;
+    if (convert_precision) {
+        request.double_precision = false;
     }
 
+    // VST2 doesn't have any way to indicate that a channel is silent, so we'll
+    // check for that ourselves. Checking a buffer and clearing the channel in
+    // the shared memory object is cheaper than copying the buffer.
+    auto write_inputs = [&]() {
+        for (int channel = 0; channel < plugin.numInputs; channel++) {
+            if (input_is_silent || is_silent(inputs[channel], sample_frames)) {
+                if (convert_precision) {
+                    process_buffers->clear_input_channel<float>(0, channel,
+                                                                sample_frames);
+                } else {
+                    process_buffers->clear_input_channel<T>(0, channel,
+                                                            sample_frames);
+                }
+            } else if (convert_precision) {
+                process_buffers->write_input_channel<float>(
+                    0, channel, inputs[channel], sample_frames);
+            } else {
+                process_buffers->write_input_channel<T>(
+                    0, channel, inputs[channel], sample_frames);
+            }
+        }
+    };
+
     // After writing audio to the shared memory buffers, we'll send the
     // processing request parameters to the Wine plugin host so it can start
     // processing audio. This is why we don't need any explicit synchronisation.
-    sockets.host_vst_process_replacing.send(request);
-
-    // From the Wine side we'll send a zero byte struct back as an
-    // acknowledgement that audio processing has finished. At this point the
-    // audio will have been written to our buffers.
-    sockets.host_vst_process_replacing.receive_single<Ack>();
+    // With the `audio_futex_handshake` option enabled we'll write the request
+    // directly to the shared memory buffer's control block as a fixed-layout
+    // struct instead and wait for the Wine plugin host using a futex. The
+    // response is empty in either case.
+    auto send_request = [&]() {
+        {
+            std::lock_guard lock(next_process_midi_events_mutex);
+            request.midi_events.events.assign(
+                next_process_midi_events.events.begin(),
+                next_process_midi_events.events.end());
+            next_process_midi_events.events.clear();
+        }
+        // If another thread is currently flushing the queue then it's
+        // sending those parameter changes to the Wine plugin host, which can
+        // take a while. We shouldn't wait for that on the audio thread, and we
+        // can't send the remaining changes either since they could then
+        // overtake the changes being flushed. They'll simply be sent along
+        // with the next request instead. The same happens to any parameter
+        // changes that don't fit in the shared memory request, instead of
+        // sending them separately.
+        request.parameter_changes.clear();
+        if (config.parameter_queue) {
+            std::unique_lock lock(parameter_queue_consumer_mutex,
+                                  std::try_to_lock);
+            if (lock.owns_lock()) {
+                parameter_queue.drain(
+                    [&](const ParameterChange& change) {
+                        request.parameter_changes.push_back(change);
+                    },
+                    process_buffers->uses_futex_handshake()
+                        ? static_cast<uint32_t>(
+                              max_process_request_parameter_changes)
+                        : ParameterQueue::capacity);
+            }
+        }
 
-    for (int channel = 0; channel < plugin.numOutputs; channel++) {
-        const T* output_channel =
-            process_buffers->output_channel_ptr<T>(0, channel);
+        if (process_buffers->uses_futex_handshake()) {
+            Vst2ProcessRequestBlock& request_block =
+                process_buffers->request_as<Vst2ProcessRequestBlock>();
+            request_block = Vst2ProcessRequestBlock(request);
+
+            // At most `max_process_request_parameter_changes` parameter
+            // changes are taken from the queue above, so those always fit
+            auto& parameter_changes = request.parameter_changes;
+            assert(parameter_changes.size() <=
+                   max_process_request_parameter_changes);
+            std::copy(parameter_changes.begin(), parameter_changes.end(),
+                      request_block.parameter_changes);
+            request_block.num_parameter_changes =
+                static_cast<int32_t>(parameter_changes.size());
+
+            // In the unlikely case that the host sent more MIDI events than
+            // fit in the request area, we'll send them over the dispatch
+            // socket just like we'd normally do. The Wine plugin host applies
+            // the parameter changes from the request before these events
+            // regardless.
+            auto& midi_events = request.midi_events.events;
+            if (midi_events.size() <= max_process_request_events) [[likely]] {
+                std::copy(midi_events.begin(), midi_events.end(),
+                          request_block.midi_events);
+                request_block.num_midi_events =
+                    static_cast<int32_t>(midi_events.size());
+            } else {
+                log_midi_event_overflow(midi_events.size());
+                DispatchDataConverter converter(process_buffers, chunk_data,
+                                                plugin, editor_rectangle);
+                sockets.host_vst_dispatch.send_event(
+                    converter, std::pair<Vst2Logger&, bool>(logger, true),
+                    effProcessEvents, 0, 0,
+                    &request.midi_events.as_c_events(), 0.0);
+            }
 
-        if constexpr (replacing) {
-            std::copy_n(output_channel, sample_frames, outputs[channel]);
+            process_buffers->send_request(sizeof(Vst2ProcessRequestBlock));
         } else {
-            // The old `process()` function expects the plugin to add its output
-            // to the accumulated values in `outputs`. Since no host is ever
-            // going to call this anyways we won't even bother with a separate
-            // implementation and we'll just add `processReplacing()` results to
-            // `outputs`.
-            // We could use `std::execution::unseq` here but that would require
-            // linking to TBB and since this probably won't ever be used anyways
-            // that's a bit of a waste.
-            std::transform(output_channel, output_channel + sample_frames,
-                           outputs[channel], outputs[channel],
-                           [](const T& new_value, T& current_value) -> T {
-                               return new_value + current_value;
-                           });
+            sockets.host_vst_process_replacing.send(request);
+        }
+    };
+
+    // This copies `sample_frames` samples of output audio from the shared
+    // memory buffers back to the host, or adds them to the host's output
+    // buffers for the old accumulating `process()` function
+    auto read_outputs = [&]() {
+        for (int channel = 0; channel < plugin.numOutputs; channel++) {
+            if constexpr (std::is_same_v<T, double>) {
+                if (convert_precision) {
+                    convert_samples(
+                        process_buffers->output_channel_ptr<float>(0, channel),
+                        sample_frames, outputs[channel]);
+                    continue;
+                }
+            }
+
+            const T* output_channel =
+                process_buffers->output_channel_ptr<T>(0, channel);
+
+            if constexpr (replacing) {
+                std::copy_n(output_channel, sample_frames, outputs[channel]);
+            } else {
+                // The old `process()` function expects the plugin to add its
+                // output to the accumulated values in `outputs`. Since no host
+                // is ever going to call this anyways we won't even bother with
+                // a separate implementation and we'll just add
+                // `processReplacing()` results to `outputs`.
+                accumulate_samples(output_channel, sample_frames,
+                                   outputs[channel]);
+            }
+        }
+    };
+
+    // The pipeline stores samples of the type the host is processing with, so
+    // it needs to be reset when the host switches between single and double
+    // precision audio. The latency only changes when the plugin gets resumed,
+    // at which point the pipeline has already been reset.
+    const int latency = pipelining_latency;
+    constexpr bool double_precision = std::is_same_v<T, double>;
+    if (latency != active_pipelining_latency ||
+        double_precision != pipelined_double_precision) [[unlikely]] {
+        finish_pipelined_request();
+        reset_pipeline();
+        pipelined_double_precision = double_precision;
+    }
+
+    if (latency <= 0) {
+        write_inputs();
+        send_request();
+        receive_process_response();
+
+        read_outputs();
+        send_incoming_midi_events();
+
+        return;
+    }
+
+    // With the `audio_pipelining` option enabled, we'll first wait for the Wine
+    // plugin host to finish processing the previous block. That should usually
+    // have happened by now. The outputs from that block are then returned to
+    // the host, and we'll send the current block to the Wine plugin host
+    // without waiting for it to finish processing. The outputs returned to the
+    // host will always lag `pipelining_latency` samples behind the inputs. If
+    // the host always uses its maximum block size, then this is the same as
+    // returning the outputs from the previous block.
+    finish_pipelined_request();
+    if (num_pipelined_samples == 0 &&
+        pipelined_request_frames == sample_frames) {
+        read_outputs();
+    } else {
+        // If the host used a smaller block size, we'll need to store the
+        // processed samples until we can return them
+        const int num_available_samples =
+            num_pipelined_samples + pipelined_request_frames;
+        const int num_stored_samples =
+            std::max(num_available_samples, sample_frames);
+        const size_t required_size =
+            static_cast<size_t>(num_stored_samples) * sizeof(T);
+        for (int channel = 0; channel < plugin.numOutputs; channel++) {
+            std::vector<uint8_t>& channel_buffer = pipelined_outputs[channel];
+            if (channel_buffer.size() < required_size) [[unlikely]] {
+                channel_buffer.resize(required_size);
+            }
+
+            T* stored_samples = reinterpret_cast<T*>(channel_buffer.data());
+            bool converted = false;
+            if constexpr (std::is_same_v<T, double>) {
+                if (convert_precision) {
+                    convert_samples(
+                        process_buffers->output_channel_ptr<float>(0, channel),
+                        pipelined_request_frames,
+                        stored_samples + num_pipelined_samples);
+                    converted = true;
+                }
+            }
+            if (!converted) {
+                std::copy_n(process_buffers->output_channel_ptr<T>(0, channel),
+                            pipelined_request_frames,
+                            stored_samples + num_pipelined_samples);
+            }
+
+            // This can only happen if the host exceeds the maximum block size
+            // it set through `effSetBlockSize()`
+            if (num_available_samples < sample_frames) [[unlikely]] {
+                std::fill(stored_samples + num_available_samples,
+                          stored_samples + sample_frames, 0);
+            }
+
+            if constexpr (replacing) {
+                std::copy_n(stored_samples, sample_frames, outputs[channel]);
+            } else {
+                accumulate_samples(stored_samples, sample_frames,
+                                   outputs[channel]);
+            }
+
+            std::copy(stored_samples + sample_frames,
+                      stored_samples + num_stored_samples, stored_samples);
         }
+
+        num_pipelined_samples = num_stored_samples - sample_frames;
+    }
+
+    // Any MIDI events produced by the plugin during the previous block are sent
+    // to the host in this cycle
+    send_incoming_midi_events();
+
+    // When the silence gate kicks in we'll return the last processed outputs
+    // without sending a new block. Because the pipelining latency is part of
+    // the silence gate's tail, the samples discarded here are silent.
+    if (skip_cycle) {
+        reset_pipeline();
+        return;
+    }
+
+    write_inputs();
+    send_request();
+    pipelined_request_pending = true;
+    pipelined_request_frames = sample_frames;
+}
+
+void Vst2PluginBridge::apply_double_precision_adapter(
+    AEffect& plugin_info) const noexcept {
+    if (config.audio_double_precision_adapter &&
+        (plugin_info.flags & effFlagsCanReplacing)) {
+        plugin_info.flags |= effFlagsCanDoubleReplacing;
+    }
+}
+
+void Vst2PluginBridge::log_midi_event_overflow(size_t num_events) {
+    if (generic_logger.verbosity >= Logger::Verbosity::most_events) {
+        generic_logger.log("[audio processing] " + std::to_string(num_events) +
+                           " MIDI events did not fit in the shared memory"
+                           " request, sending them separately");
     }
+}
 
+void Vst2PluginBridge::send_incoming_midi_events() {
     // Plugins are allowed to send MIDI events during processing using a host
     // callback. These have to be processed during the actual
     // `processReplacing()` function or else the host will ignore them. To
     // prevent these events from getting delayed by a sample we'll process them
     // after the plugin is done processing audio rather than during the time
     // we're still waiting on the plugin.
+    if (!process_output_events.events.empty()) {
+        host_callback_function(&plugin, audioMasterProcessEvents, 0, 0,
+                               &process_output_events.as_c_events(), 0.0);
+        process_output_events.events.clear();
+    }
+
     std::lock_guard lock(incoming_midi_events_mutex);
     for (DynamicVstEvents& events : incoming_midi_events) {
         host_callback_function(&plugin, audioMasterProcessEvents, 0, 0,
@@ -724,6 +1180,74 @@ void Vst2PluginBridge::do_process(T** inputs, T** outputs, int sample_frames) {
     incoming_midi_events.clear();
 }
 
+void Vst2PluginBridge::finish_pipelined_request() {
+    if (!pipelined_request_pending) {
+        return;
+    }
+
+    receive_process_response();
+    pipelined_request_pending = false;
+}
+
+void Vst2PluginBridge::discard_pipelined_request() {
+    if (!pipelined_request_pending) {
+        return;
+    }
+
+    receive_process_response(true);
+    pipelined_request_pending = false;
+}
+
+void Vst2PluginBridge::receive_process_response(bool discard_events) {
+    // At this point the output audio will have been written to the shared
+    // memory buffers, and the response only contains the MIDI events the plugin
+    // produced while processing. With the futex handshake these are written to
+    // the response area as a fixed-layout struct.
+    assert(process_buffers);
+    auto& events = process_output_events.events;
+    if (process_buffers->uses_futex_handshake()) {
+        process_buffers->wait_for_response(
+            [&]() { return plugin_host->running(); });
+        if (discard_events) {
+            return;
+        }
+
+        const Vst2ProcessResponseBlock& response =
+            process_buffers->response_as<Vst2ProcessResponseBlock>();
+        events.insert(events.end(), response.output_events,
+                      response.output_events + response.num_output_events);
+    } else {
+        // The response still needs to be read from the socket even if we're
+        // going to discard it
+        const Vst2ProcessResponse response =
+            sockets.host_vst_process_replacing
+                .receive_single<Vst2ProcessResponse>();
+        if (discard_events) {
+            return;
+        }
+
+        events.insert(events.end(), response.output_events.events.begin(),
+                      response.output_events.events.end());
+    }
+}
+
+void Vst2PluginBridge::reset_pipeline() {
+    assert(!pipelined_request_pending);
+
+    // We'll reserve enough space for two blocks of double precision audio so
+    // we won't need to allocate anything during audio processing
+    const int latency = pipelining_latency;
+    pipelined_outputs.resize(plugin.numOutputs);
+    for (std::vector<uint8_t>& channel_buffer : pipelined_outputs) {
+        channel_buffer.assign(static_cast<size_t>(latency) * 2 * sizeof(double),
+                              0);
+    }
+
+    active_pipelining_latency = latency;
+    num_pipelined_samples = latency;
+    pipelined_request_frames = 0;
+}
+
 void Vst2PluginBridge::process(AEffect* /*plugin*/,
                                float** inputs,
                                float** outputs,
@@ -757,6 +1281,37 @@ void Vst2PluginBridge::process_double_replacing(AEffect* /*plugin*/,
 float Vst2PluginBridge::get_parameter(AEffect* /*plugin*/, int index) {
     logger.log_get_parameter(index);
 
+    // Parameter changes queued with the `parameter_queue` option need to be
+    // applied before we can ask for a parameter's value. When this is called
+    // from the audio thread we shouldn't flush the queue since that would
+    // require a round trip for every queued change, but we can simply return
+    // the last value the host set for the parameter instead.
+    if (config.parameter_queue && !parameter_queue.empty()) {
+        if (std::this_thread::get_id() ==
+            audio_thread_id.load(std::memory_order_relaxed)) {
+            if (const std::optional<float> value =
+                    parameter_queue.find_latest(index)) {
+                logger.log_get_parameter_response(*value);
+
+                return *value;
+            }
+        } else {
+            flush_parameter_queue();
+        }
+    }
+
+    // With the `parameter_mirror` option enabled we can usually read the value
+    // from shared memory instead. The Wine plugin host will add the value to
+    // the table if we end up asking the plugin for it.
+    if (parameter_mirror) {
+        if (const std::optional<float> value =
+                parameter_mirror->get(static_cast<uint32_t>(index))) {
+            logger.log_get_parameter_response(*value);
+
+            return *value;
+        }
+    }
+
     const Parameter request{index, std::nullopt};
     ParameterResult response;
 
@@ -780,6 +1335,30 @@ void Vst2PluginBridge::set_parameter(AEffect* /*plugin*/,
                                      float value) {
     logger.log_set_parameter(index, value);
 
+    if (config.audio_silence_gating) {
+        silence_gate.notify_activity();
+    }
+
+    // With the `parameter_queue` option enabled, parameter changes made from
+    // the audio thread are sent along with the next processing request. Any
+    // other `setParameter()` calls need to be applied after those queued
+    // parameter changes to preserve the order.
+    if (config.parameter_queue) {
+        if (std::this_thread::get_id() ==
+                audio_thread_id.load(std::memory_order_relaxed) &&
+            parameter_queue.push(ParameterChange{index, value})) {
+            logger.log_set_parameter_response();
+            return;
+        }
+
+        flush_parameter_queue();
+    }
+
+    send_set_parameter(index, value);
+    logger.log_set_parameter_response();
+}
+
+void Vst2PluginBridge::send_set_parameter(int index, float value) {
     const Parameter request{index, value};
     ParameterResult response;
 
@@ -791,12 +1370,17 @@ void Vst2PluginBridge::set_parameter(AEffect* /*plugin*/,
             sockets.host_vst_parameters.receive_single<ParameterResult>();
     }
 
-    logger.log_set_parameter_response();
-
     // This should not contain any values and just serve as an acknowledgement
     assert(!response.value);
 }
 
+void Vst2PluginBridge::flush_parameter_queue() {
+    std::lock_guard lock(parameter_queue_consumer_mutex);
+    parameter_queue.drain([&](const ParameterChange& change) {
+        send_set_parameter(change.index, change.value);
+    });
+}
+
 // The below functions are proxy functions for the methods defined in
 // `Bridge.cpp`
 
@@ -18,11 +18,14 @@
 
 #include <vestige/aeffectx.h>
 
+#include <atomic>
 #include <boost/asio/io_context.hpp>
 #include <thread>
 
 #include "../../common/communication/vst2.h"
 #include "../../common/logging/vst2.h"
+#include "../../common/parameter-mirror.h"
+#include "../parameter-queue.h"
 #include "common.h"
 
 /**
@@ -121,6 +124,81 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
     template <typename T, bool replacing>
     void do_process(T** inputs, T** outputs, int sample_frames);
 
+    /**
+     * Set `effFlagsCanDoubleReplacing` in an `AEffect` object received from the
+     * Wine plugin host if the `audio_double_precision_adapter` option is
+     * enabled and the plugin supports `processReplacing()`. The audio will then
+     * be converted to single precision in `do_process()`.
+     */
+    void apply_double_precision_adapter(AEffect& plugin_info) const noexcept;
+
+    /**
+     * Pass any MIDI events the plugin sent using `audioMasterProcessEvents`
+     * since the last call to this function on to the host. This should be
+     * called at the end of every processing cycle.
+     *
+     * @see incoming_midi_events
+     */
+    void send_incoming_midi_events();
+
+    /**
+     * Log that `num_events` MIDI events did not fit in the
+     * `Vst2ProcessRequestBlock` and had to be sent separately, which requires
+     * an additional round trip from the audio thread. Only logged when the
+     * verbosity level is set to at least `most_events`.
+     */
+    void log_midi_event_overflow(size_t num_events);
+
+    /**
+     * Wait for the Wine plugin host to respond to the last processing request,
+     * either through the futex handshake or over the
+     * `host_vst_process_replacing` socket. The MIDI events the plugin produced
+     * during that processing cycle are added to `process_output_events`,
+     * unless `discard_events` is set. That should be done when this is not
+     * called from the audio thread.
+     */
+    void receive_process_response(bool discard_events = false);
+
+    /**
+     * Send a `setParameter()` call to the Wine plugin host and wait for the
+     * plugin to have processed it.
+     */
+    void send_set_parameter(int index, float value);
+
+    /**
+     * Send all parameter changes queued in `parameter_queue` to the Wine plugin
+     * host right away. This is done before any operation that would observe
+     * the plugin's parameters, so queueing parameter changes doesn't change
+     * the plugin's behaviour.
+     */
+    void flush_parameter_queue();
+
+    /**
+     * With the `audio_pipelining` option enabled, wait for the Wine plugin host
+     * to finish processing the last block of audio if it's still being
+     * processed. The output audio from that block is left in the shared memory
+     * audio buffers. This is called at the start of every pipelined processing
+     * cycle.
+     */
+    void finish_pipelined_request();
+
+    /**
+     * The same as `finish_pipelined_request()`, but the MIDI events produced
+     * during the last block are discarded. This is used from the host's
+     * dispatch thread before the plugin gets suspended or resumed, since those
+     * events can then no longer be returned to the host from the audio thread.
+     */
+    void discard_pipelined_request();
+
+    /**
+     * Reset the pipeline used for the `audio_pipelining` option so the next
+     * `pipelining_latency` samples returned to the host are silent. Any
+     * outputs from a previous request that has not yet been returned to the
+     * host are discarded. `finish_pipelined_request()` or
+     * `discard_pipelined_request()` needs to be called first.
+     */
+    void reset_pipeline();
+
     /**
      * This AEffect struct will be populated using the data passed by the Wine
      * VST host during initialization and then passed as a pointer to the Linux
@@ -142,6 +220,34 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
      */
     std::mutex parameters_mutex;
 
+    /**
+     * The shared memory table containing the plugin's parameter values when the
+     * `parameter_mirror` option is enabled. `getParameter()` calls will read
+     * from this table when the value is known.
+     */
+    std::optional<ParameterMirror> parameter_mirror;
+
+    /**
+     * With the `parameter_queue` option enabled, `setParameter()` calls made
+     * from the audio thread are added to this queue. The queued parameter
+     * changes are then sent along with the next processing request.
+     */
+    ParameterQueue parameter_queue;
+    /**
+     * `parameter_queue` can only have a single consumer at a time, but the
+     * queue is flushed from whichever thread needs the changes to be applied.
+     * `flush_parameter_queue()` holds this lock while sending the changes to
+     * the Wine plugin host so they stay in order, so the audio thread only
+     * tries to lock this and leaves the changes queued if that fails.
+     */
+    std::mutex parameter_queue_consumer_mutex;
+    /**
+     * The ID of the last thread that called one of the processing functions.
+     * `setParameter()` calls from this thread are queued when the
+     * `parameter_queue` option is enabled.
+     */
+    std::atomic<std::thread::id> audio_thread_id;
+
     /**
      * The callback function passed by the host to the VST plugin instance.
      */
@@ -174,6 +280,72 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
      */
     time_t last_audio_thread_priority_synchronization = 0;
 
+    /**
+     * Used to skip processing cycles when the `audio_silence_gating` option is
+     * enabled.
+     */
+    SilenceGate silence_gate;
+
+    /**
+     * Decides when to send a new CPU affinity for the Wine plugin host's audio
+     * thread when the `audio_thread_affinity` option is set to `host` or
+     * `same_core`.
+     */
+    AudioThreadAffinitySync audio_thread_affinity_sync;
+
+    /**
+     * The maximum block size set by the host through `effSetBlockSize()` with
+     * the `audio_pipelining` option enabled. This becomes the new
+     * `pipelining_latency` when the plugin gets resumed.
+     */
+    int requested_pipelining_latency = 0;
+    /**
+     * The number of samples of latency added by the `audio_pipelining` option
+     * that has been reported to the host as part of the plugin's
+     * `initialDelay`. Zero if the option is disabled, in which case audio is
+     * processed synchronously. This may be read from the host callback thread.
+     */
+    std::atomic_int pipelining_latency = 0;
+    /**
+     * The value of `pipelining_latency` during the last call to
+     * `reset_pipeline()`. If these two differ, then the pipeline needs to be
+     * reset before processing the next block.
+     */
+    int active_pipelining_latency = 0;
+    /**
+     * Whether the samples in `pipelined_outputs` are double precision samples.
+     * The pipeline gets reset when the host switches precision.
+     */
+    bool pipelined_double_precision = false;
+    /**
+     * Whether the Wine plugin host is still processing the last request sent
+     * from `do_process()` with the `audio_pipelining` option enabled.
+     *
+     * @see finish_pipelined_request
+     */
+    bool pipelined_request_pending = false;
+    /**
+     * The number of samples in the last block sent to the Wine plugin host with
+     * the `audio_pipelining` option enabled that have not yet been copied from
+     * the shared memory audio buffers. The outputs for this block are copied
+     * during the next processing cycle.
+     */
+    int pipelined_request_frames = 0;
+    /**
+     * Output samples for every output channel that have been processed by the
+     * Windows plugin but that have not yet been returned to the host. When the
+     * host always uses its maximum block size these are only used for the
+     * first block, but hosts that use smaller blocks will need to return some
+     * samples from older blocks to keep the latency constant. Stored as raw
+     * bytes since the sample type depends on the processing precision.
+     */
+    std::vector<std::vector<uint8_t>> pipelined_outputs;
+    /**
+     * The number of samples stored at the start of every channel in
+     * `pipelined_outputs`.
+     */
+    int num_pipelined_samples = 0;
+
     /**
      * The VST host can query a plugin for arbitrary binary data such as
      * presets. It will expect the plugin to write back a pointer that points to
@@ -203,6 +375,50 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
      */
     std::mutex incoming_midi_events_mutex;
 
+    /**
+     * The MIDI events the host passed to the plugin through
+     * `effProcessEvents()` since the last processing cycle. Instead of sending
+     * these to the Wine plugin host right away, we'll attach them to the next
+     * processing request to avoid an additional round trip during every
+     * processing cycle.
+     */
+    DynamicVstEvents next_process_midi_events;
+
+    /**
+     * Whether the plugin returned 1 when we asked it whether it can
+     * `receiveVstEvents` after `effOpen()`. Since `effProcessEvents()` is
+     * handled without involving the plugin, we'll return this instead of the
+     * plugin's return value.
+     */
+    std::atomic_bool plugin_receives_vst_events = true;
+
+    /**
+     * The request object used in `do_process()`. This is reused for every
+     * processing cycle so the MIDI event and parameter change vectors don't
+     * have to be reallocated during audio processing. Only accessed from the
+     * audio thread.
+     */
+    Vst2ProcessRequest process_request;
+    /**
+     * Mutex for `next_process_midi_events`. Hosts should only call
+     * `effProcessEvents()` from the audio thread, but we can't rely on that.
+     */
+    std::mutex next_process_midi_events_mutex;
+
+    /**
+     * MIDI events the plugin sent from the Wine plugin host's audio thread
+     * during audio processing. These are returned as part of the processing
+     * response rather than through a host callback, and they're passed to the
+     * host in `send_incoming_midi_events()` before the events in
+     * `incoming_midi_events`. Only accessed from the audio thread. Responses
+     * received from the host's dispatch thread when the plugin gets suspended
+     * or resumed are discarded instead, since their events would otherwise be
+     * sent to the host during some unrelated processing cycle later.
+     *
+     * @see discard_pipelined_request
+     */
+    DynamicVstEvents process_output_events;
+
     /**
      * REAPER requires us to call `audioMasterSizeWidnow()` from the same thread
      * that's calling `effEditIdle()`. If we call this from any other thread,
@@ -198,8 +198,13 @@ tresult PLUGIN_API Vst3PlugViewProxyImpl::onSize(Steinberg::ViewRect* newSize) {
 }
 
 tresult PLUGIN_API Vst3PlugViewProxyImpl::onFocus(TBool state) {
-    return bridge.send_mutually_recursive_message(YaPlugView::OnFocus{
+    // This is sent as a one-way message, so we don't need mutual recursion here
+    // since we won't be blocking the GUI thread while the Wine plugin host
+    // handles this
+    bridge.send_message(YaPlugView::OnFocus{
         .owner_instance_id = owner_instance_id(), .state = state});
+
+    return Steinberg::kResultOk;
 }
 
 tresult PLUGIN_API
@@ -16,6 +16,7 @@
 
 #include "plugin-proxy.h"
 
+#include "../../../common/serialization/vst3/process-data-shm.h"
 #include "plug-view-proxy.h"
 
 /**
@@ -35,6 +36,70 @@ constexpr char other_instance_message_id[] = "yabridge_other_instance";
  */
 constexpr char other_instance_pointer_attribute[] = "other_proxy_ptr";
 
+/**
+ * Check whether the plugin receives nothing but silence during this processing
+ * cycle. This is used for the `audio_silence_gating` option. Any parameter
+ * changes or events count as non-silent input, and plugins without any audio
+ * inputs never receive silent input. We'll use the silence flags set by the
+ * host, and we'll check the actual buffers for channels that aren't flagged.
+ */
+static bool is_input_silent(const Steinberg::Vst::ProcessData& data) {
+    if ((data.inputParameterChanges &&
+         data.inputParameterChanges->getParameterCount() > 0) ||
+        (data.inputEvents && data.inputEvents->getEventCount() > 0)) {
+        return false;
+    }
+
+    bool has_inputs = false;
+    for (int bus = 0; bus < data.numInputs; bus++) {
+        const Steinberg::Vst::AudioBusBuffers& buffers = data.inputs[bus];
+        for (int channel = 0; channel < buffers.numChannels; channel++) {
+            has_inputs = true;
+            if (channel < 64 &&
+                (buffers.silenceFlags & (static_cast<uint64>(1) << channel))) {
+                continue;
+            }
+
+            const bool channel_is_silent =
+                data.symbolicSampleSize == Steinberg::Vst::kSample64
+                    ? is_silent(buffers.channelBuffers64[channel],
+                                data.numSamples)
+                    : is_silent(buffers.channelBuffers32[channel],
+                                data.numSamples);
+            if (!channel_is_silent) {
+                return false;
+            }
+        }
+    }
+
+    return has_inputs;
+}
+
+/**
+ * Output silence for a processing cycle we skipped because of the
+ * `audio_silence_gating` option, and mark all output channels as silent.
+ */
+static void write_silent_outputs(Steinberg::Vst::ProcessData& data) {
+    for (int bus = 0; bus < data.numOutputs; bus++) {
+        Steinberg::Vst::AudioBusBuffers& buffers = data.outputs[bus];
+        for (int channel = 0; channel < buffers.numChannels; channel++) {
+            if (data.symbolicSampleSize == Steinberg::Vst::kSample64) {
+                std::fill_n(buffers.channelBuffers64[channel], data.numSamples,
+                            0.0);
+            } else {
+                std::fill_n(buffers.channelBuffers32[channel], data.numSamples,
+                            0.0f);
+            }
+        }
+
+        // Only the first 64 channels can be marked as silent
+        buffers.silenceFlags =
+            buffers.numChannels >= 64
+                ? ~static_cast<uint64>(0)
+                : (static_cast<uint64>(1) << buffers.numChannels) - 1;
+    }
+}
+
 Vst3PluginProxyImpl::ContextMenu::ContextMenu(
     Steinberg::IPtr<Steinberg::Vst::IContextMenu> menu)
     : menu(menu) {}
@@ -86,6 +151,9 @@ bool Vst3PluginProxyImpl::unregister_context_menu(size_t context_menu_id) {
 void Vst3PluginProxyImpl::clear_caches() noexcept {
     clear_bus_cache();
 
+    parameter_info_cache.store(nullptr);
+    parameter_value_mirror.store(nullptr);
+
     std::lock_guard lock(function_result_cache_mutex);
     function_result_cache = FunctionResultCache{};
 }
@@ -164,7 +232,19 @@ Vst3PluginProxyImpl::canProcessSampleSize(int32 symbolicSampleSize) {
         }
     }
 
-    const tresult result = bridge.send_audio_processor_message(request);
+    tresult result = bridge.send_audio_processor_message(request);
+
+    // With the `audio_double_precision_adapter` option enabled we'll convert
+    // double precision audio for plugins that only support single precision
+    // audio, so we can tell the host we support it. The Wine plugin host will
+    // then set the plugin up for single precision audio instead.
+    if (bridge.config.audio_double_precision_adapter &&
+        symbolicSampleSize == Steinberg::Vst::kSample64 &&
+        result != Steinberg::kResultTrue &&
+        canProcessSampleSize(Steinberg::Vst::kSample32) ==
+            Steinberg::kResultTrue) {
+        result = Steinberg::kResultTrue;
+    }
 
     {
         std::lock_guard lock(function_result_cache_mutex);
@@ -193,6 +273,10 @@ Vst3PluginProxyImpl::setupProcessing(Steinberg::Vst::ProcessSetup& setup) {
     } else {
         process_buffers->resize(response.audio_buffers_config);
     }
+    if (bridge.config.audio_realtime_memory) {
+        bridge.generic_logger.log_memory_lock_result(
+            "audio buffers", process_buffers->memory_lock_result());
+    }
 
     return response.result;
 }
@@ -212,12 +296,27 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setProcessing(TBool state) {
         }
     }
 
+    if (bridge.config.audio_silence_gating) {
+        silence_gate.notify_activity();
+    }
+
     return bridge.send_audio_processor_message(YaAudioProcessor::SetProcessing{
         .instance_id = instance_id(), .state = state});
 }
 
 tresult PLUGIN_API
 Vst3PluginProxyImpl::process(Steinberg::Vst::ProcessData& data) {
+    // With the `audio_silence_gating` option enabled we'll skip the entire
+    // processing cycle when an effect has been receiving silent input for
+    // longer than its tail length. Instruments and other plugins with event
+    // inputs are never skipped since they can still produce sound when the
+    // audio input is silent.
+    if (bridge.config.audio_silence_gating && !has_event_inputs &&
+        silence_gate.should_skip(is_input_silent(data), data.numSamples)) {
+        write_silent_outputs(data);
+        return Steinberg::kResultOk;
+    }
+
     // We'll synchronize the scheduling priority of the audio thread on the Wine
     // plugin host with that of the host's audio thread every once in a while
     std::optional<int> new_realtime_priority = std::nullopt;
@@ -231,10 +330,20 @@ Vst3PluginProxyImpl::process(Steinberg::Vst::ProcessData& data) {
     // We reuse this existing object to avoid allocations.
     // `YaProcessData::repopulate()` will write the input audio to the shared
     // audio buffers, so they're not stored within the request object itself.
+    // With the `audio_futex_handshake` option enabled the request area in those
+    // buffers starts with fixed-layout regions for the parameter changes,
+    // events and process context, and those will then also be written there
+    // directly instead of being serialized.
     assert(process_buffers);
+    const bool use_futex_handshake = process_buffers->uses_futex_handshake();
+    ShmProcessInputs* shm_inputs =
+        use_futex_handshake ? &process_buffers->request_as<ShmProcessInputs>()
+                            : nullptr;
     process_request.instance_id = instance_id();
-    process_request.data.repopulate(data, *process_buffers);
+    process_request.data.repopulate(data, *process_buffers, shm_inputs);
     process_request.new_realtime_priority = new_realtime_priority;
+    process_request.new_cpu_affinity =
+        audio_thread_affinity_sync.update(bridge.config.audio_thread_affinity);
 
     // HACK: This is a bit ugly. This `YaProcessData::Response` object actually
     //       contains pointers to the corresponding `YaProcessData` fields in
@@ -250,24 +359,100 @@ Vst3PluginProxyImpl::process(Steinberg::Vst::ProcessData& data) {
     //       clearer.
     process_response.output_data = process_request.data.create_response();
 
-    // We'll also receive the response into an existing object so we can also
-    // avoid heap allocations there
-    bridge.receive_audio_processor_message_into(
-        MessageReference<YaAudioProcessor::Process>(process_request),
-        process_response);
+    // With the `audio_futex_handshake` option enabled we'll write the rest of
+    // the request to the request area right after those fixed-layout regions,
+    // and we'll wait for the Wine plugin host to write its response back to
+    // the response area. Otherwise, or if the request is somehow too large to
+    // fit in there, we'll send the request over this instance's audio
+    // processor socket. We'll also receive the response into an existing
+    // object so we can also avoid heap allocations there. The size of those
+    // regions depends on the capacities the Wine plugin host chose for them.
+    const uint32_t message_capacity = process_buffers->config.message_capacity;
+    const uint32_t shm_inputs_size =
+        shm_inputs ? static_cast<uint32_t>(shm_inputs->size()) : 0;
+    const std::optional<uint32_t> request_size =
+        use_futex_handshake
+            ? write_object_to(
+                  process_buffers->request_data() + shm_inputs_size,
+                  message_capacity - shm_inputs_size, process_request,
+                  process_message_buffer)
+            : std::nullopt;
+    if (request_size) {
+        const MessageReference<YaAudioProcessor::Process> request_ref(
+            process_request);
+        const bool should_log_response =
+            bridge.logger.log_request(true, request_ref);
+
+        process_buffers->send_request_and_wait(
+            *request_size, [&]() { return bridge.plugin_host->running(); });
+        const uint32_t response_size = process_buffers->control().response_size;
+        if (response_size != AudioShmBuffer::response_in_socket) [[likely]] {
+            const uint8_t* response_data =
+                process_buffers->response_data() +
+                process_buffers->response_as<ShmProcessOutputs>().size();
+            read_object_from(response_data, response_size, process_response,
+                             process_message_buffer);
+        } else {
+            // The plugin output more parameter changes or events than fit in
+            // the response area, so we'll need to fetch the response over the
+            // socket. This still deserializes into `process_request.data`.
+            bridge.receive_audio_processor_message_into(
+                YaAudioProcessor::GetOversizedProcessResponse{
+                    .instance_id = instance_id()},
+                process_response);
+        }
+
+        if (should_log_response) {
+            bridge.logger.log_response(false, process_response);
+        }
+    } else {
+        // The Wine plugin host only looks at the shared memory regions when
+        // the request is sent through the futex handshake, so in the unlikely
+        // case that the request didn't fit we'll need to move the parameter
+        // changes, events and process context back into the request object.
+        // The input audio has already been written to the shared buffers.
+        if (use_futex_handshake) [[unlikely]] {
+            process_request.data.repopulate_parameters_and_events(data);
+        }
+
+        bridge.receive_audio_processor_message_into(
+            MessageReference<YaAudioProcessor::Process>(process_request),
+            process_response);
+    }
 
     // At this point the shared audio buffers should contain the output audio,
     // so we'll write that back to the host along with any metadata (which in
     // practice are only the silence flags), as well as any output parameter
     // changes and events
-    process_request.data.write_back_outputs(data, *process_buffers);
+    process_request.data.write_back_outputs(
+        data, *process_buffers,
+        request_size ? &process_buffers->response_as<ShmProcessOutputs>()
+                     : nullptr);
+
+    // Parameter changes the plugin's processor outputs will be passed on to
+    // the edit controller by the host. The host's input parameter changes are
+    // only meant for the processor, and the edit controller may report
+    // different values for those (or it may be a separate object), so those
+    // are not mirrored.
+    if (bridge.config.parameter_mirror) {
+        mirror_parameter_changes(data.outputParameterChanges);
+    }
 
     return process_response.result;
 }
 
 uint32 PLUGIN_API Vst3PluginProxyImpl::getTailSamples() {
-    return bridge.send_audio_processor_message(
+    const uint32 tail_samples = bridge.send_audio_processor_message(
         YaAudioProcessor::GetTailSamples{.instance_id = instance_id()});
+    if (bridge.config.audio_silence_gating) {
+        if (tail_samples == Steinberg::Vst::kInfiniteTail) {
+            silence_gate.set_tail_samples(SilenceGate::unknown_tail);
+        } else {
+            silence_gate.set_tail_samples(tail_samples);
+        }
+    }
+
+    return tail_samples;
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::setAutomationState(int32 state) {
@@ -418,11 +603,25 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setActive(TBool state) {
     //       workaround of its ownn.  Great!
     clear_bus_cache();
 
+    if (bridge.config.audio_silence_gating) {
+        if (state) {
+            has_event_inputs =
+                getBusCount(Steinberg::Vst::kEvent, Steinberg::Vst::kInput) > 0;
+        } else {
+            bridge.log_silence_gating_statistics(silence_gate);
+        }
+        silence_gate.notify_activity();
+    }
+
     return bridge.send_audio_processor_message(
         YaComponent::SetActive{.instance_id = instance_id(), .state = state});
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::setState(Steinberg::IBStream* state) {
+    if (bridge.config.audio_silence_gating) {
+        silence_gate.notify_activity();
+    }
+
     if (state) {
         // Since both interfaces contain this function, this is used for both
         // `IComponent::setState()` as well as `IEditController::setState()`
@@ -432,8 +631,18 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setState(Steinberg::IBStream* state) {
         //       GUI thread. So if the GUI is active, we'll use the mutual
         //       recursion mechanism to allow this resize call to also be
         //       performed from the GUI thread.
-        return bridge.send_mutually_recursive_message(Vst3PluginProxy::SetState{
-            .instance_id = instance_id(), .state = state});
+        const tresult result =
+            bridge.send_mutually_recursive_message(Vst3PluginProxy::SetState{
+                .instance_id = instance_id(), .state = state});
+
+        // Restoring the state can change any of the plugin's parameters
+        parameter_value_mirror.read([](const ParameterValueMirror* mirror) {
+            if (mirror) {
+                mirror->invalidate_all();
+            }
+        });
+
+        return result;
     } else {
         bridge.logger.log(
             "WARNING: Null pointer passed to "
@@ -602,8 +811,18 @@ Vst3PluginProxyImpl::notify(Steinberg::Vst::IMessage* message) {
 tresult PLUGIN_API
 Vst3PluginProxyImpl::setComponentState(Steinberg::IBStream* state) {
     if (state) {
-        return bridge.send_message(YaEditController::SetComponentState{
-            .instance_id = instance_id(), .state = state});
+        const tresult result =
+            bridge.send_message(YaEditController::SetComponentState{
+                .instance_id = instance_id(), .state = state});
+
+        // See `setState()`
+        parameter_value_mirror.read([](const ParameterValueMirror* mirror) {
+            if (mirror) {
+                mirror->invalidate_all();
+            }
+        });
+
+        return result;
     } else {
         bridge.logger.log(
             "WARNING: Null pointer passed to "
@@ -616,30 +835,36 @@ int32 PLUGIN_API Vst3PluginProxyImpl::getParameterCount() {
     const auto request =
         YaEditController::GetParameterCount{.instance_id = instance_id()};
 
-    {
-        std::lock_guard lock(function_result_cache_mutex);
-        if (function_result_cache.parameter_count) {
-            const bool log_response = bridge.logger.log_request(true, request);
-            if (log_response) {
-                bridge.logger.log_response(
-                    true,
-                    YaEditController::GetParameterCount::Response(
-                        *function_result_cache.parameter_count),
-                    true);
-            }
-
-            return *function_result_cache.parameter_count;
-        }
+    const auto read_cached_count = [&]() {
+        return parameter_info_cache.read(
+            [](const YaEditController::GetAllParameterInfoResponse* cache) {
+                return cache ? std::optional(cache->parameter_count)
+                             : std::nullopt;
+            });
+    };
+
+    std::optional<int32> parameter_count = read_cached_count();
+    if (!parameter_count) {
+        prefetch_parameter_info();
+        parameter_count = read_cached_count();
     }
 
-    const int32 result = bridge.send_message(request);
+    if (parameter_count) {
+        const bool log_response = bridge.logger.log_request(true, request);
+        if (log_response) {
+            bridge.logger.log_response(
+                true,
+                YaEditController::GetParameterCount::Response(
+                    *parameter_count),
+                true);
+        }
 
-    {
-        std::lock_guard lock(function_result_cache_mutex);
-        function_result_cache.parameter_count = result;
+        return *parameter_count;
     }
 
-    return result;
+    // This can only happen when the plugin cleared the caches while we were
+    // prefetching the parameter information
+    return bridge.send_message(request);
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::getParameterInfo(
@@ -648,34 +873,57 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getParameterInfo(
     const auto request = YaEditController::GetParameterInfo{
         .instance_id = instance_id(), .param_index = paramIndex};
 
-    {
-        std::lock_guard lock(function_result_cache_mutex);
-        if (auto it = function_result_cache.parameter_info.find(paramIndex);
-            it != function_result_cache.parameter_info.end()) {
-            const bool log_response = bridge.logger.log_request(true, request);
-            if (log_response) {
-                bridge.logger.log_response(
-                    true,
-                    YaEditController::GetParameterInfo::Response{
-                        .result = Steinberg::kResultOk, .info = it->second},
-                    true);
-            }
+    // Some hosts may query parameter information without querying the
+    // parameter count first
+    const auto read_cached_info = [&]() {
+        return parameter_info_cache.read(
+            [&](const YaEditController::GetAllParameterInfoResponse* cache)
+                -> std::optional<bool> {
+                if (!cache) {
+                    return std::nullopt;
+                }
+
+                // Failed calls and invalid indices are not cached, and we'll
+                // pass those through to the plugin instead
+                if (paramIndex < 0 || static_cast<size_t>(paramIndex) >=
+                                          cache->parameters.size()) {
+                    return false;
+                }
 
-            info = it->second;
+                const auto& [result, cached_info] =
+                    cache->parameters[paramIndex];
+                if (result == Steinberg::kResultOk) {
+                    info = cached_info;
+                    return true;
+                } else {
+                    return false;
+                }
+            });
+    };
+
+    std::optional<bool> is_cached = read_cached_info();
+    if (!is_cached) {
+        prefetch_parameter_info();
+        is_cached = read_cached_info();
+    }
 
-            return Steinberg::kResultOk;
+    if (is_cached && *is_cached) {
+        const bool log_response = bridge.logger.log_request(true, request);
+        if (log_response) {
+            bridge.logger.log_response(
+                true,
+                YaEditController::GetParameterInfo::Response{
+                    .result = Steinberg::kResultOk, .info = info},
+                true);
         }
+
+        return Steinberg::kResultOk;
     }
 
     const GetParameterInfoResponse response = bridge.send_message(request);
 
     info = response.info;
 
-    {
-        std::lock_guard lock(function_result_cache_mutex);
-        function_result_cache.parameter_info[paramIndex] = response.info;
-    }
-
     return response.result;
 }
 
@@ -742,15 +990,74 @@ Vst3PluginProxyImpl::plainParamToNormalized(
 
 Steinberg::Vst::ParamValue PLUGIN_API
 Vst3PluginProxyImpl::getParamNormalized(Steinberg::Vst::ParamID id) {
-    return bridge.send_message(YaEditController::GetParamNormalized{
-        .instance_id = instance_id(), .id = id});
+    const auto request = YaEditController::GetParamNormalized{
+        .instance_id = instance_id(), .id = id};
+
+    // With the `parameter_mirror` option enabled we'll serve these calls from
+    // `parameter_value_mirror`. Every once in a while we'll still ask the
+    // plugin to verify that it actually reports all of its parameter changes.
+    const bool use_mirror = bridge.config.parameter_mirror &&
+                            !parameter_value_mirror_disabled.load();
+    const auto read_mirrored_value = [&]() {
+        return parameter_value_mirror.read(
+            [&](const ParameterValueMirror* mirror)
+                -> std::optional<Steinberg::Vst::ParamValue> {
+                return mirror ? mirror->get(id) : std::nullopt;
+            });
+    };
+
+    std::optional<Steinberg::Vst::ParamValue> mirrored_value;
+    if (use_mirror) {
+        mirrored_value = read_mirrored_value();
+        const bool should_verify =
+            (num_parameter_value_mirror_hits.fetch_add(1) + 1) %
+                parameter_value_mirror_verify_interval ==
+            0;
+        if (mirrored_value && !should_verify) {
+            const bool log_response = bridge.logger.log_request(true, request);
+            if (log_response) {
+                bridge.logger.log_response(
+                    true,
+                    YaEditController::GetParamNormalized::Response(
+                        *mirrored_value),
+                    true);
+            }
+
+            return *mirrored_value;
+        }
+    }
+
+    const Steinberg::Vst::ParamValue value = bridge.send_message(request);
+
+    if (use_mirror) {
+        // The value may have legitimately changed while we were waiting for the
+        // plugin, in which case the mirror will also have been updated
+        if (mirrored_value && *mirrored_value != value &&
+            read_mirrored_value() != value) {
+            parameter_value_mirror_disabled = true;
+            bridge.logger.log(
+                "WARNING: The plugin changed parameter " + std::to_string(id) +
+                " without notifying the host. Disabling the "
+                "'parameter_mirror' option for this plugin instance.");
+        } else {
+            mirror_parameter_value(id, value);
+        }
+    }
+
+    return value;
 }
 
 tresult PLUGIN_API
 Vst3PluginProxyImpl::setParamNormalized(Steinberg::Vst::ParamID id,
                                         Steinberg::Vst::ParamValue value) {
-    return bridge.send_message(YaEditController::SetParamNormalized{
-        .instance_id = instance_id(), .id = id, .value = value});
+    const tresult result =
+        bridge.send_message(YaEditController::SetParamNormalized{
+            .instance_id = instance_id(), .id = id, .value = value});
+    if (result == Steinberg::kResultOk) {
+        mirror_parameter_value(id, value);
+    }
+
+    return result;
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::setComponentHandler(
@@ -1352,6 +1659,84 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getXmlRepresentationStream(
     }
 }
 
+void Vst3PluginProxyImpl::mirror_parameter_value(
+    Steinberg::Vst::ParamID id,
+    Steinberg::Vst::ParamValue value) noexcept {
+    if (bridge.config.parameter_mirror) {
+        parameter_value_mirror.read([&](const ParameterValueMirror* mirror) {
+            if (mirror) {
+                mirror->set(id, value);
+            }
+        });
+    }
+}
+
+void Vst3PluginProxyImpl::prefetch_parameter_info() {
+    const uint64_t cache_version = parameter_info_cache.version();
+    const uint64_t mirror_version = parameter_value_mirror.version();
+    auto response =
+        std::make_unique<YaEditController::GetAllParameterInfoResponse>(
+            bridge.send_message(YaEditController::GetAllParameterInfo{
+                .instance_id = instance_id()}));
+
+    // The parameter value mirror uses the same set of parameters
+    std::unique_ptr<const ParameterValueMirror> mirror;
+    if (bridge.config.parameter_mirror) {
+        std::vector<Steinberg::Vst::ParamID> parameter_ids;
+        parameter_ids.reserve(response->parameters.size());
+        for (const auto& [result, info] : response->parameters) {
+            if (result == Steinberg::kResultOk) {
+                parameter_ids.push_back(info.id);
+            }
+        }
+
+        mirror = std::make_unique<const ParameterValueMirror>(parameter_ids);
+    }
+
+    if (parameter_info_cache.store_if_unchanged(std::move(response),
+                                                cache_version) &&
+        mirror) {
+        parameter_value_mirror.store_if_unchanged(std::move(mirror),
+                                                  mirror_version);
+    }
+}
+
+void Vst3PluginProxyImpl::mirror_parameter_changes(
+    Steinberg::Vst::IParameterChanges* changes) noexcept {
+    if (!changes) {
+        return;
+    }
+
+    const int32 num_queues = changes->getParameterCount();
+    if (num_queues <= 0) {
+        return;
+    }
+
+    parameter_value_mirror.read([&](const ParameterValueMirror* mirror) {
+        if (!mirror) {
+            return;
+        }
+
+        for (int32 i = 0; i < num_queues; i++) {
+            Steinberg::Vst::IParamValueQueue* queue =
+                changes->getParameterData(i);
+            if (!queue) {
+                continue;
+            }
+
+            // Only the last value matters here
+            const int32 num_points = queue->getPointCount();
+            int32 sample_offset;
+            Steinberg::Vst::ParamValue value;
+            if (num_points > 0 &&
+                queue->getPoint(num_points - 1, sample_offset, value) ==
+                    Steinberg::kResultOk) {
+                mirror->set(queue->getParameterId(), value);
+            }
+        }
+    });
+}
+
 void Vst3PluginProxyImpl::clear_bus_cache() noexcept {
     std::lock_guard lock(processing_bus_cache_mutex);
     if (processing_bus_cache) {
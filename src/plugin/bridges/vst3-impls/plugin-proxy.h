@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include "../../atomic-snapshot.h"
+#include "../../parameter-value-mirror.h"
 #include "../vst3.h"
 #include "plug-view-proxy.h"
 
@@ -74,6 +76,14 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      */
     void clear_caches() noexcept;
 
+    /**
+     * Update a parameter's value in `parameter_value_mirror` when the plugin
+     * reports a parameter change through `IComponentHandler::performEdit()`.
+     * This does nothing when the `parameter_mirror` option is not enabled.
+     */
+    void mirror_parameter_value(Steinberg::Vst::ParamID id,
+                                Steinberg::Vst::ParamValue value) noexcept;
+
     // From `IAudioPresentationLatency`
     tresult PLUGIN_API
     setAudioPresentationLatencySamples(Steinberg::Vst::BusDirection dir,
@@ -411,6 +421,22 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      */
     void clear_bus_cache() noexcept;
 
+    /**
+     * Fetch the parameter count and the information for every parameter from
+     * the Wine plugin host in a single request, and store the results in
+     * `parameter_info_cache`. If `clear_caches()` was called while the request
+     * was in flight, then the results will be discarded.
+     */
+    void prefetch_parameter_info();
+
+    /**
+     * Update `parameter_value_mirror` with the last value of every parameter
+     * in `changes`. Used with the output parameter changes during audio
+     * processing, so this is realtime safe.
+     */
+    void mirror_parameter_changes(
+        Steinberg::Vst::IParameterChanges* changes) noexcept;
+
     Vst3PluginBridge& bridge;
 
     /**
@@ -429,6 +455,25 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      */
     time_t last_audio_thread_priority_synchronization = 0;
 
+    /**
+     * Used to skip processing cycles when the `audio_silence_gating` option is
+     * enabled.
+     */
+    SilenceGate silence_gate;
+    /**
+     * Whether the plugin had any event input buses when it was last activated.
+     * Instruments and other plugins that accept note events are never skipped
+     * by the silence gate.
+     */
+    std::atomic_bool has_event_inputs = false;
+
+    /**
+     * Decides when to send a new CPU affinity for the Wine plugin host's audio
+     * thread when the `audio_thread_affinity` option is set to `host` or
+     * `same_core`.
+     */
+    AudioThreadAffinitySync audio_thread_affinity_sync;
+
     /**
      * Used to assign unique identifiers to context menus created by
      * `IComponentHandler3::CreateContextMenu`.
@@ -458,6 +503,14 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      */
     YaAudioProcessor::ProcessResponse process_response;
 
+    /**
+     * The buffer used to serialize `process_request` and to deserialize
+     * `process_response` when they're exchanged through the control block in
+     * `process_buffers` (when the `audio_futex_handshake` option is enabled).
+     * Kept around so it only has to grow once.
+     */
+    SerializationBuffer<1024> process_message_buffer;
+
     /**
      * A shared memory object to share audio buffers between the native plugin
      * and the Wine plugin host. Copying audio is the most significant source of
@@ -522,14 +575,6 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
          * call this every processing cycle.
          */
         std::map<int32, tresult> can_process_sample_size;
-        /**
-         * Memoizes `IEditController::getParameterCount()`.
-         */
-        std::optional<int32> parameter_count;
-        /**
-         * Memoizes `IEditController::getParameterInfo()`.
-         */
-        std::unordered_map<int32, Steinberg::Vst::ParameterInfo> parameter_info;
     };
 
     /**
@@ -548,4 +593,40 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      */
     FunctionResultCache function_result_cache;
     std::mutex function_result_cache_mutex;
+
+    /**
+     * Memoizes `IEditController::getParameterCount()` and
+     * `IEditController::getParameterInfo()`. Hosts query the information for
+     * every parameter when loading a plugin and again after the plugin calls
+     * `IComponentHandler::restartComponent()`, so when the parameter count is
+     * first queried we'll fetch the information for all parameters at once
+     * using `prefetch_parameter_info()`. This is cleared together with
+     * `function_result_cache`, and it can be read without locking.
+     *
+     * @see clear_caches
+     */
+    AtomicSnapshot<YaEditController::GetAllParameterInfoResponse>
+        parameter_info_cache;
+
+    /**
+     * With the `parameter_mirror` option enabled, this contains a copy of the
+     * plugin's parameter values so `getParamNormalized()` doesn't need a round
+     * trip to the Wine plugin host. This is created together with
+     * `parameter_info_cache`, and it's also cleared in `clear_caches()`.
+     *
+     * @see ParameterValueMirror
+     */
+    AtomicSnapshot<ParameterValueMirror> parameter_value_mirror;
+    /**
+     * The number of `getParamNormalized()` calls made while the mirror was
+     * enabled, used to verify the mirrored values every
+     * `parameter_value_mirror_verify_interval` calls.
+     */
+    std::atomic_uint32_t num_parameter_value_mirror_hits = 0;
+    /**
+     * Set when the plugin turned out to change its parameter values without
+     * notifying the host. From that point on we'll always ask the plugin
+     * directly.
+     */
+    std::atomic_bool parameter_value_mirror_disabled = false;
 };
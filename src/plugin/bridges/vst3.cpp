@@ -74,10 +74,14 @@ Vst3PluginBridge::Vst3PluginBridge()
                 },
                 [&](const YaComponentHandler::PerformEdit& request)
                     -> YaComponentHandler::PerformEdit::Response {
-                    return plugin_proxies.at(request.owner_instance_id)
-                        .get()
-                        .component_handler->performEdit(
-                            request.id, request.value_normalized);
+                    Vst3PluginProxyImpl& proxy_object =
+                        plugin_proxies.at(request.owner_instance_id).get();
+
+                    proxy_object.mirror_parameter_value(
+                        request.id, request.value_normalized);
+
+                    return proxy_object.component_handler->performEdit(
+                        request.id, request.value_normalized);
                 },
                 [&](const YaComponentHandler::EndEdit& request)
                     -> YaComponentHandler::EndEdit::Response {
@@ -85,6 +89,45 @@ Vst3PluginBridge::Vst3PluginBridge()
                         .get()
                         .component_handler->endEdit(request.id);
                 },
+                [&](const YaComponentHandler::PerformEdits& request)
+                    -> YaComponentHandler::PerformEdits::Response {
+                    Vst3PluginProxyImpl& proxy_object =
+                        plugin_proxies.at(request.owner_instance_id).get();
+
+                    // We'll replay the edits in the same order the plugin made
+                    // them, and we'll report the first failure if there was one
+                    tresult result = Steinberg::kResultOk;
+                    for (const auto& edit : request.edits) {
+                        tresult edit_result = Steinberg::kResultOk;
+                        switch (edit.type) {
+                            case YaComponentHandler::ParameterEdit::Type::begin:
+                                edit_result =
+                                    proxy_object.component_handler->beginEdit(
+                                        edit.id);
+                                break;
+                            case YaComponentHandler::ParameterEdit::Type::
+                                perform:
+                                proxy_object.mirror_parameter_value(
+                                    edit.id, edit.value_normalized);
+                                edit_result =
+                                    proxy_object.component_handler->performEdit(
+                                        edit.id, edit.value_normalized);
+                                break;
+                            case YaComponentHandler::ParameterEdit::Type::end:
+                                edit_result =
+                                    proxy_object.component_handler->endEdit(
+                                        edit.id);
+                                break;
+                        }
+
+                        if (result == Steinberg::kResultOk &&
+                            edit_result != Steinberg::kResultOk) {
+                            result = edit_result;
+                        }
+                    }
+
+                    return result;
+                },
                 [&](const YaComponentHandler::RestartComponent& request)
                     -> YaComponentHandler::RestartComponent::Response {
                     Vst3PluginProxyImpl& proxy_object =
@@ -99,9 +142,11 @@ Vst3PluginBridge::Vst3PluginBridge()
                 },
                 [&](const YaComponentHandler2::SetDirty& request)
                     -> YaComponentHandler2::SetDirty::Response {
-                    return plugin_proxies.at(request.owner_instance_id)
+                    plugin_proxies.at(request.owner_instance_id)
                         .get()
                         .component_handler_2->setDirty(request.state);
+
+                    return OneWay{};
                 },
                 [&](const YaComponentHandler2::RequestOpenEditor& request)
                     -> YaComponentHandler2::RequestOpenEditor::Response {
@@ -366,6 +411,10 @@ Vst3PluginBridge::Vst3PluginBridge()
 
 Vst3PluginBridge::~Vst3PluginBridge() noexcept {
     try {
+        log_ad_hoc_socket_statistics(
+            "host_vst_control", sockets.host_vst_control.statistics());
+        log_mutual_recursion_statistics(mutual_recursion.statistics());
+
         // Drop all work make sure all sockets are closed
         plugin_host->terminate();
         io_context.stop();
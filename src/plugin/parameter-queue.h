@@ -0,0 +1,123 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+
+#include "../common/serialization/vst2.h"
+
+/**
+ * A lock-free single producer, single consumer ring buffer for `setParameter()`
+ * calls made by the host from the audio thread. This is used for the
+ * `parameter_queue` option. Instead of doing a round trip to the Wine plugin
+ * host for every parameter change, the parameter changes are queued here and
+ * they're then sent to the Wine plugin host along with the next processing
+ * request.
+ *
+ * `push()` should only be called from the audio thread. Consumers need to be
+ * serialized by the caller, since the queue may also be flushed from other
+ * threads.
+ */
+class ParameterQueue {
+   public:
+    /**
+     * The maximum number of parameter changes that can be queued at once. If
+     * the queue is full, then the caller should flush the queue and send the
+     * parameter change directly instead.
+     */
+    static constexpr uint32_t capacity = 1024;
+
+    /**
+     * Add a parameter change to the queue.
+     *
+     * @return False if the queue is full, in which case nothing was added.
+     */
+    inline bool push(const ParameterChange& change) noexcept {
+        const uint32_t current_tail = tail.load(std::memory_order_relaxed);
+        if (current_tail - head.load(std::memory_order_acquire) >= capacity) {
+            return false;
+        }
+
+        changes[current_tail % capacity] = change;
+        tail.store(current_tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * Whether there are currently no queued parameter changes.
+     */
+    inline bool empty() const noexcept {
+        return head.load(std::memory_order_acquire) ==
+               tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Remove up to `max_count` of the oldest queued parameter changes from the
+     * queue, and call `callback` with each of them in order. Any remaining
+     * parameter changes stay in the queue.
+     */
+    template <std::invocable<const ParameterChange&> F>
+    void drain(F&& callback, uint32_t max_count = capacity) {
+        const uint32_t current_head = head.load(std::memory_order_relaxed);
+        const uint32_t current_tail = tail.load(std::memory_order_acquire);
+        const uint32_t new_head =
+            current_head + std::min(current_tail - current_head, max_count);
+        for (uint32_t i = current_head; i != new_head; i++) {
+            callback(changes[i % capacity]);
+        }
+
+        head.store(new_head, std::memory_order_release);
+    }
+
+    /**
+     * Find the value from the most recently queued parameter change for the
+     * parameter `index`, if there is one. This should only be called from the
+     * producer thread, since only that thread overwrites queued parameter
+     * changes.
+     */
+    std::optional<float> find_latest(int32_t index) const noexcept {
+        const uint32_t current_head = head.load(std::memory_order_acquire);
+        const uint32_t current_tail = tail.load(std::memory_order_relaxed);
+        for (uint32_t i = current_tail; i != current_head; i--) {
+            const ParameterChange& change = changes[(i - 1) % capacity];
+            if (change.index == index) {
+                return change.value;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+   private:
+    std::array<ParameterChange, capacity> changes;
+
+    /**
+     * The index of the oldest queued parameter change. These indices only
+     * ever increase and they're wrapped when indexing `changes`.
+     */
+    std::atomic_uint32_t head = 0;
+    /**
+     * The index one past the newest queued parameter change.
+     */
+    std::atomic_uint32_t tail = 0;
+};
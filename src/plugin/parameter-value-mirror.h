@@ -0,0 +1,134 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <pluginterfaces/vst/vsttypes.h>
+
+/**
+ * Every this many `getParamNormalized()` calls, the value will be queried from
+ * the plugin even if it's in the `ParameterValueMirror` to check whether the
+ * mirrored value is still correct. If it's not, then the plugin changes its
+ * parameter values without telling the host and the mirror will be disabled
+ * for that plugin instance.
+ */
+constexpr uint32_t parameter_value_mirror_verify_interval = 64;
+
+/**
+ * A plugin-side table of a VST3 plugin's normalized parameter values, used for
+ * the `parameter_mirror` option. Hosts call
+ * `IEditController::getParamNormalized()` constantly to draw automation lanes
+ * and generic editors, and without this every one of those calls would require
+ * a round trip to the Wine plugin host.
+ *
+ * The set of parameters is fixed when the table is created from the plugin's
+ * parameter information, so only the values need to be synchronized. Entries
+ * start out as unknown. They're updated when the plugin calls
+ * `IComponentHandler::performEdit()`, when the host calls
+ * `IEditController::setParamNormalized()`, from the output parameter changes
+ * during audio processing, and with the results of `getParamNormalized()`
+ * calls that did have to go to the plugin. All operations are lock-free, so
+ * this can also be updated from the audio thread.
+ * Since only the atomic values change, the updating functions are `const` so
+ * they can be used on a table shared through an `AtomicSnapshot`.
+ */
+class ParameterValueMirror {
+   public:
+    /**
+     * Create a table for the parameters with the specified IDs. All values
+     * start out as unknown.
+     */
+    explicit ParameterValueMirror(
+        const std::vector<Steinberg::Vst::ParamID>& parameter_ids)
+        : num_values(parameter_ids.size()),
+          values(std::make_unique<std::atomic<Steinberg::Vst::ParamValue>[]>(
+              parameter_ids.size())) {
+        indices.reserve(parameter_ids.size());
+        for (size_t i = 0; i < parameter_ids.size(); i++) {
+            indices.emplace(parameter_ids[i], i);
+            values[i].store(unknown_value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Get the mirrored value for a parameter, if we know it.
+     */
+    std::optional<Steinberg::Vst::ParamValue> get(
+        Steinberg::Vst::ParamID id) const noexcept {
+        const auto index = indices.find(id);
+        if (index == indices.end()) {
+            return std::nullopt;
+        }
+
+        const Steinberg::Vst::ParamValue value =
+            values[index->second].load(std::memory_order_acquire);
+        if (std::isnan(value)) {
+            return std::nullopt;
+        } else {
+            return value;
+        }
+    }
+
+    /**
+     * Update the mirrored value for a parameter. IDs that weren't part of the
+     * plugin's parameter information are ignored.
+     */
+    void set(Steinberg::Vst::ParamID id,
+             Steinberg::Vst::ParamValue value) const noexcept {
+        if (const auto index = indices.find(id); index != indices.end()) {
+            values[index->second].store(value, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Mark all values as unknown. This should be used when any of the plugin's
+     * parameters may have changed without us knowing, like after the host
+     * restores the plugin's state.
+     */
+    void invalidate_all() const noexcept {
+        for (size_t i = 0; i < num_values; i++) {
+            values[i].store(unknown_value, std::memory_order_release);
+        }
+    }
+
+   private:
+    /**
+     * Normalized parameter values are always in `[0, 1]`, so we can use NaN
+     * to mark a value as unknown.
+     */
+    static constexpr Steinberg::Vst::ParamValue unknown_value =
+        std::numeric_limits<Steinberg::Vst::ParamValue>::quiet_NaN();
+
+    /**
+     * Maps parameter IDs to indices in `values`. This is never modified after
+     * the constructor.
+     */
+    std::unordered_map<Steinberg::Vst::ParamID, size_t> indices;
+    /**
+     * The number of elements in `values`. This can be larger than the size of
+     * `indices` if the plugin reports the same parameter ID more than once.
+     */
+    size_t num_values;
+    std::unique_ptr<std::atomic<Steinberg::Vst::ParamValue>[]> values;
+};
@@ -0,0 +1,65 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "silence-gate.h"
+
+void SilenceGate::set_tail_samples(uint64_t samples) noexcept {
+    tail_samples.store(samples, std::memory_order_relaxed);
+}
+
+void SilenceGate::notify_activity() noexcept {
+    had_activity.store(true, std::memory_order_relaxed);
+}
+
+bool SilenceGate::should_skip(bool input_is_silent,
+                              uint32_t num_samples,
+                              uint32_t extra_latency) noexcept {
+    cycles.store(cycles.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+
+    // Anything that isn't silence means the plugin's tail starts over, even if
+    // the plugin doesn't end up producing any output for it
+    const bool had_activity =
+        this->had_activity.exchange(false, std::memory_order_relaxed);
+    if (!input_is_silent || had_activity) {
+        silent_samples = 0;
+        return false;
+    }
+
+    uint64_t tail_samples = this->tail_samples.load(std::memory_order_relaxed);
+    if (tail_samples != unknown_tail) {
+        tail_samples += extra_latency;
+    }
+
+    if (silent_samples >= tail_samples) {
+        skipped_cycles.store(skipped_cycles.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+        return true;
+    }
+
+    // The plugin still needs to process this cycle to finish its tail. With an
+    // unknown tail this would take millions of years to overflow.
+    silent_samples += num_samples;
+    return false;
+}
+
+uint64_t SilenceGate::num_cycles() const noexcept {
+    return cycles.load(std::memory_order_relaxed);
+}
+
+uint64_t SilenceGate::num_skipped_cycles() const noexcept {
+    return skipped_cycles.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,99 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+/**
+ * Keeps track of how long a plugin has been receiving silent input for, so we
+ * can skip the entire round trip to the Wine plugin host once the plugin's tail
+ * has elapsed. This is used for the `audio_silence_gating` option. The plugin's
+ * tail length is only known once the host has queried it, and until that time
+ * no cycles will be skipped.
+ *
+ * `should_skip()` should only be called from the audio thread. The other
+ * functions may be called from any thread.
+ */
+class SilenceGate {
+   public:
+    /**
+     * The tail length used when the plugin's tail is unknown or infinite. We'll
+     * never skip any cycles in that case.
+     */
+    static constexpr uint64_t unknown_tail =
+        std::numeric_limits<uint64_t>::max();
+
+    /**
+     * Update the plugin's tail length in samples. This should be called with
+     * the plugin's response every time the host queries the tail length.
+     */
+    void set_tail_samples(uint64_t samples) noexcept;
+
+    /**
+     * Make sure the next processing cycle gets sent to the plugin, and start
+     * counting silent samples from zero again. This should be called whenever
+     * something other than the input audio may cause the plugin to produce
+     * output, like parameter changes, MIDI events, or the plugin getting
+     * reactivated or loading a new state.
+     */
+    void notify_activity() noexcept;
+
+    /**
+     * Check whether we can skip this processing cycle, and update our internal
+     * state accordingly. If this returns true, then the caller should output
+     * silence instead of sending the processing request to the plugin.
+     *
+     * @param input_is_silent Whether all of the plugin's inputs are silent for
+     *   this cycle. This should be false for plugins without any inputs.
+     * @param num_samples The number of samples in this cycle.
+     * @param extra_latency Additional latency in samples between the plugin's
+     *   inputs and the outputs returned to the host, such as the latency added
+     *   by the `audio_pipelining` option. This is added to the plugin's tail
+     *   length so cycles only get skipped once those outputs have also been
+     *   returned to the host.
+     */
+    bool should_skip(bool input_is_silent,
+                     uint32_t num_samples,
+                     uint32_t extra_latency = 0) noexcept;
+
+    /**
+     * The number of processing cycles seen since this object was created.
+     */
+    uint64_t num_cycles() const noexcept;
+
+    /**
+     * The number of processing cycles we skipped since this object was created.
+     */
+    uint64_t num_skipped_cycles() const noexcept;
+
+   private:
+    std::atomic_uint64_t tail_samples = unknown_tail;
+    std::atomic_bool had_activity = false;
+
+    /**
+     * The number of samples the plugin has processed since the input became
+     * silent. Only accessed from the audio thread.
+     */
+    uint64_t silent_samples = 0;
+
+    // These counters are only written to from the audio thread, but they may
+    // be read from other threads
+    std::atomic_uint64_t cycles = 0;
+    std::atomic_uint64_t skipped_cycles = 0;
+};
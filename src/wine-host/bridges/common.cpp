@@ -22,10 +22,12 @@
 
 HostBridge::HostBridge(MainContext& main_context,
                        boost::filesystem::path plugin_path,
-                       pid_t parent_pid)
+                       pid_t parent_pid,
+                       AudioShmArena* shm_arena)
     : plugin_path(plugin_path),
       main_context(main_context),
       generic_logger(Logger::create_wine_stderr()),
+      shm_arena(shm_arena),
       parent_pid(parent_pid),
       watchdog_guard(main_context.register_watchdog(*this)) {}
 
@@ -42,6 +44,37 @@ void HostBridge::handle_win32_events() noexcept {
     }
 }
 
+void HostBridge::log_spin_wait_statistics(
+    const AudioShmBuffer::SpinWaitStatistics& statistics) {
+    if (generic_logger.verbosity >= Logger::Verbosity::most_events &&
+        statistics.num_requests > 0) {
+        generic_logger.log(
+            "[audio spin wait] " + std::to_string(statistics.num_spin_hits) +
+            " of " + std::to_string(statistics.num_requests) +
+            " processing requests arrived while spinning");
+    }
+}
+
+void HostBridge::log_mutual_recursion_statistics(
+    const MutualRecursionStatistics& statistics) {
+    if (generic_logger.verbosity >= Logger::Verbosity::most_events &&
+        statistics.num_forks > 0) {
+        generic_logger.log(format_mutual_recursion_statistics(statistics));
+    }
+}
+
+void HostBridge::pin_audio_thread(const Configuration& config) {
+    if (config.audio_thread_affinity != AudioThreadAffinity::cores) {
+        return;
+    }
+
+    if (!set_cpu_affinity(CpuSet::from_cpus(config.audio_thread_cores))) {
+        generic_logger.log(
+            "WARNING: Could not pin the audio thread to the cores from the "
+            "'audio_thread_affinity' option");
+    }
+}
+
 void HostBridge::shutdown_if_dangling() {
     // If the parent process has exited and this plugin bridge instance is
     // outliving the process it's supposed to be connected to (because in some
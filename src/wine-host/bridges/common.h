@@ -20,7 +20,10 @@
 
 #include <boost/filesystem.hpp>
 
+#include "../../common/audio-shm.h"
+#include "../../common/configuration.h"
 #include "../../common/logging/common.h"
+#include "../../common/mutual-recursion.h"
 #include "../utils.h"
 
 /**
@@ -34,7 +37,8 @@ class HostBridge {
    protected:
     HostBridge(MainContext& main_context,
                boost::filesystem::path plugin_path,
-               pid_t parent_pid);
+               pid_t parent_pid,
+               AudioShmArena* shm_arena);
 
    public:
     virtual ~HostBridge() noexcept;
@@ -112,6 +116,41 @@ class HostBridge {
      */
     virtual void close_sockets() = 0;
 
+    /**
+     * Print how many audio processing requests were caught while the Wine
+     * plugin host's audio thread was still spinning when the `audio_spin_wait`
+     * option is enabled. These statistics are only printed when the verbosity
+     * level is set to at least `most_events` since they're only useful when
+     * tuning that option.
+     *
+     * @see AudioShmBuffer::set_spin_wait_limit
+     */
+    void log_spin_wait_statistics(
+        const AudioShmBuffer::SpinWaitStatistics& statistics);
+
+    /**
+     * Print how often and how deeply the plugin made mutually recursive
+     * callbacks to the host. These statistics are only printed when the
+     * verbosity level is set to at least `most_events`. This should be called
+     * once the plugin has shut down.
+     */
+    void log_mutual_recursion_statistics(
+        const MutualRecursionStatistics& statistics);
+
+    /**
+     * Pin the calling thread to the cores from the `audio_thread_affinity`
+     * option if that option has been set to a list of cores. This should be
+     * called at the start of every audio thread. A warning is printed if none
+     * of those cores are available to this process.
+     */
+    void pin_audio_thread(const Configuration& config);
+
+    /**
+     * The number of bytes of an audio thread's stack that should be pre-faulted
+     * and locked when the `audio_realtime_memory` option is enabled.
+     */
+    static constexpr size_t audio_thread_stack_lock_size = 128 * 1024;
+
     /**
      * The IO context used for event handling so that all events and window
      * message handling can be performed from a single thread, even when hosting
@@ -128,6 +167,16 @@ class HostBridge {
      */
     Logger generic_logger;
 
+    /**
+     * The arena the shared audio buffers should be allocated from when this
+     * plugin is hosted in a plugin group, or a null pointer when the plugin is
+     * hosted individually. In that case every plugin gets its own shared
+     * memory object.
+     *
+     * @see GroupBridge::shm_arena
+     */
+    AudioShmArena* const shm_arena;
+
    private:
     /**
      * The process ID of the native plugin host we are bridging for. This should
@@ -96,6 +96,7 @@ GroupBridge::GroupBridge(boost::filesystem::path group_socket_path)
       group_socket_endpoint(group_socket_path.string()),
       group_socket_acceptor(create_acceptor_if_inactive(main_context.context,
                                                         group_socket_endpoint)),
+      shm_arena(group_socket_path.stem().string() + "-audio"),
       shutdown_timer(main_context.context) {
     // Write this process's original STDOUT and STDERR streams to the logger
     logger.async_log_pipe_lines(stdout_redirect.pipe, stdout_buffer,
@@ -205,13 +206,15 @@ void GroupBridge::accept_requests() {
                     case PluginType::vst2:
                         bridge = std::make_unique<Vst2Bridge>(
                             main_context, request.plugin_path,
-                            request.endpoint_base_dir, request.parent_pid);
+                            request.endpoint_base_dir, request.parent_pid,
+                            &shm_arena);
                         break;
                     case PluginType::vst3:
 #ifdef WITH_VST3
                         bridge = std::make_unique<Vst3Bridge>(
                             main_context, request.plugin_path,
-                            request.endpoint_base_dir, request.parent_pid);
+                            request.endpoint_base_dir, request.parent_pid,
+                            &shm_arena);
 #else
                         throw std::runtime_error(
                             "This version of yabridge has not been compiled "
@@ -343,6 +346,10 @@ void GroupBridge::maybe_schedule_shutdown(
             logger.log(
                 "All plugins have exited, shutting down the group process");
 
+            // Since we're not running any destructors, we'll need to clean
+            // up the audio buffer arena's shared memory objects ourselves
+            shm_arena.remove_objects();
+
             // main_context.stop();
             // FIXME: See the comment in `individual-host.cpp`
             TerminateProcess(GetCurrentProcess(), 0);
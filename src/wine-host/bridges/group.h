@@ -248,6 +248,14 @@ class GroupBridge {
      */
     boost::asio::local::stream_protocol::acceptor group_socket_acceptor;
 
+    /**
+     * The shared audio buffers for all plugins hosted in this group are
+     * allocated from this arena, so that a group with many plugins doesn't end
+     * up with one shared memory object per plugin instance. This has to outlive
+     * all plugins in `active_plugins`.
+     */
+    AudioShmArena shm_arena;
+
     /**
      * A map of threads that are currently hosting a plugin within this process
      * along with their plugin instance. After a plugin has exited or its
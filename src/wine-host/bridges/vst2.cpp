@@ -67,6 +67,16 @@ Vst2Bridge* current_bridge_instance = nullptr;
 static const std::unordered_set<int> mutually_recursive_callbacks{
     audioMasterUpdateDisplay};
 
+/**
+ * Callbacks that are sent to the host as one-way events. The plugin's calling
+ * thread won't wait for the host to handle these. Plugins call
+ * `audioMasterIdle()` from their GUI thread while doing something that takes a
+ * while, the return value is meaningless, and the host responding with
+ * `effEditIdle()` is handled on the native plugin side without involving this
+ * thread.
+ */
+static const std::unordered_set<int> one_way_callbacks{audioMasterIdle};
+
 /**
  * Opcodes that, when called on this plugin's dispatcher, have to be handled
  * mutually recursively, if possible. This means that the plugin makes a
@@ -133,9 +143,11 @@ Vst2Bridge& get_bridge_instance(const AEffect* plugin) {
 Vst2Bridge::Vst2Bridge(MainContext& main_context,
                        std::string plugin_dll_path,
                        std::string endpoint_base_dir,
-                       pid_t parent_pid)
-    : HostBridge(main_context, plugin_dll_path, parent_pid),
+                       pid_t parent_pid,
+                       AudioShmArena* shm_arena)
+    : HostBridge(main_context, plugin_dll_path, parent_pid, shm_arena),
       logger(generic_logger),
+      parameter_mirror_timer(main_context.context),
       plugin_handle(LoadLibrary(plugin_dll_path.c_str()), FreeLibrary),
       sockets(main_context.context, endpoint_base_dir, false) {
     if (!plugin_handle) {
@@ -202,6 +214,19 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
     // configuration as a response
     config = sockets.host_vst_control.receive_single<Configuration>();
 
+    // With the `parameter_mirror` option enabled we'll keep a copy of the
+    // plugin's parameter values in shared memory so the native plugin doesn't
+    // have to ask us for every `getParameter()` call
+    if (config.parameter_mirror) {
+        parameter_mirror.emplace(ParameterMirror::Config{
+            .name = sockets.base_dir.filename().string() + "-parameters",
+            .num_parameters =
+                static_cast<uint32_t>(std::max(plugin->numParams, 0))});
+        parameter_mirror->invalidate_all();
+
+        sockets.host_vst_control.send(parameter_mirror->config);
+    }
+
     // Allow this plugin to configure the main context's tick rate
     main_context.update_timer_interval(config.event_loop_interval());
 
@@ -218,12 +243,21 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
                 if (request.value) {
                     // `setParameter`
                     plugin->setParameter(plugin, request.index, *request.value);
+                    if (parameter_mirror) {
+                        // If the plugin changes the value when setting it,
+                        // then this will be corrected when the parameter gets
+                        // refreshed
+                        parameter_mirror->set(request.index, *request.value);
+                    }
 
                     ParameterResult response{std::nullopt};
                     sockets.host_vst_parameters.send(response, buffer);
                 } else {
                     // `getParameter`
                     float value = plugin->getParameter(plugin, request.index);
+                    if (parameter_mirror) {
+                        parameter_mirror->set(request.index, value);
+                    }
 
                     ParameterResult response{value};
                     sockets.host_vst_parameters.send(response, buffer);
@@ -234,6 +268,13 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
     process_replacing_handler = Win32Thread([&]() {
         set_realtime_priority(true);
         pthread_setname_np(pthread_self(), "audio");
+        pin_audio_thread(config);
+
+        if (config.audio_realtime_memory) {
+            generic_logger.log_memory_lock_result(
+                "audio thread's stack",
+                lock_current_thread_stack(audio_thread_stack_lock_size));
+        }
 
         // Most plugins will already enable FTZ, but there are a handful of
         // plugins that don't that suffer from extreme DSP load increases when
@@ -243,121 +284,29 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
         sockets.host_vst_process_replacing.receive_multi<Vst2ProcessRequest>(
             [&](Vst2ProcessRequest& process_request,
                 SerializationBufferBase& buffer) {
-                // Since the value cannot change during this processing cycle,
-                // we'll send the current transport information as part of the
-                // request so we prefetch it to avoid unnecessary callbacks from
-                // the audio thread
-                std::optional<decltype(time_info_cache)::Guard>
-                    time_info_cache_guard =
-                        process_request.current_time_info
-                            ? std::optional(time_info_cache.set(
-                                  *process_request.current_time_info))
-                            : std::nullopt;
-
-                // We'll also prefetch the process level, since some plugins
-                // will ask for this during every processing cycle
-                decltype(process_level_cache)::Guard process_level_cache_guard =
-                    process_level_cache.set(
-                        process_request.current_process_level);
-
-                // As suggested by Jack Winter, we'll synchronize this thread's
-                // audio processing priority with that of the host's audio
-                // thread every once in a while
-                if (process_request.new_realtime_priority) {
-                    set_realtime_priority(
-                        true, *process_request.new_realtime_priority);
-                }
-
-                // Let the plugin process the MIDI events that were received
-                // since the last buffer, and then clean up those events. This
-                // approach should not be needed but Kontakt only stores
-                // pointers to rather than copies of the events.
-                std::lock_guard lock(next_buffer_midi_events_mutex);
-
-                // As an optimization we no don't pass the input audio along
-                // with `Vst2ProcessRequest`, and instead we'll write it to a
-                // shared memory object on the plugin side. We can then write
-                // the output audio to the same shared memory object. Since the
-                // host should only be calling one of `process()`,
-                // processReplacing()` or `processDoubleReplacing()`, we can all
-                // handle them all at once. We pick which one to call depending
-                // on the type of data we got sent and the plugin's reported
-                // support for these functions.
-                auto do_process = [&]<typename T>(T) {
-                    // These were set up after the host called
-                    // `effMainsChanged()` with the correct size, so this
-                    // reinterpret cast is safe even if the host suddenly starts
-                    // sending 32-bit single precision audio after it set up
-                    // audio processing for double precision (not that the
-                    // Windows VST2 plugin would be able to handle that,
-                    // presumably)
-                    T** input_channel_pointers = reinterpret_cast<T**>(
-                        process_buffers_input_pointers.data());
-                    T** output_channel_pointers = reinterpret_cast<T**>(
-                        process_buffers_output_pointers.data());
-
-                    if constexpr (std::is_same_v<T, float>) {
-                        // Any plugin made in the last fifteen years or so
-                        // should support `processReplacing`. In the off chance
-                        // it does not we can just emulate this behavior
-                        // ourselves.
-                        if (plugin->processReplacing) {
-                            plugin->processReplacing(
-                                plugin, input_channel_pointers,
-                                output_channel_pointers,
-                                process_request.sample_frames);
-                        } else {
-                            // If we zero out this buffer then the behavior is
-                            // the same as `processReplacing`
-                            for (int channel = 0; channel < plugin->numOutputs;
-                                 channel++) {
-                                std::fill(output_channel_pointers[channel],
-                                          output_channel_pointers[channel] +
-                                              process_request.sample_frames,
-                                          static_cast<T>(0.0));
-                            }
-
-                            plugin->process(plugin, input_channel_pointers,
-                                            output_channel_pointers,
-                                            process_request.sample_frames);
-                        }
-                    } else if (std::is_same_v<T, double>) {
-                        plugin->processDoubleReplacing(
-                            plugin, input_channel_pointers,
-                            output_channel_pointers,
-                            process_request.sample_frames);
-                    } else {
-                        static_assert(
-                            std::is_same_v<T, float> ||
-                                std::is_same_v<T, double>,
-                            "Audio processing only works with single and "
-                            "double precision floating point numbers");
-                    }
-                };
-
-                assert(process_buffers);
-                if (process_request.double_precision) {
-                    // XXX: Clangd doesn't let you specify template parameters
-                    //      for templated lambdas. This argument should get
-                    //      optimized out
-                    do_process(double());
-                } else {
-                    do_process(float());
-                }
-
-                // We modified the buffers within the `process_response` object,
-                // so we can just send that object back. Like on the plugin side
-                // we cannot reuse the request object because a plugin may have
-                // a different number of input and output channels
-                sockets.host_vst_process_replacing.send(Ack{}, buffer);
-
-                // See the docstrong on `should_clear_midi_events` for why we
-                // don't just clear `next_buffer_midi_events` here
-                should_clear_midi_events = true;
+                const auto& midi_events = process_request.midi_events.events;
+                const auto& parameter_changes =
+                    process_request.parameter_changes;
+                process_audio(Vst2ProcessRequestBlock(process_request),
+                              std::span(midi_events.data(), midi_events.size()),
+                              std::span(parameter_changes.data(),
+                                        parameter_changes.size()));
+
+                // The output audio has been written to the shared memory
+                // buffers, so the response only contains the MIDI events the
+                // plugin produced during this processing cycle
+                sockets.host_vst_process_replacing.send(process_response,
+                                                        buffer);
             });
     });
 }
 
+Vst2Bridge::~Vst2Bridge() noexcept {
+    // The thread handling the futex handshake isn't tied to any of the sockets,
+    // so we need to explicitly tell it to stop before it can be joined
+    stop_process_handshake_handler();
+}
+
 bool Vst2Bridge::inhibits_event_loop() noexcept {
     return !is_initialized;
 }
@@ -379,19 +328,15 @@ void Vst2Bridge::run() {
                 // we need to store a copy of the `DynamicVstEvents` struct
                 // before passing the generated `VstEvents` object to the
                 // plugin.
+                // NOTE: The native plugin normally sends these events along
+                //       with the next processing request, but it will still
+                //       send them this way if they don't fit in the request
+                //       area when using the futex handshake
                 std::lock_guard lock(next_buffer_midi_events_mutex);
-
-                // See the docstring on `should_clear_midi_events` for why we
-                // only deallocate old MIDI events here instead of a at the end
-                // of every processing cycle
-                if (should_clear_midi_events) {
-                    next_audio_buffer_midi_events.clear();
-                    should_clear_midi_events = false;
-                }
-
-                next_audio_buffer_midi_events.push_back(
-                    std::get<DynamicVstEvents>(event.payload));
-                DynamicVstEvents& events = next_audio_buffer_midi_events.back();
+                const auto& received_events =
+                    std::get<DynamicVstEvents>(event.payload).events;
+                DynamicVstEvents& events = store_midi_events(std::span(
+                    received_events.data(), received_events.size()));
 
                 // Exact same handling as in `passthrough_event()`, apart from
                 // making a copy of the events first
@@ -427,6 +372,13 @@ void Vst2Bridge::run() {
                                     set_realtime_priority(true);
                                 }
 
+                                // The parameter mirror is refreshed from
+                                // this thread, and the plugin is gone after
+                                // this call
+                                if (opcode == effClose) {
+                                    parameter_mirror_timer.cancel();
+                                }
+
                                 const intptr_t result = dispatch_wrapper(
                                     plugin, opcode, index, value, data, option);
 
@@ -439,6 +391,7 @@ void Vst2Bridge::run() {
                                 // initialized states from misbehaving
                                 if (opcode == effOpen) {
                                     is_initialized = true;
+                                    async_refresh_parameter_mirror();
                                 }
 
                                 return result;
@@ -463,6 +416,22 @@ void Vst2Bridge::run() {
                 },
                 event);
 
+            // Loading a preset may change any of the plugin's parameters, so
+            // the native plugin should ask the plugin for those values again
+            if (parameter_mirror && (event.opcode == effSetChunk ||
+                                     event.opcode == effSetProgram)) {
+                parameter_mirror->invalidate_all();
+            }
+
+            // Like the native plugin does for the silence gate, we'll print the
+            // spin wait statistics when the plugin gets suspended
+            if (config.audio_spin_wait && event.opcode == effMainsChanged &&
+                event.value == 0 && process_buffers &&
+                process_buffers->uses_futex_handshake()) {
+                log_spin_wait_statistics(
+                    process_buffers->spin_wait_statistics());
+            }
+
             // We also need some special handling to set up audio processing.
             // After the plugin has finished setting up audio processing, we'll
             // initialize our shared audio buffers on this side and send the
@@ -484,6 +453,8 @@ void Vst2Bridge::run() {
 
             return result;
         });
+
+    log_mutual_recursion_statistics(mutual_recursion.statistics());
 }
 
 void Vst2Bridge::handle_x11_events() noexcept {
@@ -618,6 +589,10 @@ class HostCallbackDataConverter : public DefaultDataConverter {
         return DefaultDataConverter::write_value(opcode, value, response);
     }
 
+    bool is_one_way(const int opcode) const override {
+        return one_way_callbacks.contains(opcode);
+    }
+
     Vst2EventResult send_event(
         boost::asio::local::stream_protocol::socket& socket,
         const Vst2Event& event,
@@ -644,6 +619,13 @@ intptr_t Vst2Bridge::host_callback(AEffect* effect,
                                    void* data,
                                    float option) {
     switch (opcode) {
+        case audioMasterAutomate:
+            // The host will likely query the parameter's new value in response
+            // to this, so the mirrored value needs to be updated first
+            if (parameter_mirror) {
+                parameter_mirror->set(index, option);
+            }
+            break;
         case audioMasterGetTime: {
             // During a processing call we'll have already sent the current
             // transport information from the plugin side to avoid an
@@ -665,6 +647,31 @@ intptr_t Vst2Bridge::host_callback(AEffect* effect,
                 return result;
             }
         } break;
+        case audioMasterProcessEvents: {
+            // MIDI events sent from the audio thread while the plugin is
+            // processing audio are returned together with the processing
+            // response. This saves a full host callback round trip from within
+            // the audio thread for plugins that generate MIDI.
+            if (processing_thread_id.load(std::memory_order_relaxed) ==
+                GetCurrentThreadId()) {
+                const VstEvents& events = *static_cast<const VstEvents*>(data);
+                for (int i = 0; i < events.numEvents; i++) {
+                    process_response.output_events.events.push_back(
+                        *events.events[i]);
+                }
+
+                if (logger.logger.verbosity >=
+                    Logger::Verbosity::most_events) [[unlikely]] {
+                    logger.log_event(false, opcode, index, value,
+                                     DynamicVstEvents(events), option,
+                                     std::nullopt);
+                    logger.log_event_response(false, opcode, 1, nullptr,
+                                              std::nullopt, true);
+                }
+
+                return 1;
+            }
+        } break;
         case audioMasterGetCurrentProcessLevel: {
             // We also send the current process level for similar reasons
             const int* current_process_level = process_level_cache.get();
@@ -745,6 +752,208 @@ intptr_t Vst2Bridge::dispatch_wrapper(AEffect* plugin,
     }
 }
 
+void Vst2Bridge::process_audio(
+    const Vst2ProcessRequestBlock& process_request,
+    std::span<const VstEvent> midi_events,
+    std::span<const ParameterChange> parameter_changes) {
+    // Since the value cannot change during this processing cycle, we'll send
+    // the current transport information as part of the request so we prefetch
+    // it to avoid unnecessary callbacks from the audio thread
+    std::optional<decltype(time_info_cache)::Guard> time_info_cache_guard =
+        process_request.has_current_time_info
+            ? std::optional(
+                  time_info_cache.set(process_request.current_time_info))
+            : std::nullopt;
+
+    // We'll also prefetch the process level, since some plugins will ask for
+    // this during every processing cycle
+    decltype(process_level_cache)::Guard process_level_cache_guard =
+        process_level_cache.set(process_request.current_process_level);
+
+    // As suggested by Jack Winter, we'll synchronize this thread's audio
+    // processing priority with that of the host's audio thread every once in a
+    // while
+    if (process_request.has_new_realtime_priority) {
+        set_realtime_priority(true, process_request.new_realtime_priority);
+    }
+    if (process_request.has_new_cpu_affinity) {
+        set_cpu_affinity(process_request.new_cpu_affinity);
+    }
+
+    // Let the plugin process the MIDI events that were received since the last
+    // buffer, and then clean up those events. This approach should not be
+    // needed but Kontakt only stores pointers to rather than copies of the
+    // events.
+    std::lock_guard lock(next_buffer_midi_events_mutex);
+
+    // With the `parameter_queue` option enabled, `setParameter()` calls the
+    // host made from the audio thread are sent along with the request. These
+    // are applied in order before the plugin gets to see any new MIDI events.
+    for (const ParameterChange& change : parameter_changes) {
+        plugin->setParameter(plugin, change.index, change.value);
+        if (parameter_mirror) {
+            parameter_mirror->set(change.index, change.value);
+        }
+    }
+
+    // The MIDI events the host passed to `effProcessEvents()` right before this
+    // processing cycle are sent along with the request
+    if (!midi_events.empty()) {
+        DynamicVstEvents& events = store_midi_events(midi_events);
+        plugin->dispatcher(plugin, effProcessEvents, 0, 0,
+                           &events.as_c_events(), 0.0);
+    }
+
+    // MIDI events sent by the plugin from this thread while processing will
+    // be returned as part of the response, see `host_callback()`
+    process_response.output_events.events.clear();
+    processing_thread_id.store(GetCurrentThreadId(), std::memory_order_relaxed);
+
+    // As an optimization we no don't pass the input audio along with
+    // `Vst2ProcessRequest`, and instead we'll write it to a shared memory
+    // object on the plugin side. We can then write the output audio to the same
+    // shared memory object. Since the host should only be calling one of
+    // `process()`, processReplacing()` or `processDoubleReplacing()`, we can
+    // all handle them all at once. We pick which one to call depending on the
+    // type of data we got sent and the plugin's reported support for these
+    // functions.
+    auto do_process = [&]<typename T>(T) {
+        // These were set up after the host called `effMainsChanged()` with the
+        // correct size, so this reinterpret cast is safe even if the host
+        // suddenly starts sending 32-bit single precision audio after it set up
+        // audio processing for double precision (not that the Windows VST2
+        // plugin would be able to handle that, presumably)
+        T** input_channel_pointers =
+            reinterpret_cast<T**>(process_buffers_input_pointers.data());
+        T** output_channel_pointers =
+            reinterpret_cast<T**>(process_buffers_output_pointers.data());
+
+        if constexpr (std::is_same_v<T, float>) {
+            // Any plugin made in the last fifteen years or so should support
+            // `processReplacing`. In the off chance it does not we can just
+            // emulate this behavior ourselves.
+            if (plugin->processReplacing) {
+                plugin->processReplacing(plugin, input_channel_pointers,
+                                         output_channel_pointers,
+                                         process_request.sample_frames);
+            } else {
+                // If we zero out this buffer then the behavior is the same as
+                // `processReplacing`
+                for (int channel = 0; channel < plugin->numOutputs; channel++) {
+                    std::fill(output_channel_pointers[channel],
+                              output_channel_pointers[channel] +
+                                  process_request.sample_frames,
+                              static_cast<T>(0.0));
+                }
+
+                plugin->process(plugin, input_channel_pointers,
+                                output_channel_pointers,
+                                process_request.sample_frames);
+            }
+        } else if (std::is_same_v<T, double>) {
+            plugin->processDoubleReplacing(plugin, input_channel_pointers,
+                                           output_channel_pointers,
+                                           process_request.sample_frames);
+        } else {
+            static_assert(
+                std::is_same_v<T, float> || std::is_same_v<T, double>,
+                "Audio processing only works with single and double precision "
+                "floating point numbers");
+        }
+    };
+
+    assert(process_buffers);
+    if (process_request.double_precision) {
+        // XXX: Clangd doesn't let you specify template parameters for templated
+        //      lambdas. This argument should get optimized out
+        do_process(double());
+    } else {
+        do_process(float());
+    }
+
+    processing_thread_id.store(0, std::memory_order_relaxed);
+
+    // See the docstrong on `should_clear_midi_events` for why we don't just
+    // clear `next_buffer_midi_events` here
+    should_clear_midi_events = true;
+}
+
+void Vst2Bridge::async_refresh_parameter_mirror() {
+    if (!parameter_mirror || parameter_mirror->config.num_parameters == 0) {
+        return;
+    }
+
+    parameter_mirror_timer.expires_after(config.event_loop_interval());
+    parameter_mirror_timer.async_wait(
+        [&](const boost::system::error_code& error) {
+            if (error.failed()) {
+                return;
+            }
+
+            refresh_parameter_mirror();
+            async_refresh_parameter_mirror();
+        });
+}
+
+void Vst2Bridge::refresh_parameter_mirror() {
+    const uint32_t num_parameters = parameter_mirror->config.num_parameters;
+    const uint32_t batch_size =
+        std::min(num_parameters, parameter_mirror_refresh_batch_size);
+    for (uint32_t i = 0; i < batch_size; i++) {
+        const uint32_t index = next_mirrored_parameter;
+        parameter_mirror->set(
+            index, plugin->getParameter(plugin, static_cast<int>(index)));
+
+        next_mirrored_parameter = (index + 1) % num_parameters;
+    }
+}
+
+DynamicVstEvents& Vst2Bridge::store_midi_events(
+    std::span<const VstEvent> midi_events) {
+    // See the docstring on `should_clear_midi_events` for why we only
+    // deallocate old MIDI events here instead of a at the end of every
+    // processing cycle
+    if (should_clear_midi_events) {
+        next_audio_buffer_midi_events.clear();
+        should_clear_midi_events = false;
+    }
+
+    DynamicVstEvents& events = next_audio_buffer_midi_events.emplace_back();
+    events.events.assign(midi_events.begin(), midi_events.end());
+
+    return events;
+}
+
+uint32_t Vst2Bridge::write_process_response_block() {
+    auto& events = process_response.output_events.events;
+    Vst2ProcessResponseBlock& response =
+        process_buffers->response_as<Vst2ProcessResponseBlock>();
+
+    const size_t num_block_events =
+        std::min(events.size(), max_process_response_events);
+    response.num_output_events = static_cast<int32_t>(num_block_events);
+    std::copy_n(events.begin(), num_block_events, response.output_events);
+
+    // This should almost never happen, but if the plugin produced a huge
+    // number of MIDI events then we'll send the rest through a regular host
+    // callback. The native plugin queues those and passes them to the host
+    // after the events from the response area, so the order is preserved.
+    if (events.size() > num_block_events) [[unlikely]] {
+        events.erase(events.begin(), events.begin() + num_block_events);
+
+        HostCallbackDataConverter converter(plugin, last_time_info,
+                                            mutual_recursion);
+        sockets.vst_host_callback.send_event(
+            converter, std::nullopt, audioMasterProcessEvents, 0, 0,
+            &process_response.output_events.as_c_events(), 0.0);
+    }
+
+    // Only the events that were actually written need to be copied back
+    return static_cast<uint32_t>(
+        offsetof(Vst2ProcessResponseBlock, output_events) +
+        (num_block_events * sizeof(VstEvent)));
+}
+
 AudioShmBuffer::Config Vst2Bridge::setup_shared_audio_buffers() {
     // We'll first compute the size and channel offsets for our buffer based on
     // the information already passed to us by the host. The offsets for each
@@ -752,24 +961,66 @@ AudioShmBuffer::Config Vst2Bridge::setup_shared_audio_buffers() {
     // arithmetic in `AudioShmBuffer`), and we'll only use the first bus (since
     // VST2 plugins don't have multiple audio busses).
     assert(max_samples_per_block);
-    uint32_t current_offset = 0;
 
+    // If the futex handshake is enabled, then the buffer will start with a
+    // control block containing space for the processing requests and
+    // responses. The audio channels are stored right after that.
+    const uint32_t message_capacity =
+        config.audio_futex_handshake
+            ? std::max(sizeof(Vst2ProcessRequestBlock),
+                       sizeof(Vst2ProcessResponseBlock))
+            : 0;
+
+    // If the host is going to send double precision audio but the plugin
+    // doesn't support `processDoubleReplacing()`, then we'll store single
+    // precision samples instead. The native plugin will then convert between
+    // the two, and we'll call `processReplacing()` as usual.
+    const bool double_precision_buffers =
+        double_precision && (plugin->flags & effFlagsCanDoubleReplacing);
+    const uint32_t sample_size =
+        double_precision_buffers ? sizeof(double) : sizeof(float);
+    uint32_t current_offset =
+        AudioShmBuffer::control_block_size(message_capacity) / sample_size;
+
+    // Every channel is aligned to at least a cache line, and the inputs and
+    // outputs each start on a new page so the native plugin writing the next
+    // inputs never touches the same pages the Windows plugin writes its
+    // outputs to
+    const uint32_t channel_alignment = config.audio_page_aligned_channels
+                                           ? AudioShmBuffer::page_size
+                                           : AudioShmBuffer::cache_line_size;
+
+    current_offset = AudioShmBuffer::align_offset(
+        current_offset, sample_size, AudioShmBuffer::page_size);
     std::vector<uint32_t> input_channel_offsets(plugin->numInputs);
     for (int channel = 0; channel < plugin->numInputs; channel++) {
+        current_offset = AudioShmBuffer::align_offset(
+            current_offset, sample_size, channel_alignment);
         input_channel_offsets[channel] = current_offset;
         current_offset += *max_samples_per_block;
     }
 
+    current_offset = AudioShmBuffer::align_offset(
+        current_offset, sample_size, AudioShmBuffer::page_size);
     std::vector<uint32_t> output_channel_offsets(plugin->numOutputs);
     for (int channel = 0; channel < plugin->numOutputs; channel++) {
+        current_offset = AudioShmBuffer::align_offset(
+            current_offset, sample_size, channel_alignment);
         output_channel_offsets[channel] = current_offset;
         current_offset += *max_samples_per_block;
     }
 
     // The size of the buffer is in bytes, and it will depend on whether the
-    // host is going to pass 32-bit or 64-bit audio to the plugin
+    // host is going to pass 32-bit or 64-bit audio to the plugin. Huge pages
+    // can only be used for the buffer if its size is a multiple of the huge
+    // page size.
+    const uint32_t buffer_alignment = config.audio_huge_pages
+                                          ? AudioShmBuffer::huge_page_size
+                                          : AudioShmBuffer::page_size;
     const uint32_t buffer_size =
-        current_offset * (double_precision ? sizeof(double) : sizeof(float));
+        AudioShmBuffer::align_offset(current_offset, sample_size,
+                                     buffer_alignment) *
+        sample_size;
 
     // We'll set up these shared memory buffers on the Wine side first, and then
     // when this request returns we'll do the same thing on the native plugin
@@ -778,18 +1029,38 @@ AudioShmBuffer::Config Vst2Bridge::setup_shared_audio_buffers() {
         .name = sockets.base_dir.filename().string(),
         .size = buffer_size,
         .input_offsets = {std::move(input_channel_offsets)},
-        .output_offsets = {std::move(output_channel_offsets)}};
+        .output_offsets = {std::move(output_channel_offsets)},
+        .message_capacity = message_capacity,
+        .double_precision = double_precision_buffers,
+        .huge_pages = config.audio_huge_pages,
+        .lock_memory = config.audio_realtime_memory,
+        .memfd = config.audio_memfd};
+
+    // The thread handling the futex handshake may be waiting on the old buffer,
+    // so it has to be stopped before we can resize it
+    stop_process_handshake_handler();
     if (!process_buffers) {
-        process_buffers.emplace(buffer_config);
+        // When hosted in a plugin group the buffer gets allocated from the
+        // group's arena instead, and the arena will pick the buffer's name.
+        // Memfd backed buffers don't need a name, so they don't use the arena.
+        if (shm_arena && !buffer_config.memfd) {
+            process_buffers.emplace(buffer_config, *shm_arena);
+        } else {
+            process_buffers.emplace(buffer_config);
+        }
     } else {
         process_buffers->resize(buffer_config);
     }
+    if (config.audio_realtime_memory) {
+        generic_logger.log_memory_lock_result(
+            "audio buffers", process_buffers->memory_lock_result());
+    }
 
     // The process functions expect a `T**` for their inputs and outputs, so
     // we'll also set those up right now
     process_buffers_input_pointers.resize(plugin->numInputs);
     for (int channel = 0; channel < plugin->numInputs; channel++) {
-        if (double_precision) {
+        if (double_precision_buffers) {
             process_buffers_input_pointers[channel] =
                 process_buffers->input_channel_ptr<double>(0, channel);
         } else {
@@ -800,7 +1071,7 @@ AudioShmBuffer::Config Vst2Bridge::setup_shared_audio_buffers() {
 
     process_buffers_output_pointers.resize(plugin->numOutputs);
     for (int channel = 0; channel < plugin->numOutputs; channel++) {
-        if (double_precision) {
+        if (double_precision_buffers) {
             process_buffers_output_pointers[channel] =
                 process_buffers->output_channel_ptr<double>(0, channel);
         } else {
@@ -809,7 +1080,66 @@ AudioShmBuffer::Config Vst2Bridge::setup_shared_audio_buffers() {
         }
     }
 
-    return buffer_config;
+    if (process_buffers->uses_futex_handshake()) {
+        start_process_handshake_handler();
+    }
+
+    // The buffer's name and offset may have been changed by the arena, and the
+    // memfd backing the buffer gets sent along with the configuration
+    return process_buffers->config;
+}
+
+void Vst2Bridge::start_process_handshake_handler() {
+    if (config.audio_spin_wait) {
+        process_buffers->set_spin_wait_limit(
+            std::chrono::microseconds(*config.audio_spin_wait));
+    }
+
+    process_handshake_handler = Win32Thread([&]() {
+        set_realtime_priority(true);
+        pthread_setname_np(pthread_self(), "audio-futex");
+        pin_audio_thread(config);
+
+        if (config.audio_realtime_memory) {
+            generic_logger.log_memory_lock_result(
+                "audio thread's stack",
+                lock_current_thread_stack(audio_thread_stack_lock_size));
+        }
+
+        // See `process_replacing_handler`
+        ScopedFlushToZero ftz_guard;
+
+        // The native plugin writes a fixed-layout request to the shared
+        // memory buffer, so we can read it from there in place
+        while (process_buffers->wait_for_request()) {
+            const Vst2ProcessRequestBlock& process_request =
+                process_buffers->request_as<Vst2ProcessRequestBlock>();
+            process_audio(process_request,
+                          std::span(process_request.midi_events,
+                                    process_request.num_midi_events),
+                          std::span(process_request.parameter_changes,
+                                    process_request.num_parameter_changes));
+
+            process_buffers->send_response(write_process_response_block());
+        }
+    });
+}
+
+void Vst2Bridge::stop_process_handshake_handler() noexcept {
+    // This thread only runs while we have a buffer that uses the futex
+    // handshake
+    if (process_buffers && process_buffers->uses_futex_handshake()) {
+        process_buffers->interrupt_request_wait();
+
+        // `Win32Thread`'s destructor will wait for the thread to exit
+        {
+            Win32Thread stopped_handler = std::move(process_handshake_handler);
+        }
+
+        if (config.audio_spin_wait) {
+            log_spin_wait_statistics(process_buffers->spin_wait_statistics());
+        }
+    }
 }
 
 intptr_t VST_CALL_CONV host_callback_proxy(AEffect* effect,
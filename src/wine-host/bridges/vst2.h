@@ -21,9 +21,12 @@
 #include <vestige/aeffectx.h>
 #include <windows.h>
 
+#include <span>
+
 #include "../../common/communication/vst2.h"
 #include "../../common/configuration.h"
 #include "../../common/mutual-recursion.h"
+#include "../../common/parameter-mirror.h"
 #include "../editor.h"
 #include "common.h"
 
@@ -47,6 +50,9 @@ class Vst2Bridge : public HostBridge {
      * @param parent_pid The process ID of the native plugin host this bridge is
      *   supposed to communicate with. Used as part of our watchdog to prevent
      *   dangling Wine processes.
+     * @param shm_arena The arena to allocate the shared audio buffers from when
+     *   the plugin is hosted in a plugin group. When this is a null pointer,
+     *   the plugin will get its own shared memory objects instead.
      *
      * @note The object has to be constructed from the same thread that calls
      *   `main_context.run()`.
@@ -57,7 +63,10 @@ class Vst2Bridge : public HostBridge {
     Vst2Bridge(MainContext& main_context,
                std::string plugin_dll_path,
                std::string endpoint_base_dir,
-               pid_t parent_pid);
+               pid_t parent_pid,
+               AudioShmArena* shm_arena = nullptr);
+
+    ~Vst2Bridge() noexcept override;
 
     bool inhibits_event_loop() noexcept override;
 
@@ -98,6 +107,75 @@ class Vst2Bridge : public HostBridge {
      */
     AudioShmBuffer::Config setup_shared_audio_buffers();
 
+    /**
+     * Call the plugin's `processReplacing()`, `process()` or
+     * `processDoubleReplacing()` function using the audio in `process_buffers`
+     * and the information from the request sent by the native plugin. This is
+     * used both when receiving processing requests over the
+     * `host_vst_process_replacing` socket and when reading them in place from
+     * the control block in `process_buffers` when using the futex handshake.
+     * Any MIDI events the plugin sends from the audio thread while processing
+     * will be stored in `process_response`.
+     *
+     * @param process_request The processing request.
+     * @param midi_events The MIDI events sent along with the request. These
+     *   are passed to the plugin using `effProcessEvents()` right before
+     *   processing audio.
+     * @param parameter_changes The parameter changes sent along with the
+     *   request when the `parameter_queue` option is enabled. These are
+     *   applied in order before the MIDI events are passed to the plugin.
+     */
+    void process_audio(const Vst2ProcessRequestBlock& process_request,
+                       std::span<const VstEvent> midi_events,
+                       std::span<const ParameterChange> parameter_changes);
+
+    /**
+     * Copy MIDI events to `next_audio_buffer_midi_events` so they stay alive
+     * until the next processing cycle, and return the stored copy so it can be
+     * passed to the plugin. `next_buffer_midi_events_mutex` must be locked
+     * while calling this.
+     */
+    DynamicVstEvents& store_midi_events(std::span<const VstEvent> midi_events);
+
+    /**
+     * Write the MIDI events from `process_response` to the response area in
+     * `process_buffers` when using the futex handshake. If the plugin sent more
+     * events than fit in there, then the rest will be sent through the regular
+     * host callback socket before we return.
+     *
+     * @return The size of the response written to the response area.
+     */
+    uint32_t write_process_response_block();
+
+    /**
+     * Periodically call `refresh_parameter_mirror()` from the main context
+     * using `parameter_mirror_timer`, if the `parameter_mirror` option is
+     * enabled. This is started after `effOpen()`, and the timer is cancelled
+     * again before `effClose()`.
+     */
+    void async_refresh_parameter_mirror();
+
+    /**
+     * Refresh the next `parameter_mirror_refresh_batch_size` values in
+     * `parameter_mirror`. This is called from the main context on every event
+     * loop tick, so the plugin's `getParameter()` function never has to be
+     * called from the audio thread for this.
+     */
+    void refresh_parameter_mirror();
+
+    /**
+     * Start `process_handshake_handler`. This should only be called after
+     * `process_buffers` has been set up with the futex handshake enabled.
+     */
+    void start_process_handshake_handler();
+
+    /**
+     * Stop `process_handshake_handler` and wait for it to exit, if it is
+     * running. This is needed before resizing `process_buffers` and before
+     * shutting down.
+     */
+    void stop_process_handshake_handler() noexcept;
+
     /**
      * A logger instance we'll use log cached `audioMasterGetTime()` calls, so
      * they can be hidden on verbosity levels below 2.
@@ -185,6 +263,42 @@ class Vst2Bridge : public HostBridge {
      */
     ScopedValueCache<int> process_level_cache;
 
+    /**
+     * The response for the processing cycle that's currently being handled.
+     * When the plugin calls `audioMasterProcessEvents()` from the audio thread
+     * during audio processing, the events are added to this object instead of
+     * being sent to the native plugin through a host callback. This is reused
+     * between processing cycles to avoid allocations.
+     */
+    Vst2ProcessResponse process_response;
+    /**
+     * The Win32 thread ID of the thread that's currently calling the plugin's
+     * processing function, or 0 when we're not processing audio. Used in
+     * `host_callback()` to determine whether MIDI events should be buffered in
+     * `process_response`.
+     */
+    std::atomic<DWORD> processing_thread_id = 0;
+
+    /**
+     * A copy of the plugin's parameter values in shared memory, used when the
+     * `parameter_mirror` option is enabled. The native plugin reads from this
+     * table when the host calls `getParameter()`, so we need to update it
+     * whenever we know a parameter has changed.
+     */
+    std::optional<ParameterMirror> parameter_mirror;
+    /**
+     * The index of the next parameter `refresh_parameter_mirror()` should
+     * refresh. Only used from the main context.
+     */
+    uint32_t next_mirrored_parameter = 0;
+    /**
+     * Runs `refresh_parameter_mirror()` on the main context's event loop
+     * interval.
+     *
+     * @see async_refresh_parameter_mirror
+     */
+    boost::asio::steady_timer parameter_mirror_timer;
+
     // FIXME: This emits `-Wignored-attributes` as of Wine 5.22
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wignored-attributes"
@@ -219,6 +333,14 @@ class Vst2Bridge : public HostBridge {
      * fallback) and `processDoubleReplacing`.
      */
     Win32Thread process_replacing_handler;
+    /**
+     * When the `audio_futex_handshake` option is enabled, this thread will
+     * handle the processing requests written to the control block in
+     * `process_buffers` instead. The socket based thread above will still be
+     * listening, but it won't receive any requests in that case. Started and
+     * stopped in `setup_shared_audio_buffers()`.
+     */
+    Win32Thread process_handshake_handler;
 
     /**
      * All sockets used for communicating with this specific plugin.
@@ -22,8 +22,11 @@
 
 Vst3ComponentHandlerProxyImpl::Vst3ComponentHandlerProxyImpl(
     Vst3Bridge& bridge,
-    Vst3ComponentHandlerProxy::ConstructArgs&& args) noexcept
-    : Vst3ComponentHandlerProxy(std::move(args)), bridge(bridge) {
+    Vst3ComponentHandlerProxy::ConstructArgs&& args,
+    bool coalesce_edits) noexcept
+    : Vst3ComponentHandlerProxy(std::move(args)),
+      bridge(bridge),
+      coalesce_edits(coalesce_edits) {
     // The lifecycle of this object is managed together with that of the plugin
     // object instance this host context got passed to
 }
@@ -38,8 +41,33 @@ Vst3ComponentHandlerProxyImpl::queryInterface(const Steinberg::TUID _iid,
     return result;
 }
 
+void Vst3ComponentHandlerProxyImpl::flush_parameter_edits() {
+    YaComponentHandler::PerformEdits request{.owner_instance_id =
+                                                 owner_instance_id()};
+    {
+        std::lock_guard lock(pending_edits_mutex);
+        if (pending_edits.empty()) {
+            return;
+        }
+
+        request.edits.swap(pending_edits);
+    }
+
+    // This needs to be mutually recursive for the same reason as
+    // `performEdit()` below
+    bridge.send_mutually_recursive_message(request);
+}
+
 tresult PLUGIN_API
 Vst3ComponentHandlerProxyImpl::beginEdit(Steinberg::Vst::ParamID id) {
+    if (coalesce_edits) {
+        buffer_parameter_edit(
+            {.type = YaComponentHandler::ParameterEdit::Type::begin,
+             .id = id,
+             .value_normalized = 0.0});
+        return Steinberg::kResultOk;
+    }
+
     return bridge.send_message(YaComponentHandler::BeginEdit{
         .owner_instance_id = owner_instance_id(), .id = id});
 }
@@ -47,6 +75,14 @@ Vst3ComponentHandlerProxyImpl::beginEdit(Steinberg::Vst::ParamID id) {
 tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::performEdit(
     Steinberg::Vst::ParamID id,
     Steinberg::Vst::ParamValue valueNormalized) {
+    if (coalesce_edits) {
+        buffer_parameter_edit(
+            {.type = YaComponentHandler::ParameterEdit::Type::perform,
+             .id = id,
+             .value_normalized = valueNormalized});
+        return Steinberg::kResultOk;
+    }
+
     // HACK: Ardour/Mixbus will in some cases immediately call
     //       `IEditController::setParamNormalized()` after this `performEdit()`,
     //       so we need to be able to receive that
@@ -60,24 +96,40 @@ tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::performEdit(
 
 tresult PLUGIN_API
 Vst3ComponentHandlerProxyImpl::endEdit(Steinberg::Vst::ParamID id) {
+    if (coalesce_edits) {
+        buffer_parameter_edit(
+            {.type = YaComponentHandler::ParameterEdit::Type::end,
+             .id = id,
+             .value_normalized = 0.0});
+        return Steinberg::kResultOk;
+    }
+
     return bridge.send_message(YaComponentHandler::EndEdit{
         .owner_instance_id = owner_instance_id(), .id = id});
 }
 
 tresult PLUGIN_API
 Vst3ComponentHandlerProxyImpl::restartComponent(int32 flags) {
+    flush_parameter_edits();
+
     return bridge.send_mutually_recursive_message(
         YaComponentHandler::RestartComponent{
             .owner_instance_id = owner_instance_id(), .flags = flags});
 }
 
 tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::setDirty(TBool state) {
-    return bridge.send_message(YaComponentHandler2::SetDirty{
+    flush_parameter_edits();
+
+    bridge.send_message(YaComponentHandler2::SetDirty{
         .owner_instance_id = owner_instance_id(), .state = state});
+
+    return Steinberg::kResultOk;
 }
 
 tresult PLUGIN_API
 Vst3ComponentHandlerProxyImpl::requestOpenEditor(Steinberg::FIDString name) {
+    flush_parameter_edits();
+
     if (name) {
         return bridge.send_message(YaComponentHandler2::RequestOpenEditor{
             .owner_instance_id = owner_instance_id(), .name = name});
@@ -90,11 +142,15 @@ Vst3ComponentHandlerProxyImpl::requestOpenEditor(Steinberg::FIDString name) {
 }
 
 tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::startGroupEdit() {
+    flush_parameter_edits();
+
     return bridge.send_message(YaComponentHandler2::StartGroupEdit{
         .owner_instance_id = owner_instance_id()});
 }
 
 tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::finishGroupEdit() {
+    flush_parameter_edits();
+
     return bridge.send_message(YaComponentHandler2::FinishGroupEdit{
         .owner_instance_id = owner_instance_id()});
 }
@@ -103,6 +159,8 @@ Steinberg::Vst::IContextMenu* PLUGIN_API
 Vst3ComponentHandlerProxyImpl::createContextMenu(
     Steinberg::IPlugView* /*plugView*/,
     const Steinberg::Vst::ParamID* paramID) {
+    flush_parameter_edits();
+
     // XXX: The does do not make it clear what `paramID` is, so my assumption
     //      that it really is a pointer to a parameter ID. I'll assume that 'the
     //      parameter being zero' was a typo and that they mean passign a null
@@ -125,6 +183,8 @@ tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::requestBusActivation(
     Steinberg::Vst::BusDirection dir,
     int32 index,
     TBool state) {
+    flush_parameter_edits();
+
     return bridge.send_message(
         YaComponentHandlerBusActivation::RequestBusActivation{
             .owner_instance_id = owner_instance_id(),
@@ -138,6 +198,8 @@ tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::start(
     ProgressType type,
     const Steinberg::tchar* optionalDescription,
     ID& outID) {
+    flush_parameter_edits();
+
     const StartResponse response = bridge.send_message(YaProgress::Start{
         .owner_instance_id = owner_instance_id(),
         .type = type,
@@ -155,6 +217,8 @@ tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::start(
 tresult PLUGIN_API
 Vst3ComponentHandlerProxyImpl::update(ID id,
                                       Steinberg::Vst::ParamValue normValue) {
+    flush_parameter_edits();
+
     return bridge.send_message(
         YaProgress::Update{.owner_instance_id = owner_instance_id(),
                            .id = id,
@@ -162,12 +226,16 @@ Vst3ComponentHandlerProxyImpl::update(ID id,
 }
 
 tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::finish(ID id) {
+    flush_parameter_edits();
+
     return bridge.send_message(
         YaProgress::Finish{.owner_instance_id = owner_instance_id(), .id = id});
 }
 
 tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::notifyUnitSelection(
     Steinberg::Vst::UnitID unitId) {
+    flush_parameter_edits();
+
     return bridge.send_message(YaUnitHandler::NotifyUnitSelection{
         .owner_instance_id = owner_instance_id(), .unit_id = unitId});
 }
@@ -175,6 +243,8 @@ tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::notifyUnitSelection(
 tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::notifyProgramListChange(
     Steinberg::Vst::ProgramListID listId,
     int32 programIndex) {
+    flush_parameter_edits();
+
     // NOTE: When a plugin calls this, Ardour will fetch the new program names
     //       with `IUnitInfo::getProgramName()`. TEOTE requires this to be
     //       called from the same thread.
@@ -186,6 +256,42 @@ tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::notifyProgramListChange(
 }
 
 tresult PLUGIN_API Vst3ComponentHandlerProxyImpl::notifyUnitByBusChange() {
+    flush_parameter_edits();
+
     return bridge.send_message(YaUnitHandler2::NotifyUnitByBusChange{
         .owner_instance_id = owner_instance_id()});
 }
+
+void Vst3ComponentHandlerProxyImpl::buffer_parameter_edit(
+    YaComponentHandler::ParameterEdit edit) {
+    std::unique_lock lock(pending_edits_mutex);
+    const bool was_empty = pending_edits.empty();
+
+    // Only the last value within a gesture is relevant, so an earlier buffered
+    // `performEdit()` for the same parameter can simply be overwritten as long
+    // as there's no `beginEdit()` or `endEdit()` between the two
+    if (edit.type == YaComponentHandler::ParameterEdit::Type::perform) {
+        for (auto it = pending_edits.rbegin(); it != pending_edits.rend();
+             it++) {
+            if (it->id != edit.id) {
+                continue;
+            }
+
+            if (it->type == YaComponentHandler::ParameterEdit::Type::perform) {
+                it->value_normalized = edit.value_normalized;
+                return;
+            } else {
+                break;
+            }
+        }
+    }
+
+    pending_edits.push_back(edit);
+    lock.unlock();
+
+    // The edits are sent at the end of the current event loop cycle, or when
+    // the plugin makes some other component handler callback before that
+    if (was_empty) {
+        bridge.schedule_parameter_edit_flush(owner_instance_id());
+    }
+}
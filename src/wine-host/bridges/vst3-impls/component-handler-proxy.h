@@ -16,13 +16,22 @@
 
 #pragma once
 
+#include <mutex>
+#include <vector>
+
 #include "../vst3.h"
 
 class Vst3ComponentHandlerProxyImpl : public Vst3ComponentHandlerProxy {
    public:
+    /**
+     * @param coalesce_edits Whether `beginEdit()`, `performEdit()` and
+     *   `endEdit()` calls should be buffered and sent in batches. This is
+     *   controlled by the `vst3_coalesce_edits` option.
+     */
     Vst3ComponentHandlerProxyImpl(
         Vst3Bridge& bridge,
-        Vst3ComponentHandlerProxy::ConstructArgs&& args) noexcept;
+        Vst3ComponentHandlerProxy::ConstructArgs&& args,
+        bool coalesce_edits) noexcept;
 
     /**
      * We'll override the query interface to log queries for interfaces we do
@@ -31,6 +40,16 @@ class Vst3ComponentHandlerProxyImpl : public Vst3ComponentHandlerProxy {
     tresult PLUGIN_API queryInterface(const Steinberg::TUID _iid,
                                       void** obj) override;
 
+    /**
+     * Send all buffered `beginEdit()`, `performEdit()` and `endEdit()` calls
+     * to the native plugin in a single `YaComponentHandler::PerformEdits`
+     * message. This is a no-op if there are no buffered edits. Scheduled on
+     * the main context whenever the first edit gets buffered, and also called
+     * before every other component handler callback so the host still
+     * receives all calls in order.
+     */
+    void flush_parameter_edits();
+
     // From `IComponentHandler`
     tresult PLUGIN_API beginEdit(Steinberg::Vst::ParamID id) override;
     tresult PLUGIN_API
@@ -75,5 +94,24 @@ class Vst3ComponentHandlerProxyImpl : public Vst3ComponentHandlerProxy {
     tresult PLUGIN_API notifyUnitByBusChange() override;
 
    private:
+    /**
+     * Add a `beginEdit()`, `performEdit()` or `endEdit()` call to
+     * `pending_edits`. A `performEdit()` replaces the value of an earlier
+     * buffered `performEdit()` for the same parameter, as long as there was no
+     * `beginEdit()` or `endEdit()` for that parameter in between. The first
+     * buffered edit will schedule a call to `flush_parameter_edits()` on the
+     * main context.
+     */
+    void buffer_parameter_edit(YaComponentHandler::ParameterEdit edit);
+
     Vst3Bridge& bridge;
+
+    const bool coalesce_edits;
+
+    /**
+     * Edits that have not yet been sent to the native plugin. Only used when
+     * `coalesce_edits` is enabled.
+     */
+    std::vector<YaComponentHandler::ParameterEdit> pending_edits;
+    std::mutex pending_edits_mutex;
 };
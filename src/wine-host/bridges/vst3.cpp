@@ -25,6 +25,18 @@
 // NOLINTNEXTLINE(bugprone-suspicious-include)
 #include <public.sdk/source/vst/hosting/module_win32.cpp>
 
+/**
+ * The space reserved for the serialized `YaAudioProcessor::Process` object and
+ * the response to that in the shared audio buffers' request and response areas
+ * when the `audio_futex_handshake` option is enabled. These areas start with
+ * the fixed-layout `ShmProcessInputs` and `ShmProcessOutputs` regions for the
+ * parameter changes and events, and only parameter changes and events that
+ * don't fit in those regions will be serialized, so this can be fairly small.
+ * If the request does not fit, then the native plugin will fall back to using
+ * the socket.
+ */
+constexpr uint32_t process_handshake_serialized_capacity = 16 * 1024;
+
 /**
  * This is a workaround for Bluecat Audio plugins that don't expose their
  * `IPluginBase` interface through the query interface. Even though every plugin
@@ -83,8 +95,9 @@ InstanceInterfaces::InstanceInterfaces(
 Vst3Bridge::Vst3Bridge(MainContext& main_context,
                        std::string plugin_dll_path,
                        std::string endpoint_base_dir,
-                       pid_t parent_pid)
-    : HostBridge(main_context, plugin_dll_path, parent_pid),
+                       pid_t parent_pid,
+                       AudioShmArena* shm_arena)
+    : HostBridge(main_context, plugin_dll_path, parent_pid, shm_arena),
       logger(generic_logger),
       sockets(main_context.context, endpoint_base_dir, false) {
     std::string error;
@@ -385,6 +398,23 @@ void Vst3Bridge::run() {
                 return YaEditController::GetParameterInfoResponse{
                     .result = result, .info = std::move(info)};
             },
+            [&](const YaEditController::GetAllParameterInfo& request)
+                -> YaEditController::GetAllParameterInfo::Response {
+                const auto& edit_controller =
+                    object_instances[request.instance_id].edit_controller;
+
+                YaEditController::GetAllParameterInfoResponse response{
+                    .parameter_count = edit_controller->getParameterCount(),
+                    .parameters = {}};
+                response.parameters.resize(
+                    std::max(response.parameter_count, 0));
+                for (int32 i = 0; i < response.parameter_count; i++) {
+                    auto& [result, info] = response.parameters[i];
+                    result = edit_controller->getParameterInfo(i, info);
+                }
+
+                return response;
+            },
             [&](const YaEditController::GetParamStringByValue& request)
                 -> YaEditController::GetParamStringByValue::Response {
                 Steinberg::Vst::String128 string{0};
@@ -453,7 +483,8 @@ void Vst3Bridge::run() {
                     request.component_handler_proxy_args
                         ? Steinberg::owned(new Vst3ComponentHandlerProxyImpl(
                               *this,
-                              std::move(*request.component_handler_proxy_args)))
+                              std::move(*request.component_handler_proxy_args),
+                              config.vst3_coalesce_edits))
                         : nullptr;
 
                 return object_instances[request.instance_id]
@@ -798,13 +829,18 @@ void Vst3Bridge::run() {
             },
             [&](const YaPlugView::OnFocus& request)
                 -> YaPlugView::OnFocus::Response {
-                return main_context
-                    .run_in_context([&]() -> tresult {
-                        return object_instances[request.owner_instance_id]
+                // The native plugin doesn't wait for this, but we'll still wait
+                // for the call to finish so any following requests on this
+                // socket are handled after it
+                main_context
+                    .run_in_context([&]() -> void {
+                        object_instances[request.owner_instance_id]
                             .plug_view_instance->plug_view->onFocus(
                                 request.state);
                     })
-                    .get();
+                    .wait();
+
+                return OneWay{};
             },
             [&](YaPlugView::SetFrame& request)
                 -> YaPlugView::SetFrame::Response {
@@ -1112,6 +1148,8 @@ void Vst3Bridge::run() {
                                                  std::move(request.stream)};
                                  },
         });
+
+    log_mutual_recursion_statistics(mutual_recursion.statistics());
 }
 
 void Vst3Bridge::handle_x11_events() noexcept {
@@ -1128,6 +1166,28 @@ void Vst3Bridge::close_sockets() {
     sockets.close();
 }
 
+void Vst3Bridge::schedule_parameter_edit_flush(size_t owner_instance_id) {
+    main_context.schedule_task([this, owner_instance_id]() {
+        Steinberg::IPtr<Vst3ComponentHandlerProxy> component_handler_proxy;
+        {
+            std::lock_guard lock(object_instances_mutex);
+            if (const auto instance = object_instances.find(owner_instance_id);
+                instance != object_instances.end()) {
+                component_handler_proxy =
+                    instance->second.component_handler_proxy;
+            }
+        }
+
+        // The only component handler proxies we create on this side are
+        // `Vst3ComponentHandlerProxyImpl`s
+        if (component_handler_proxy) {
+            static_cast<Vst3ComponentHandlerProxyImpl*>(
+                component_handler_proxy.get())
+                ->flush_parameter_edits();
+        }
+    });
+}
+
 void Vst3Bridge::register_context_menu(Vst3ContextMenuProxyImpl& context_menu) {
     std::lock_guard lock(object_instances[context_menu.owner_instance_id()]
                              .registered_context_menus_mutex);
@@ -1160,16 +1220,49 @@ AudioShmBuffer::Config Vst3Bridge::setup_shared_audio_buffers(
         object_instances[instance_id].audio_processor;
     assert(component && audio_processor);
 
+    // The size of the buffer is in bytes, and it will depend on whether the
+    // host is going to pass 32-bit or 64-bit audio to the plugin
+    const bool double_precision =
+        setup.symbolicSampleSize == Steinberg::Vst::kSample64;
+    const uint32_t sample_size =
+        double_precision ? sizeof(double) : sizeof(float);
+
     // We'll query the plugin for its audio bus layouts, and then create
     // calculate the offsets in a large memory buffer for the different audio
     // channels. The offsets for each audio channel are in samples (since
-    // they'll be used with pointer arithmetic in `AudioShmBuffer`).
-    uint32_t current_offset = 0;
+    // they'll be used with pointer arithmetic in `AudioShmBuffer`). If the
+    // futex handshake is enabled, then the buffer will start with a control
+    // block containing space for the processing requests and responses, and
+    // the audio channels are stored right after that.
+    const ShmProcessDataCapacity shm_input_capacity =
+        shm_process_data_capacity(instance_id, Steinberg::Vst::kInput);
+    const ShmProcessDataCapacity shm_output_capacity =
+        shm_process_data_capacity(instance_id, Steinberg::Vst::kOutput);
+    const uint32_t message_capacity =
+        config.audio_futex_handshake
+            ? static_cast<uint32_t>(
+                  std::max(ShmProcessInputs::size_for(shm_input_capacity),
+                           ShmProcessOutputs::size_for(shm_output_capacity)) +
+                  process_handshake_serialized_capacity)
+            : 0;
+    uint32_t current_offset =
+        AudioShmBuffer::control_block_size(message_capacity) / sample_size;
+
+    // Every channel is aligned to at least a cache line, and the inputs and
+    // outputs each start on a new page so the native plugin writing the next
+    // inputs never touches the same pages the Windows plugin writes its
+    // outputs to
+    const uint32_t channel_alignment = config.audio_page_aligned_channels
+                                           ? AudioShmBuffer::page_size
+                                           : AudioShmBuffer::cache_line_size;
 
     auto create_bus_offsets = [&](Steinberg::Vst::BusDirection direction) {
         const auto num_busses =
             component->getBusCount(Steinberg::Vst::kAudio, direction);
 
+        current_offset = AudioShmBuffer::align_offset(
+            current_offset, sample_size, AudioShmBuffer::page_size);
+
         std::vector<std::vector<uint32_t>> bus_offsets(num_busses);
         for (int bus = 0; bus < num_busses; bus++) {
             Steinberg::Vst::SpeakerArrangement speaker_arrangement{};
@@ -1183,6 +1276,8 @@ AudioShmBuffer::Config Vst3Bridge::setup_shared_audio_buffers(
             bus_offsets[bus].resize(num_channels);
 
             for (size_t channel = 0; channel < num_channels; channel++) {
+                current_offset = AudioShmBuffer::align_offset(
+                    current_offset, sample_size, channel_alignment);
                 bus_offsets[bus][channel] = current_offset;
                 current_offset += setup.maxSamplesPerBlock;
             }
@@ -1199,12 +1294,15 @@ AudioShmBuffer::Config Vst3Bridge::setup_shared_audio_buffers(
     std::vector<std::vector<uint32_t>> output_bus_offsets =
         create_bus_offsets(Steinberg::Vst::kOutput);
 
-    // The size of the buffer is in bytes, and it will depend on whether the
-    // host is going to pass 32-bit or 64-bit audio to the plugin
-    const bool double_precision =
-        setup.symbolicSampleSize == Steinberg::Vst::kSample64;
+    // Huge pages can only be used for the buffer if its size is a multiple of
+    // the huge page size
+    const uint32_t buffer_alignment = config.audio_huge_pages
+                                          ? AudioShmBuffer::huge_page_size
+                                          : AudioShmBuffer::page_size;
     const uint32_t buffer_size =
-        current_offset * (double_precision ? sizeof(double) : sizeof(float));
+        AudioShmBuffer::align_offset(current_offset, sample_size,
+                                     buffer_alignment) *
+        sample_size;
 
     // We'll set up these shared memory buffers on the Wine side first, and then
     // when this request returns we'll do the same thing on the native plugin
@@ -1214,15 +1312,35 @@ AudioShmBuffer::Config Vst3Bridge::setup_shared_audio_buffers(
                 std::to_string(instance_id),
         .size = buffer_size,
         .input_offsets = std::move(input_bus_offsets),
-        .output_offsets = std::move(output_bus_offsets)};
+        .output_offsets = std::move(output_bus_offsets),
+        .message_capacity = message_capacity,
+        .double_precision = double_precision,
+        .huge_pages = config.audio_huge_pages,
+        .lock_memory = config.audio_realtime_memory,
+        .memfd = config.audio_memfd};
+
+    // The thread handling the futex handshake may be waiting on the old buffer,
+    // so it has to be stopped before we can resize it
+    stop_audio_processor_handshake_handler(instance_id);
 
     std::optional<AudioShmBuffer>& process_buffers =
         object_instances[instance_id].process_buffers;
     if (!process_buffers) {
-        process_buffers.emplace(buffer_config);
+        // When hosted in a plugin group the buffer gets allocated from the
+        // group's arena instead, and the arena will pick the buffer's name.
+        // Memfd backed buffers don't need a name, so they don't use the arena.
+        if (shm_arena && !buffer_config.memfd) {
+            process_buffers.emplace(buffer_config, *shm_arena);
+        } else {
+            process_buffers.emplace(buffer_config);
+        }
     } else {
         process_buffers->resize(buffer_config);
     }
+    if (config.audio_realtime_memory) {
+        generic_logger.log_memory_lock_result(
+            "audio buffers", process_buffers->memory_lock_result());
+    }
 
     // After setting up the shared memory buffer, we need to create a vector of
     // channel audio pointers for every bus. These will then be assigned to the
@@ -1269,7 +1387,224 @@ AudioShmBuffer::Config Vst3Bridge::setup_shared_audio_buffers(
             }
         });
 
-    return buffer_config;
+    // The native plugin reads the capacities of the fixed-layout regions back
+    // from the shared memory, so they need to be set before we return
+    if (process_buffers->uses_futex_handshake()) {
+        process_buffers->request_as<ShmProcessInputs>().init(
+            shm_input_capacity);
+        process_buffers->response_as<ShmProcessOutputs>().init(
+            shm_output_capacity);
+
+        start_audio_processor_handshake_handler(instance_id);
+    }
+
+    // The buffer's name and offset may have been changed by the arena, and the
+    // memfd backing the buffer gets sent along with the configuration
+    return process_buffers->config;
+}
+
+ShmProcessDataCapacity Vst3Bridge::shm_process_data_capacity(
+    size_t instance_id,
+    Steinberg::Vst::BusDirection direction) {
+    const InstanceInterfaces& instance = object_instances[instance_id];
+
+    // If the edit controller is a separate object then we don't know how many
+    // parameters the plugin has. Whatever doesn't fit will be serialized
+    // instead.
+    uint32 parameter_queues = default_shm_parameter_queues;
+    if (instance.edit_controller) {
+        parameter_queues = static_cast<uint32>(
+            std::clamp(instance.edit_controller->getParameterCount(), 0,
+                       static_cast<int32>(max_shm_parameter_queues)));
+    }
+
+    const uint32 num_event_busses = static_cast<uint32>(std::max(
+        instance.component->getBusCount(Steinberg::Vst::kEvent, direction),
+        0));
+
+    return ShmProcessDataCapacity{
+        .parameter_queues = parameter_queues,
+        .parameter_points = parameter_queues * shm_points_per_parameter_queue,
+        .events = std::min(num_event_busses * shm_events_per_bus,
+                           max_shm_events)};
+}
+
+YaAudioProcessor::ProcessResponse Vst3Bridge::process_audio(
+    YaAudioProcessor::Process& request,
+    ShmProcessDataViews* shm_views) {
+    // Most plugins will already enable FTZ, but there are a handful of plugins
+    // that don't that suffer from extreme DSP load increases when they start
+    // producing denormals
+    ScopedFlushToZero ftz_guard;
+
+    // As suggested by Jack Winter, we'll synchronize this thread's audio
+    // processing priority with that of the host's audio thread every once in a
+    // while
+    if (request.new_realtime_priority) {
+        set_realtime_priority(true, *request.new_realtime_priority);
+    }
+    if (request.new_cpu_affinity) {
+        set_cpu_affinity(*request.new_cpu_affinity);
+    }
+
+    // The actual audio is stored in the shared memory buffers, so the
+    // reconstruction function will need to know where it should point the
+    // `AudioBusBuffers` to
+    InstanceInterfaces& instance = object_instances[request.instance_id];
+    Steinberg::Vst::ProcessData& process_data = request.data.reconstruct(
+        instance.process_buffers_input_pointers,
+        instance.process_buffers_output_pointers);
+
+    // When the request was sent through the futex handshake, the parameter
+    // changes, events and process context may be stored in shared memory
+    // instead
+    if (shm_views) {
+        shm_views->apply(process_data, request.data);
+    }
+
+    const tresult result = instance.audio_processor->process(process_data);
+
+    return YaAudioProcessor::ProcessResponse{
+        .result = result, .output_data = request.data.create_response()};
+}
+
+void Vst3Bridge::start_audio_processor_handshake_handler(size_t instance_id) {
+    // References to elements in `object_instances` stay valid until the
+    // element is removed, and this instance can't be removed while it's still
+    // being set up
+    InstanceInterfaces* instance_ptr;
+    {
+        std::lock_guard lock(object_instances_mutex);
+        instance_ptr = &object_instances.at(instance_id);
+    }
+    InstanceInterfaces& instance = *instance_ptr;
+    if (config.audio_spin_wait) {
+        instance.process_buffers->set_spin_wait_limit(
+            std::chrono::microseconds(*config.audio_spin_wait));
+    }
+
+    instance.audio_processor_handshake_handler =
+        Win32Thread([&, instance_id]() {
+            set_realtime_priority(true);
+
+            // See the XXX in `register_object_instance()`
+            const std::string thread_name =
+                "futex-" + std::to_string(instance_id);
+            pthread_setname_np(pthread_self(), thread_name.c_str());
+            pin_audio_thread(config);
+
+            if (config.audio_realtime_memory) {
+                generic_logger.log_memory_lock_result(
+                    "audio thread's stack",
+                    lock_current_thread_stack(audio_thread_stack_lock_size));
+            }
+
+            // These objects are reused between calls to avoid allocations,
+            // just like the thread local objects used when receiving messages
+            // over a socket. The request and response areas start with
+            // fixed-layout regions for the parameter changes and events, and
+            // `shm_views` lets the plugin read from and write to those
+            // directly. The rest of the request and response is serialized
+            // right after those regions.
+            AudioShmBuffer& process_buffers = *instance.process_buffers;
+            ShmProcessDataViews shm_views(
+                process_buffers.request_as<ShmProcessInputs>(),
+                process_buffers.response_as<ShmProcessOutputs>());
+            const size_t shm_inputs_size =
+                process_buffers.request_as<ShmProcessInputs>().size();
+            const size_t shm_outputs_size =
+                process_buffers.response_as<ShmProcessOutputs>().size();
+            uint8_t* const request_data =
+                process_buffers.request_data() + shm_inputs_size;
+            uint8_t* const response_data =
+                process_buffers.response_data() + shm_outputs_size;
+            const uint32_t response_capacity = static_cast<uint32_t>(
+                process_buffers.config.message_capacity - shm_outputs_size);
+
+            YaAudioProcessor::Process request{};
+            YaAudioProcessor::ProcessResponse response{};
+            SerializationBuffer<1024> buffer{};
+            bool warned_about_overflow = false;
+            while (process_buffers.wait_for_request()) {
+                read_object_from(request_data,
+                                 process_buffers.control().request_size,
+                                 request, buffer);
+
+                response = process_audio(request, &shm_views);
+                const std::optional<uint32_t> response_size = write_object_to(
+                    response_data, response_capacity, response, buffer);
+                if (response_size) [[likely]] {
+                    process_buffers.send_response(*response_size);
+                } else {
+                    // The response area is large enough for anything a plugin
+                    // will reasonably output, but a plugin could in theory
+                    // output more events that can't be stored in the
+                    // fixed-layout region than fit in there. In that case the
+                    // native plugin will fetch this response over the socket
+                    // instead, so nothing gets lost.
+                    if (!warned_about_overflow) {
+                        generic_logger.log(
+                            "WARNING: The plugin's output parameter changes "
+                            "and events did not fit in the shared memory "
+                            "response area, sending them over the socket "
+                            "instead");
+                        warned_about_overflow = true;
+                    }
+
+                    {
+                        std::lock_guard lock(
+                            instance.oversized_process_response_mutex);
+                        instance.oversized_process_result = response.result;
+                        instance.oversized_process_data.outputs =
+                            request.data.outputs;
+                        instance.oversized_process_data
+                            .output_parameter_changes =
+                            request.data.output_parameter_changes;
+                        instance.oversized_process_data.output_events =
+                            request.data.output_events;
+                    }
+                    process_buffers.send_response(
+                        AudioShmBuffer::response_in_socket);
+                }
+            }
+        });
+}
+
+void Vst3Bridge::stop_audio_processor_handshake_handler(
+    size_t instance_id) noexcept {
+    // The lock is only held for the lookup since joining the thread may take
+    // a while. The instance can't be removed while we're stopping its thread,
+    // since that also happens from `unregister_object_instance()`.
+    InstanceInterfaces* instance_ptr = nullptr;
+    {
+        std::lock_guard lock(object_instances_mutex);
+        if (const auto instance = object_instances.find(instance_id);
+            instance != object_instances.end()) {
+            instance_ptr = &instance->second;
+        }
+    }
+    if (!instance_ptr) {
+        return;
+    }
+
+    // This thread only runs while the instance has a buffer that uses the
+    // futex handshake
+    InstanceInterfaces& instance = *instance_ptr;
+    if (instance.process_buffers &&
+        instance.process_buffers->uses_futex_handshake()) {
+        instance.process_buffers->interrupt_request_wait();
+
+        // `Win32Thread`'s destructor will wait for the thread to exit
+        {
+            Win32Thread stopped_handler =
+                std::move(instance.audio_processor_handshake_handler);
+        }
+
+        if (config.audio_spin_wait) {
+            log_spin_wait_statistics(
+                instance.process_buffers->spin_wait_statistics());
+        }
+    }
 }
 
 size_t Vst3Bridge::register_object_instance(
@@ -1297,6 +1632,13 @@ size_t Vst3Bridge::register_object_instance(
             const std::string thread_name =
                 "audio-" + std::to_string(instance_id);
             pthread_setname_np(pthread_self(), thread_name.c_str());
+            pin_audio_thread(config);
+
+            if (config.audio_realtime_memory) {
+                generic_logger.log_memory_lock_result(
+                    "audio thread's stack",
+                    lock_current_thread_stack(audio_thread_stack_lock_size));
+            }
 
             sockets.add_audio_processor_and_listen(
                 instance_id, socket_listening_latch,
@@ -1342,10 +1684,25 @@ size_t Vst3Bridge::register_object_instance(
                     },
                     [&](YaAudioProcessor::SetupProcessing& request)
                         -> YaAudioProcessor::SetupProcessing::Response {
-                        const tresult result =
+                        // If the host wants to process double precision audio
+                        // but the plugin only supports single precision audio,
+                        // then we'll set the plugin up for single precision
+                        // audio instead. The native plugin will convert the
+                        // samples for us.
+                        const auto& audio_processor =
                             object_instances[request.instance_id]
-                                .audio_processor->setupProcessing(
-                                    request.setup);
+                                .audio_processor;
+                        if (request.setup.symbolicSampleSize ==
+                                Steinberg::Vst::kSample64 &&
+                            audio_processor->canProcessSampleSize(
+                                Steinberg::Vst::kSample64) !=
+                                Steinberg::kResultOk) {
+                            request.setup.symbolicSampleSize =
+                                Steinberg::Vst::kSample32;
+                        }
+
+                        const tresult result =
+                            audio_processor->setupProcessing(request.setup);
 
                         // We'll set up the shared audio buffers on the Wine
                         // side after the plugin has finished doing their setup.
@@ -1363,8 +1720,22 @@ size_t Vst3Bridge::register_object_instance(
                     },
                     [&](const YaAudioProcessor::SetProcessing& request)
                         -> YaAudioProcessor::SetProcessing::Response {
-                        return object_instances[request.instance_id]
-                            .audio_processor->setProcessing(request.state);
+                        InstanceInterfaces& instance =
+                            object_instances[request.instance_id];
+
+                        // Like the native plugin does for the silence gate,
+                        // we'll print the spin wait statistics when the host
+                        // stops processing audio
+                        if (config.audio_spin_wait && !request.state &&
+                            instance.process_buffers &&
+                            instance.process_buffers->uses_futex_handshake()) {
+                            log_spin_wait_statistics(
+                                instance.process_buffers
+                                    ->spin_wait_statistics());
+                        }
+
+                        return instance.audio_processor->setProcessing(
+                            request.state);
                     },
                     [&](MessageReference<YaAudioProcessor::Process>&
                             request_ref)
@@ -1376,38 +1747,34 @@ size_t Vst3Bridge::register_object_instance(
                         //       store a reference to it in our variant (this is
                         //       done during the deserialization in
                         //       `bitsery::ext::MessageReference`)
-                        YaAudioProcessor::Process& request = request_ref.get();
-
-                        // Most plugins will already enable FTZ, but there are a
-                        // handful of plugins that don't that suffer from
-                        // extreme DSP load increases when they start producing
-                        // denormals
-                        ScopedFlushToZero ftz_guard;
-
-                        // As suggested by Jack Winter, we'll synchronize this
-                        // thread's audio processing priority with that of the
-                        // host's audio thread every once in a while
-                        if (request.new_realtime_priority) {
-                            set_realtime_priority(
-                                true, *request.new_realtime_priority);
-                        }
-
-                        // The actual audio is stored in the shared memory
-                        // buffers, so the reconstruction function will need to
-                        // know where it should point the `AudioBusBuffers` to
-                        const tresult result =
-                            object_instances[request.instance_id]
-                                .audio_processor->process(
-                                    request.data.reconstruct(
-                                        object_instances[request.instance_id]
-                                            .process_buffers_input_pointers,
-                                        object_instances[request.instance_id]
-                                            .process_buffers_output_pointers));
-
-                        return YaAudioProcessor::ProcessResponse{
-                            .result = result,
-                            .output_data = request.data.create_response()};
+                        return process_audio(request_ref.get());
                     },
+                    [&](const YaAudioProcessor::GetOversizedProcessResponse&
+                            request)
+                        -> YaAudioProcessor::GetOversizedProcessResponse::
+                            Response {
+                            // The native plugin only sends this after the
+                            // handshake thread has reported that its response
+                            // didn't fit
+                            InstanceInterfaces& instance =
+                                object_instances[request.instance_id];
+                            std::lock_guard lock(
+                                instance.oversized_process_response_mutex);
+                            assert(instance.oversized_process_result);
+
+                            const UniversalTResult result =
+                                *instance.oversized_process_result;
+                            instance.oversized_process_result.reset();
+
+                            // The handshake thread won't touch
+                            // `oversized_process_data` again until the native
+                            // plugin has received this response and sent its
+                            // next request
+                            return YaAudioProcessor::ProcessResponse{
+                                .result = result,
+                                .output_data = instance.oversized_process_data
+                                                   .create_response()};
+                        },
                     [&](const YaAudioProcessor::GetTailSamples& request)
                         -> YaAudioProcessor::GetTailSamples::Response {
                         return object_instances[request.instance_id]
@@ -1513,6 +1880,7 @@ void Vst3Bridge::unregister_object_instance(size_t instance_id) {
     if (object_instances[instance_id].audio_processor ||
         object_instances[instance_id].component) {
         sockets.remove_audio_processor(instance_id);
+        stop_audio_processor_handshake_handler(instance_id);
     }
 
     // Remove the instance from within the main IO context so
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <string>
 
@@ -24,6 +25,7 @@
 #include "../../common/communication/vst3.h"
 #include "../../common/configuration.h"
 #include "../../common/mutual-recursion.h"
+#include "../../common/serialization/vst3/process-data-shm.h"
 #include "../editor.h"
 #include "common.h"
 
@@ -71,6 +73,14 @@ struct InstanceInterfaces {
      */
     Win32Thread audio_processor_handler;
 
+    /**
+     * When the `audio_futex_handshake` option is enabled, this thread handles
+     * the `IAudioProcessor::process()` calls written to the control block in
+     * `process_buffers`. This is started and stopped in
+     * `Vst3Bridge::setup_shared_audio_buffers()`.
+     */
+    Win32Thread audio_processor_handshake_handler;
+
     /**
      * If the host passes a host context object during
      * `IPluginBase::initialize()`, we'll store a proxy object here and then
@@ -151,6 +161,19 @@ struct InstanceInterfaces {
      */
     std::optional<AudioShmBuffer> process_buffers;
 
+    /**
+     * When a response from the `audio_processor_handshake_handler` thread did
+     * not fit in `process_buffers`' response area, that thread copies the
+     * response's result and output data to these fields. The native plugin
+     * will then fetch that response using
+     * `YaAudioProcessor::GetOversizedProcessResponse`. The response itself
+     * only refers to the handshake thread's own process data object, so we
+     * can't hand that off directly.
+     */
+    std::optional<UniversalTResult> oversized_process_result;
+    YaProcessData oversized_process_data;
+    std::mutex oversized_process_response_mutex;
+
     /**
      * Pointers to the per-bus input channels in process_buffers so we can pass
      * them to the plugin after a call to `YaProcessData::reconstruct()`. These
@@ -239,6 +262,9 @@ class Vst3Bridge : public HostBridge {
      * @param parent_pid The process ID of the native plugin host this bridge is
      *   supposed to communicate with. Used as part of our watchdog to prevent
      *   dangling Wine processes.
+     * @param shm_arena The arena to allocate the shared audio buffers from when
+     *   the plugin is hosted in a plugin group. When this is a null pointer,
+     *   the plugin will get its own shared memory objects instead.
      *
      * @note The object has to be constructed from the same thread that calls
      *   `main_context.run()`.
@@ -249,7 +275,8 @@ class Vst3Bridge : public HostBridge {
     Vst3Bridge(MainContext& main_context,
                std::string plugin_dll_path,
                std::string endpoint_base_dir,
-               pid_t parent_pid);
+               pid_t parent_pid,
+               AudioShmArena* shm_arena = nullptr);
 
     /**
      * For VST3 plugins we'll have to check for every object in
@@ -343,6 +370,17 @@ class Vst3Bridge : public HostBridge {
         return mutual_recursion.handle(std::forward<F>(fn));
     }
 
+    /**
+     * Call `Vst3ComponentHandlerProxyImpl::flush_parameter_edits()` on the
+     * component handler proxy of the object instance with ID
+     * `owner_instance_id` from the main context. Since the main context runs
+     * the Win32 message loop, this will happen once the current event loop
+     * cycle has been handled. If the object instance or its component handler
+     * no longer exist by then, the buffered edits are dropped together with the
+     * proxy object.
+     */
+    void schedule_parameter_edit_flush(size_t owner_instance_id);
+
     /**
      * Register a context with with `context_menu`'s ID and owner in
      * `object_instances`. This will be called during the constructor of
@@ -385,6 +423,45 @@ class Vst3Bridge : public HostBridge {
         size_t instance_id,
         const Steinberg::Vst::ProcessSetup& setup);
 
+    /**
+     * Decide on the capacities for the fixed-layout parameter changes and event
+     * regions in the shared audio buffers' request or response area for an
+     * instance when the `audio_futex_handshake` option is enabled. These are
+     * based on the plugin's parameter count and its number of event busses in
+     * that direction, so plugins don't lock memory for events they can't
+     * receive or send.
+     */
+    ShmProcessDataCapacity shm_process_data_capacity(
+        size_t instance_id,
+        Steinberg::Vst::BusDirection direction);
+
+    /**
+     * Handle an `IAudioProcessor::process()` call for a plugin instance using
+     * the audio in that instance's `process_buffers`. This is used both for
+     * requests received over the instance's audio processor socket and for
+     * requests received through the futex handshake. In the latter case
+     * `shm_views` should be set so the parameter changes, events and process
+     * context the native plugin stored in shared memory can be passed to the
+     * plugin.
+     */
+    YaAudioProcessor::ProcessResponse process_audio(
+        YaAudioProcessor::Process& request,
+        ShmProcessDataViews* shm_views = nullptr);
+
+    /**
+     * Start the `audio_processor_handshake_handler` thread for an instance.
+     * This should only be called after the instance's `process_buffers` have
+     * been set up with the futex handshake enabled.
+     */
+    void start_audio_processor_handshake_handler(size_t instance_id);
+
+    /**
+     * Stop an instance's `audio_processor_handshake_handler` thread and wait
+     * for it to exit, if it is running. This is needed before resizing the
+     * instance's `process_buffers` and before removing the instance.
+     */
+    void stop_audio_processor_handshake_handler(size_t instance_id) noexcept;
+
     /**
      * Assign a unique identifier to an object and add it to `object_instances`.
      * This will also set up listeners for `IAudioProcessor` and `IComponent`
@@ -0,0 +1,260 @@
+// yabridge: a Wine VST bridge
+// Copyright (C) 2020-2021 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// A small benchmark comparing the kernels from `src/common/audio-kernels.cpp`
+// to the plain loops yabridge used before those kernels were added. This gets
+// built as part of the regular build and it can be run with
+// `meson test --benchmark -C build --verbose`, or by running
+// `build/audio-kernels-benchmark` directly.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "../../src/common/audio-kernels.h"
+
+/**
+ * The number of times a single measurement is repeated. We report the fastest
+ * repetition to filter out scheduling noise.
+ */
+constexpr int num_repetitions = 25;
+/**
+ * The number of samples processed within a single repetition. The number of
+ * iterations depends on the buffer size so the larger buffers don't take
+ * ages.
+ */
+constexpr size_t samples_per_repetition = 1 << 18;
+
+constexpr size_t channel_counts[] = {2, 16, 64};
+constexpr size_t sample_counts[] = {32, 128, 512, 2048};
+
+// These are the implementations yabridge used before the vectorized kernels
+// were added. The compiler is free to auto-vectorize these loops the same way
+// it did in the actual plugin.
+
+template <typename T>
+static bool is_silent_baseline(const T* samples, size_t num_samples) noexcept {
+    constexpr size_t block_size = 64 / sizeof(T);
+
+    size_t sample = 0;
+    for (; sample + block_size <= num_samples; sample += block_size) {
+        bool has_audio = false;
+        for (size_t i = 0; i < block_size; i++) {
+            has_audio |= samples[sample + i] != 0;
+        }
+
+        if (has_audio) {
+            return false;
+        }
+    }
+
+    for (; sample < num_samples; sample++) {
+        if (samples[sample] != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+static void accumulate_samples_baseline(const T* samples,
+                                        size_t num_samples,
+                                        T* destination) noexcept {
+    std::transform(samples, samples + num_samples, destination, destination,
+                   [](const T& new_value, T& current_value) -> T {
+                       return new_value + current_value;
+                   });
+}
+
+template <typename From, typename To>
+static void convert_samples_baseline(const From* samples,
+                                     size_t num_samples,
+                                     To* destination) noexcept {
+    std::copy_n(samples, num_samples, destination);
+}
+
+/**
+ * Keep the compiler from optimizing away the work done on these buffers.
+ */
+static void clobber(const void* data) noexcept {
+    asm volatile("" : : "r"(data) : "memory");
+}
+
+/**
+ * Run `fn` `num_iterations` times `num_repetitions` times, and return the
+ * fastest average time in nanoseconds a single call took.
+ */
+template <typename F>
+static double measure(size_t num_iterations, F&& fn) {
+    double fastest = 0.0;
+    for (int repetition = 0; repetition < num_repetitions; repetition++) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_iterations; i++) {
+            fn();
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const double nanoseconds =
+            std::chrono::duration<double, std::nano>(end - start).count() /
+            num_iterations;
+        if (repetition == 0 || nanoseconds < fastest) {
+            fastest = nanoseconds;
+        }
+    }
+
+    return fastest;
+}
+
+/**
+ * Measure and print the baseline and the kernel for every combination of
+ * channel and sample counts. The functions get called with the channel's index
+ * and the number of samples.
+ */
+template <typename Baseline, typename Kernel>
+static void benchmark(const char* name, Baseline&& baseline, Kernel&& kernel) {
+    for (const size_t num_channels : channel_counts) {
+        for (const size_t num_samples : sample_counts) {
+            const size_t num_iterations = std::max<size_t>(
+                samples_per_repetition / (num_channels * num_samples), 1);
+            const double baseline_ns = measure(num_iterations, [&]() {
+                for (size_t channel = 0; channel < num_channels; channel++) {
+                    baseline(channel, num_samples);
+                }
+            });
+            const double kernel_ns = measure(num_iterations, [&]() {
+                for (size_t channel = 0; channel < num_channels; channel++) {
+                    kernel(channel, num_samples);
+                }
+            });
+
+            std::printf("%-24s %3zu x %4zu  %10.1f ns  %10.1f ns  %5.2fx\n",
+                        name, num_channels, num_samples, baseline_ns,
+                        kernel_ns, baseline_ns / kernel_ns);
+        }
+    }
+}
+
+int main() {
+    constexpr size_t max_channels = 64;
+    constexpr size_t max_samples = 2048;
+
+    // The silence check has to go through the entire buffer when it's silent,
+    // so that's the case we're measuring. The other buffers contain a bit of
+    // noise so we're not just adding zeroes.
+    std::vector<std::vector<float>> silent_float(
+        max_channels, std::vector<float>(max_samples, 0.0f));
+    std::vector<std::vector<double>> silent_double(
+        max_channels, std::vector<double>(max_samples, 0.0));
+    std::vector<std::vector<float>> float_input(max_channels);
+    std::vector<std::vector<float>> float_output(max_channels);
+    std::vector<std::vector<double>> double_input(max_channels);
+    std::vector<std::vector<double>> double_output(max_channels);
+    for (size_t channel = 0; channel < max_channels; channel++) {
+        float_input[channel].resize(max_samples);
+        float_output[channel].resize(max_samples);
+        double_input[channel].resize(max_samples);
+        double_output[channel].resize(max_samples);
+        for (size_t i = 0; i < max_samples; i++) {
+            float_input[channel][i] =
+                static_cast<float>((i * 7 + channel) % 13) / 13.0f - 0.5f;
+            double_input[channel][i] = float_input[channel][i];
+        }
+    }
+
+    // The size column shows the number of channels times the number of samples
+    // per channel
+    std::printf("%-24s %-10s  %13s  %13s  %6s\n", "operation", "size",
+                "baseline", "kernel", "gain");
+
+    benchmark(
+        "is_silent (float)",
+        [&](size_t channel, size_t num_samples) {
+            const bool result = is_silent_baseline(
+                silent_float[channel].data(), num_samples);
+            clobber(&result);
+        },
+        [&](size_t channel, size_t num_samples) {
+            const bool result =
+                is_silent(silent_float[channel].data(), num_samples);
+            clobber(&result);
+        });
+    benchmark(
+        "is_silent (double)",
+        [&](size_t channel, size_t num_samples) {
+            const bool result = is_silent_baseline(
+                silent_double[channel].data(), num_samples);
+            clobber(&result);
+        },
+        [&](size_t channel, size_t num_samples) {
+            const bool result =
+                is_silent(silent_double[channel].data(), num_samples);
+            clobber(&result);
+        });
+    benchmark(
+        "accumulate (float)",
+        [&](size_t channel, size_t num_samples) {
+            accumulate_samples_baseline(float_input[channel].data(),
+                                        num_samples,
+                                        float_output[channel].data());
+            clobber(float_output[channel].data());
+        },
+        [&](size_t channel, size_t num_samples) {
+            accumulate_samples(float_input[channel].data(), num_samples,
+                               float_output[channel].data());
+            clobber(float_output[channel].data());
+        });
+    benchmark(
+        "accumulate (double)",
+        [&](size_t channel, size_t num_samples) {
+            accumulate_samples_baseline(double_input[channel].data(),
+                                        num_samples,
+                                        double_output[channel].data());
+            clobber(double_output[channel].data());
+        },
+        [&](size_t channel, size_t num_samples) {
+            accumulate_samples(double_input[channel].data(), num_samples,
+                               double_output[channel].data());
+            clobber(double_output[channel].data());
+        });
+    benchmark(
+        "convert (float->double)",
+        [&](size_t channel, size_t num_samples) {
+            convert_samples_baseline(float_input[channel].data(), num_samples,
+                                     double_output[channel].data());
+            clobber(double_output[channel].data());
+        },
+        [&](size_t channel, size_t num_samples) {
+            convert_samples(float_input[channel].data(), num_samples,
+                            double_output[channel].data());
+            clobber(double_output[channel].data());
+        });
+    benchmark(
+        "convert (double->float)",
+        [&](size_t channel, size_t num_samples) {
+            convert_samples_baseline(double_input[channel].data(), num_samples,
+                                     float_output[channel].data());
+            clobber(float_output[channel].data());
+        },
+        [&](size_t channel, size_t num_samples) {
+            convert_samples(double_input[channel].data(), num_samples,
+                            float_output[channel].data());
+            clobber(float_output[channel].data());
+        });
+
+    return 0;
+}